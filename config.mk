@@ -18,6 +18,10 @@ CC			:= $(CROSS_COMPILE_PATH)-gcc
 CXX			:= $(CROSS_COMPILE_PATH)-g++
 OBJCOPY			:= $(CROSS_COMPILE_PATH)-objcopy
 
+# 	The native compilers, used for the host builds of the firmware.
+HOSTCC			:= cc
+HOSTCXX			:= c++
+
 # 	The remove shell command to use for deleting files and directories.
 RM			:= rm -rf
 
@@ -33,6 +37,37 @@ CPU_VARIANT		:= lite
 SYS_CLK_CFG		:= 12e6
 ADD_UART		:= --add_uart
 
+# 	UART baud rate, and depth of the UART's hardware RX and TX FIFOs. See
+# 	check_uart_config() in the gateware target script for the valid values.
+# 	The firmware gets them as CONFIG_UART_BAUDRATE and CONFIG_UART_FIFO_DEPTH.
+UART_BAUDRATE		:= 115200
+UART_FIFO_DEPTH		:= 16
+
+# 	UART_TX_DMA=1 adds a DMA reader that streams buffers from the bus to the
+# 	UART, used by uart_write_async() in the firmware. Off by default: it adds
+# 	a bus master to the UP5K, and uart_write_async() works without it.
+UART_TX_DMA		?= 0
+UART_ARGS		:= $(ADD_UART) --uart-baudrate=$(UART_BAUDRATE) --uart-fifo-depth=$(UART_FIFO_DEPTH)
+UART_ARGS		+= $(if $(filter 1, $(UART_TX_DMA)), --uart-tx-dma)
+
+# 	PERF_COUNTERS=1 adds the CPU bus performance counters, read by the
+# 	firmware's perf_counters API. Off by default: seven 32-bit counters, and
+# 	their latches and CSRs, cost UP5K logic cells in every build.
+PERF_COUNTERS		?= 0
+
+# 	Gateware target arguments, other than the CPU, clock, and SPI Flash mode.
+GATEWARE_ARGS		:= $(UART_ARGS)
+GATEWARE_ARGS		+= $(if $(filter 1, $(PERF_COUNTERS)), --with-perf-counters)
+
+# 	CPU variants compared by `make cpu-variants`, see gateware/cpu_variants.py.
+# 	The firmware CPUFLAGS (e.g. -march) follow CPU_VARIANT, through the
+# 	variables.mak LiteX generates for the SoC.
+CPU_VARIANTS		:= minimal lite standard
+
+# 	SPI Flash read mode used for executing in place: 1x, 1x-fast, 2x or 4x.
+# 	See SPI_FLASH_MODES in the gateware target script.
+SPI_FLASH_MODE		:= 1x
+
 # 	Paths configuration.
 
 # 	The path to the Python virtual environment for the project.
@@ -55,6 +90,9 @@ FIRMWARE_BINARY_NAME	:= signaloid_c0_microsd_firmware
 FIRMWARE_BINARY_PATH	:= $(SOFTWARE_BUILD_PATH)/$(FIRMWARE_BINARY_NAME).bin
 FIRMWARE_ELF_PATH	:= $(SOFTWARE_BUILD_PATH)/$(FIRMWARE_BINARY_NAME).elf
 
+# 	The path to the host builds of the firmware.
+HOST_BUILD_PATH		:= $(ROOT_DIR)/build/host
+
 # 	Documentation build paths.
 DOCS_BUILD_PATH 	:= $(ROOT_DIR)/build/documentation
 DOCS_BUILD_DIST 	:= $(ROOT_DIR)/build/signaloid_c0_microsd/docs
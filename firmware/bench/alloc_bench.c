@@ -0,0 +1,180 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+/*
+ * 	Allocator benchmark.
+ *
+ * 	Fills each pool of include/alloc.h, then frees its blocks in a random
+ * 	order, and reports the min, mean and max cycles per alloc_pool_alloc()
+ * 	and alloc_free() call: both take constant time, so the three should stay
+ * 	close however full the pool is. Then reports the cycles per arena
+ * 	allocation, and per alloc_arena_reset(), and prints the allocator
+ * 	statistics. Cycles are measured with profile.h.
+ */
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "alloc.h"
+#include "profile.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigMaxBlocks	= 256,
+	kBenchConfigArenaAllocs	= 256,
+	kBenchConfigArenaSize	= 24,
+} BenchConfig;
+
+
+static void *	bench_blocks[kBenchConfigMaxBlocks];
+static uint32_t	bench_rng_state = 0x12345678;
+
+
+static uint32_t
+bench_rand(void)
+{
+	/*
+	 * 	xorshift32
+	 */
+	bench_rng_state ^= bench_rng_state << 13;
+	bench_rng_state ^= bench_rng_state >> 17;
+	bench_rng_state ^= bench_rng_state << 5;
+	return bench_rng_state;
+}
+
+static void
+bench_print(const char *  name, uint32_t size, ProfileRegion *  region)
+{
+	uart_printf(
+		"%*s %*u bytes: %*u min %*u mean %*u max cycles\n",
+		16,
+		name,
+		4,
+		size,
+		6,
+		region->min,
+		6,
+		(uint32_t)(region->total / region->count),
+		6,
+		region->max);
+}
+
+static void
+bench_pool(const AllocPoolStats *  pool)
+{
+	PROFILE_REGION(alloc_region, "alloc_pool_alloc");
+	PROFILE_REGION(free_region, "alloc_free");
+
+	uint32_t blocks = pool->blocks < kBenchConfigMaxBlocks ? pool->blocks : kBenchConfigMaxBlocks;
+
+	for (uint32_t i = 0; i < blocks; i++)
+	{
+		uint64_t start	= profile_now();
+		bench_blocks[i] = alloc_pool_alloc(pool->block_size);
+		profile_stop(&alloc_region, start);
+	}
+
+	/*
+	 * 	Fisher-Yates shuffle, so that the free list is not in address order.
+	 */
+	for (uint32_t i = blocks - 1; i > 0; i--)
+	{
+		uint32_t j	= bench_rand() % (i + 1);
+		void *	 block	= bench_blocks[i];
+		bench_blocks[i] = bench_blocks[j];
+		bench_blocks[j] = block;
+	}
+
+	for (uint32_t i = 0; i < blocks; i++)
+	{
+		uint64_t start = profile_now();
+		alloc_free(bench_blocks[i]);
+		profile_stop(&free_region, start);
+	}
+
+	bench_print("alloc_pool_alloc", pool->block_size, &alloc_region);
+	bench_print("alloc_free", pool->block_size, &free_region);
+
+	profile_reset();
+}
+
+static void
+bench_arena(void)
+{
+	PROFILE_REGION(alloc_region, "alloc_arena_alloc");
+	PROFILE_REGION(reset_region, "alloc_arena_reset");
+
+	AllocArenaMark mark = alloc_arena_mark();
+
+	for (uint32_t i = 0; i < kBenchConfigArenaAllocs; i++)
+	{
+		uint64_t start = profile_now();
+		alloc_arena_alloc(kBenchConfigArenaSize);
+		profile_stop(&alloc_region, start);
+	}
+
+	uint64_t start = profile_now();
+	alloc_arena_reset(mark);
+	profile_stop(&reset_region, start);
+
+	bench_print("alloc_arena_alloc", kBenchConfigArenaSize, &alloc_region);
+	bench_print("alloc_arena_reset", kBenchConfigArenaSize * kBenchConfigArenaAllocs, &reset_region);
+
+	profile_reset();
+}
+
+int
+main(void)
+{
+	AllocStats stats;
+
+	timer0_init();
+	uart_init();
+	profile_init();
+	alloc_init();
+
+	irq_setie(1);
+
+	alloc_get_stats(&stats);
+
+	uart_printf("\nalloc_bench: %u pools, %u-byte arena\n", (uint32_t)kAllocPools, stats.arena_size);
+
+	for (int i = 0; i < kAllocPools; i++)
+	{
+		bench_pool(&stats.pools[i]);
+	}
+
+	bench_arena();
+
+	alloc_dump();
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
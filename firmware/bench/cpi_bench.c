@@ -0,0 +1,282 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	CPU variant benchmark.
+ *
+ * 	Runs loops of hand written instructions, whose instruction count is known,
+ * 	and reports the cycles per instruction (CPI) of each loop. Cycles are
+ * 	measured with timer0's uptime counter, since the smaller VexRiscv variants
+ * 	do not implement the cycle CSRs.
+ *
+ * 	The loops execute in place, so the CPI includes the instruction fetch cost
+ * 	of the memory the firmware runs from: the SPI flash on the Signaloid
+ * 	C0-microSD, where instruction caches make the difference, or single cycle
+ * 	block RAM in the simulator (see gateware/cpu_variants.py). Building with
+ * 	RAMTEXT_SOURCES=cpi_bench.c runs the loops from SRAM instead.
+ *
+ * 	The multiply and divide loops are only built when CPUFLAGS enable the M
+ * 	extension, i.e. not for the minimal variant.
+ *
+ * 	Each result is printed as one line, which gateware/cpu_variants.py parses:
+ * 	cpi_bench: <loop> instructions <count> cycles <count> CPI <cpi>
+ */
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <time.h>
+#include <stdint.h>
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigIterations = 4096,
+} BenchConfig;
+
+
+typedef struct
+{
+	const char *	name;
+	uint32_t	(*run)(uint32_t iterations);
+	/*
+	 * 	Instructions executed per two loop iterations.
+	 */
+	uint32_t	instructions_per_two_iterations;
+} CpiBenchLoop;
+
+
+/*
+ * 	Loaded and stored by the load/store loop.
+ */
+static volatile uint32_t cpi_bench_words[4];
+
+/*
+ * 	Cycles spent reading the uptime counter twice, subtracted from every measurement.
+ */
+static uint32_t cpi_bench_overhead;
+
+
+/*
+ * 	6 ALU instructions, and the loop counter decrement and branch.
+ */
+static uint32_t
+cpi_bench_alu(uint32_t iterations)
+{
+	uint32_t a = 1;
+	uint32_t b = 2;
+
+	__asm__ volatile(
+		"1:\n"
+		"	add	%[a], %[a], %[b]\n"
+		"	xor	%[b], %[b], %[a]\n"
+		"	slli	%[a], %[a], 3\n"
+		"	srli	%[b], %[b], 1\n"
+		"	or	%[a], %[a], %[b]\n"
+		"	sub	%[b], %[b], %[a]\n"
+		"	addi	%[n], %[n], -1\n"
+		"	bnez	%[n], 1b\n"
+		: [a] "+r"(a), [b] "+r"(b), [n] "+r"(iterations));
+
+	return a + b;
+}
+
+/*
+ * 	A branch which is taken every other iteration: 4 instructions on even
+ * 	iterations, and 5 instructions on odd iterations.
+ */
+static uint32_t
+cpi_bench_branch(uint32_t iterations)
+{
+	uint32_t count = 0;
+	uint32_t odd;
+
+	__asm__ volatile(
+		"1:\n"
+		"	andi	%[odd], %[n], 1\n"
+		"	beqz	%[odd], 2f\n"
+		"	addi	%[count], %[count], 1\n"
+		"2:\n"
+		"	addi	%[n], %[n], -1\n"
+		"	bnez	%[n], 1b\n"
+		: [count] "+r"(count), [odd] "=&r"(odd), [n] "+r"(iterations));
+
+	return count;
+}
+
+/*
+ * 	2 loads, 2 stores and 2 ALU instructions, and the loop counter decrement and branch.
+ */
+static uint32_t
+cpi_bench_load_store(uint32_t iterations)
+{
+	uint32_t value;
+
+	__asm__ volatile(
+		"1:\n"
+		"	lw	%[value], 0(%[words])\n"
+		"	addi	%[value], %[value], 1\n"
+		"	sw	%[value], 4(%[words])\n"
+		"	lw	%[value], 8(%[words])\n"
+		"	xor	%[value], %[value], %[n]\n"
+		"	sw	%[value], 12(%[words])\n"
+		"	addi	%[n], %[n], -1\n"
+		"	bnez	%[n], 1b\n"
+		: [value] "=&r"(value), [n] "+r"(iterations)
+		: [words] "r"(cpi_bench_words)
+		: "memory");
+
+	return value;
+}
+
+#ifdef __riscv_mul
+/*
+ * 	3 multiplies and 3 ALU instructions, and the loop counter decrement and branch.
+ */
+static uint32_t
+cpi_bench_mul(uint32_t iterations)
+{
+	uint32_t a = 3;
+	uint32_t b = 5;
+
+	__asm__ volatile(
+		"1:\n"
+		"	mul	%[a], %[a], %[b]\n"
+		"	mulhu	%[b], %[a], %[b]\n"
+		"	addi	%[b], %[b], 7\n"
+		"	mul	%[a], %[a], %[n]\n"
+		"	add	%[a], %[a], %[b]\n"
+		"	addi	%[a], %[a], 1\n"
+		"	addi	%[n], %[n], -1\n"
+		"	bnez	%[n], 1b\n"
+		: [a] "+r"(a), [b] "+r"(b), [n] "+r"(iterations));
+
+	return a + b;
+}
+#endif /* __riscv_mul */
+
+#ifdef __riscv_div
+/*
+ * 	2 divides and 2 ALU instructions, and the loop counter decrement and branch.
+ */
+static uint32_t
+cpi_bench_div(uint32_t iterations)
+{
+	uint32_t a = 0xffffffff;
+	uint32_t b;
+
+	__asm__ volatile(
+		"1:\n"
+		"	divu	%[b], %[a], %[n]\n"
+		"	remu	%[b], %[b], %[n]\n"
+		"	add	%[a], %[a], %[b]\n"
+		"	addi	%[a], %[a], -1\n"
+		"	addi	%[n], %[n], -1\n"
+		"	bnez	%[n], 1b\n"
+		: [a] "+r"(a), [b] "=&r"(b), [n] "+r"(iterations));
+
+	return a;
+}
+#endif /* __riscv_div */
+
+
+static const CpiBenchLoop cpi_bench_loops[] = {
+	{"alu", cpi_bench_alu, 16},
+	{"branch", cpi_bench_branch, 9},
+	{"load/store", cpi_bench_load_store, 16},
+#ifdef __riscv_mul
+	{"mul", cpi_bench_mul, 16},
+#endif
+#ifdef __riscv_div
+	{"div", cpi_bench_div, 12},
+#endif
+};
+
+/*
+ * 	Accumulates the loop results, so that the loops cannot be optimized away.
+ */
+static volatile uint32_t cpi_bench_sink;
+
+
+static void
+cpi_bench_run(const CpiBenchLoop *loop)
+{
+	uint32_t instructions = loop->instructions_per_two_iterations * (kBenchConfigIterations / 2);
+
+	/*
+	 * 	Warm up the caches, if any, with a short run.
+	 */
+	cpi_bench_sink += loop->run(2);
+
+	uint64_t start	 = timer0_get_uptime_cycles();
+	cpi_bench_sink += loop->run(kBenchConfigIterations);
+	uint32_t cycles	 = (uint32_t)(timer0_get_uptime_cycles() - start) - cpi_bench_overhead;
+
+	/*
+	 * 	CPI with two decimals, without floating point.
+	 */
+	uint32_t cpi100	 = (cycles * 100 + instructions / 2) / instructions;
+	uint32_t hundredths = cpi100 % 100;
+
+	uart_printf(
+		"cpi_bench: %*s instructions %*u cycles %*u CPI %u.%c%c\n",
+		10,
+		loop->name,
+		7,
+		instructions,
+		8,
+		cycles,
+		cpi100 / 100,
+		'0' + hundredths / 10,
+		'0' + hundredths % 10);
+}
+
+int
+main(void)
+{
+	timer0_init();
+	uart_init();
+
+	irq_setie(1);
+
+	uint64_t start	   = timer0_get_uptime_cycles();
+	cpi_bench_overhead = (uint32_t)(timer0_get_uptime_cycles() - start);
+
+	uart_printf("\ncpi_bench: %u iterations per loop\n", (uint32_t)kBenchConfigIterations);
+
+	for (uint32_t i = 0; i < sizeof(cpi_bench_loops) / sizeof(cpi_bench_loops[0]); i++)
+	{
+		cpi_bench_run(&cpi_bench_loops[i]);
+	}
+
+	uart_printf("cpi_bench: done\n");
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
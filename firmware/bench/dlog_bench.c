@@ -0,0 +1,133 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Deferred logging benchmark. Build with DLOG=1.
+ *
+ * 	Reports the cycles per DLOG() call, next to the cycles per uart_printf() of
+ * 	the same line, both until it is recorded or enqueued, and until it has been
+ * 	handed to the UART, and the UART bytes per line of both. The output mixes
+ * 	frames and text, decode it with tools/dlog_decode.py. Cycles are measured
+ * 	with profile.h.
+ */
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <stdint.h>
+#include "dlog.h"
+#include "profile.h"
+#include "str_utils.h"
+#include "uart.h"
+
+#ifdef CONFIG_DLOG_DISABLE
+#error "dlog_bench measures deferred logging, build it with DLOG=1"
+#endif
+
+
+typedef enum
+{
+	kBenchConfigIterations = 64,
+} BenchConfig;
+
+
+PROFILE_REGION(bench_dlog_region, "DLOG");
+PROFILE_REGION(bench_dlog_drain_region, "DLOG + dlog_drain + uart_flush");
+PROFILE_REGION(bench_printf_region, "uart_printf");
+PROFILE_REGION(bench_printf_flush_region, "uart_printf + uart_flush");
+
+
+int
+main(void)
+{
+	DlogStats start_stats;
+	DlogStats end_stats;
+
+	timer0_init();
+	uart_init();
+	profile_init();
+
+	irq_setie(1);
+
+	uart_printf("\ndlog_bench: %u iterations\n", (uint32_t)kBenchConfigIterations);
+
+	/*
+	 * 	Sends the clock record, which the first dlog_drain() adds
+	 */
+	dlog_drain(0);
+	uart_flush();
+
+	for (uint32_t i = 0; i < kBenchConfigIterations; i++)
+	{
+		uint64_t start = profile_now();
+		DLOG("dlog_bench: sample %u of %s, value %d\n", i, "sensor", -1000 * (int32_t)i);
+		profile_stop(&bench_dlog_region, start);
+	}
+
+	dlog_drain(kBenchConfigIterations);
+	uart_flush();
+	dlog_get_stats(&start_stats);
+
+	for (uint32_t i = 0; i < kBenchConfigIterations; i++)
+	{
+		uint64_t start = profile_now();
+		DLOG("dlog_bench: sample %u of %s, value %d\n", i, "sensor", -1000 * (int32_t)i);
+		dlog_drain(1);
+		uart_flush();
+		profile_stop(&bench_dlog_drain_region, start);
+	}
+
+	dlog_get_stats(&end_stats);
+
+	for (uint32_t i = 0; i < kBenchConfigIterations; i++)
+	{
+		uint64_t start = profile_now();
+		uart_printf("dlog_bench: sample %u of %s, value %d\n", i, "sensor", -1000 * (int32_t)i);
+		profile_stop(&bench_printf_region, start);
+		uart_flush();
+	}
+
+	uint32_t text_bytes = 0;
+
+	for (uint32_t i = 0; i < kBenchConfigIterations; i++)
+	{
+		uint64_t start = profile_now();
+		text_bytes += uart_printf("dlog_bench: sample %u of %s, value %d\n", i, "sensor", -1000 * (int32_t)i);
+		uart_flush();
+		profile_stop(&bench_printf_flush_region, start);
+	}
+
+	profile_dump();
+	uart_printf(
+		"dlog_bench: %u bytes per frame, %u bytes per text line\n",
+		(end_stats.frame_bytes - start_stats.frame_bytes) / (end_stats.frames - start_stats.frames),
+		text_bytes / kBenchConfigIterations);
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
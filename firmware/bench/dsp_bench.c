@@ -0,0 +1,246 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Fixed-point DSP kernels benchmark.
+ *
+ * 	Reports the cycles per sample of each dsp kernel on a block of
+ * 	kBenchConfigSamples samples, next to the same FIR filter and mean/variance
+ * 	in float, which the RV32IM core runs through soft-float library calls.
+ * 	Cycles are measured with timer0's uptime counter. Build with RAMFUNC=0 to
+ * 	measure the kernels executing from flash.
+ */
+
+#include <generated/csr.h>
+#include <generated/soc.h>
+#include <irq.h>
+#include <stdint.h>
+#include "dsp.h"
+#include "profile.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigSamples	= 256,
+	kBenchConfigFirTaps	= 16,
+	kBenchConfigBiquads	= 2,
+	kBenchConfigAverage	= 32,
+	kBenchConfigFftLog2	= 8,
+} BenchConfig;
+
+
+static DspQ15		bench_in[kBenchConfigSamples];
+static DspQ15		bench_out[kBenchConfigSamples];
+static DspQ31		bench_in_q31[kBenchConfigSamples];
+static DspQ31		bench_out_q31[kBenchConfigSamples];
+static float		bench_in_float[kBenchConfigSamples];
+static float		bench_out_float[kBenchConfigSamples];
+static DspComplexQ15	bench_fft[1 << kBenchConfigFftLog2];
+static DspQ15		bench_fir_coeffs[kBenchConfigFirTaps];
+static DspQ15		bench_fir_state[2 * kBenchConfigFirTaps];
+static float		bench_fir_coeffs_float[kBenchConfigFirTaps];
+static DspQ15		bench_average_window[kBenchConfigAverage];
+
+static const DspBiquadCoeffsQ15 bench_biquad_coeffs[kBenchConfigBiquads] = {
+	{DSP_Q14(0.0201), DSP_Q14(0.0402), DSP_Q14(0.0201), DSP_Q14(-1.5610), DSP_Q14(0.6414)},
+	{DSP_Q14(0.0201), DSP_Q14(0.0402), DSP_Q14(0.0201), DSP_Q14(-1.7640), DSP_Q14(0.8444)},
+};
+static const DspBiquadCoeffsQ31 bench_biquad_coeffs_q31[kBenchConfigBiquads] = {
+	{DSP_Q30(0.0201), DSP_Q30(0.0402), DSP_Q30(0.0201), DSP_Q30(-1.5610), DSP_Q30(0.6414)},
+	{DSP_Q30(0.0201), DSP_Q30(0.0402), DSP_Q30(0.0201), DSP_Q30(-1.7640), DSP_Q30(0.8444)},
+};
+static DspBiquadStateQ15 bench_biquad_state[kBenchConfigBiquads];
+static DspBiquadStateQ31 bench_biquad_state_q31[kBenchConfigBiquads];
+
+static volatile int64_t bench_sink;
+static volatile float	bench_sink_float;
+
+
+/**
+ * 	@brief Float FIR filter, the soft-float baseline of dsp_fir_q15().
+ */
+static void
+bench_fir_float(const float *  in, float *  out, uint32_t n)
+{
+	for (uint32_t s = 0; s < n; s++)
+	{
+		float acc = 0;
+
+		for (uint32_t k = 0; k < kBenchConfigFirTaps && k <= s; k++)
+		{
+			acc += bench_fir_coeffs_float[k] * in[s - k];
+		}
+
+		out[s] = acc;
+	}
+}
+
+/**
+ * 	@brief Float Welford mean and variance, the soft-float baseline of dsp_welford_q15_update().
+ */
+static void
+bench_welford_float(const float *  in, uint32_t n)
+{
+	float mean = 0;
+	float m2   = 0;
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		float delta = in[i] - mean;
+
+		mean += delta / (float)(i + 1);
+		m2 += delta * (in[i] - mean);
+	}
+
+	bench_sink_float = m2 / (float)(n - 1) + mean;
+}
+
+static void
+bench_report(const char *  name, uint64_t start, uint32_t samples)
+{
+	uint64_t cycles = profile_now() - start;
+
+	uart_printf(
+		"dsp_bench: %s: %u cycles/sample\n",
+		name,
+		(uint32_t)((cycles + samples / 2) / samples));
+}
+
+int
+main(void)
+{
+	timer0_init();
+	uart_init();
+	profile_init();
+
+	irq_setie(1);
+
+	uint32_t seed = 1;
+
+	for (uint32_t i = 0; i < kBenchConfigSamples; i++)
+	{
+		seed		  = seed * 1664525 + 1013904223;
+		bench_in[i]	  = (DspQ15)(seed >> 17);
+		bench_in_q31[i]	  = (DspQ31)(seed >> 1) - (1 << 29);
+		bench_in_float[i] = bench_in[i] / 32768.0f;
+	}
+	for (uint32_t k = 0; k < kBenchConfigFirTaps; k++)
+	{
+		bench_fir_coeffs[k]	  = DSP_Q15(1.0 / kBenchConfigFirTaps);
+		bench_fir_coeffs_float[k] = 1.0f / kBenchConfigFirTaps;
+	}
+
+	uart_printf(
+		"\ndsp_bench: %u-sample blocks, %u-tap FIR, %u biquad sections, %u-sample average, %u-point FFT\n",
+		(uint32_t)kBenchConfigSamples,
+		(uint32_t)kBenchConfigFirTaps,
+		(uint32_t)kBenchConfigBiquads,
+		(uint32_t)kBenchConfigAverage,
+		(uint32_t)(1 << kBenchConfigFftLog2));
+	uart_flush();
+
+	/*
+	 * 	Interrupts stay enabled, but the UART is idle while measuring.
+	 */
+	uint64_t start = profile_now();
+	bench_sink     = dsp_dot_q15(bench_in, bench_in, kBenchConfigSamples);
+	bench_report("dot_q15", start, kBenchConfigSamples);
+	uart_flush();
+
+	start	   = profile_now();
+	bench_sink = dsp_dot_q31(bench_in_q31, bench_in_q31, kBenchConfigSamples);
+	bench_report("dot_q31", start, kBenchConfigSamples);
+	uart_flush();
+
+	DspFirQ15 fir;
+	dsp_fir_q15_init(&fir, bench_fir_coeffs, bench_fir_state, kBenchConfigFirTaps);
+	start = profile_now();
+	dsp_fir_q15(&fir, bench_in, bench_out, kBenchConfigSamples);
+	bench_report("fir_q15", start, kBenchConfigSamples);
+	uart_flush();
+
+	start = profile_now();
+	bench_fir_float(bench_in_float, bench_out_float, kBenchConfigSamples);
+	bench_report("fir float (soft-float)", start, kBenchConfigSamples);
+	uart_flush();
+
+	DspBiquadQ15 biquad;
+	dsp_biquad_q15_init(&biquad, bench_biquad_coeffs, bench_biquad_state, kBenchConfigBiquads);
+	start = profile_now();
+	dsp_biquad_q15(&biquad, bench_in, bench_out, kBenchConfigSamples);
+	bench_report("biquad_q15", start, kBenchConfigSamples);
+	uart_flush();
+
+	DspBiquadQ31 biquad_q31;
+	dsp_biquad_q31_init(&biquad_q31, bench_biquad_coeffs_q31, bench_biquad_state_q31, kBenchConfigBiquads);
+	start = profile_now();
+	dsp_biquad_q31(&biquad_q31, bench_in_q31, bench_out_q31, kBenchConfigSamples);
+	bench_report("biquad_q31", start, kBenchConfigSamples);
+	uart_flush();
+
+	DspIir1Q15 iir;
+	dsp_iir1_q15_init(&iir, DSP_Q15(0.01));
+	start = profile_now();
+	dsp_iir1_q15(&iir, bench_in, bench_out, kBenchConfigSamples);
+	bench_report("iir1_q15", start, kBenchConfigSamples);
+	uart_flush();
+
+	DspMovingAverageQ15 average;
+	dsp_moving_average_q15_init(&average, bench_average_window, kBenchConfigAverage);
+	start = profile_now();
+	dsp_moving_average_q15(&average, bench_in, bench_out, kBenchConfigSamples);
+	bench_report("moving_average_q15", start, kBenchConfigSamples);
+	uart_flush();
+
+	DspWelfordQ15 welford;
+	dsp_welford_q15_init(&welford);
+	start = profile_now();
+	dsp_welford_q15_update(&welford, bench_in, kBenchConfigSamples);
+	bench_report("welford_q15", start, kBenchConfigSamples);
+	uart_flush();
+
+	start = profile_now();
+	bench_welford_float(bench_in_float, kBenchConfigSamples);
+	bench_report("welford float (soft-float)", start, kBenchConfigSamples);
+	uart_flush();
+
+	for (uint32_t i = 0; i < (1 << kBenchConfigFftLog2); i++)
+	{
+		bench_fft[i].re = bench_in[i] / 2;
+		bench_fft[i].im = 0;
+	}
+	start = profile_now();
+	dsp_fft_q15(bench_fft, kBenchConfigFftLog2);
+	bench_report("fft_q15", start, 1 << kBenchConfigFftLog2);
+
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
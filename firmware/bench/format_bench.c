@@ -0,0 +1,163 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+/*
+ * 	Integer formatting benchmark.
+ *
+ * 	Reports the average cycles per conversion of newlib's itoa() followed by
+ * 	strlen() (the conversion str_utils used to do), next to the division-free
+ * 	str_utils conversions, and the cycles per str_utils_format() call for a
+ * 	typical log line, next to the same line compiled by fmt.h (through its C
+ * 	shim, fmt_bench_value_format()). Cycles are measured with timer0's uptime
+ * 	counter.
+ */
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fmt_shims.h"
+#include "str_utils.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigIterations = 1024,
+} BenchConfig;
+
+
+static uint32_t bench_values[kBenchConfigIterations];
+static char	bench_buf[32];
+
+/*
+ * 	Accumulates the conversion lengths, so that the conversions cannot be optimized away.
+ */
+static volatile uint32_t bench_sink;
+
+/*
+ * 	Cycles spent reading the uptime counter twice, subtracted from every measurement.
+ */
+static uint32_t bench_overhead;
+
+
+static void
+bench_init_values(void)
+{
+	uint32_t state = 0x2545f491;
+
+	for (int i = 0; i < kBenchConfigIterations; i++)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		/*
+		 * 	Spread the values over every digit count
+		 */
+		bench_values[i] = state >> (i % 32);
+	}
+}
+
+static uint32_t
+bench_average(uint64_t cycles)
+{
+	return (uint32_t)(cycles / kBenchConfigIterations) - bench_overhead;
+}
+
+static void
+bench_calibrate(void)
+{
+	uint64_t start = timer0_get_uptime_cycles();
+	uint64_t end   = timer0_get_uptime_cycles();
+	bench_overhead = (uint32_t)(end - start);
+}
+
+/*
+ * 	Measures the average cycles of statement over kBenchConfigIterations values.
+ */
+#define BENCH_MEASURE(name, statement)                                                                   \
+	do                                                                                               \
+	{                                                                                                \
+		uint64_t total = 0;                                                                      \
+		for (int i = 0; i < kBenchConfigIterations; i++)                                         \
+		{                                                                                        \
+			uint32_t value = bench_values[i];                                                \
+			uint64_t start = timer0_get_uptime_cycles();                                     \
+			statement;                                                                       \
+			total += timer0_get_uptime_cycles() - start;                                     \
+		}                                                                                        \
+		uart_printf("  %*s %*u cycles\n", 28, name, 6, bench_average(total));                   \
+	}                                                                                                \
+	while (0)
+
+int
+main(void)
+{
+	timer0_init();
+	uart_init();
+
+	irq_setie(1);
+
+	bench_init_values();
+	bench_calibrate();
+
+	uart_printf("\nformat_bench: %u values, %u cycles counter overhead\n", kBenchConfigIterations, bench_overhead);
+
+	uart_printf("decimal:\n");
+	BENCH_MEASURE("itoa(10) + strlen", bench_sink += strlen(itoa((int)value, bench_buf, 10)));
+	BENCH_MEASURE("str_utils_u32_to_dec", bench_sink += str_utils_u32_to_dec(bench_buf, value));
+
+	uart_printf("hexadecimal:\n");
+	BENCH_MEASURE("itoa(16) + strlen", bench_sink += strlen(itoa((int)value, bench_buf, 16)));
+	BENCH_MEASURE("str_utils_u32_to_hex", bench_sink += str_utils_u32_to_hex(bench_buf, value));
+
+	uart_printf("64-bit:\n");
+	BENCH_MEASURE(
+		"str_utils_u64_to_dec",
+		bench_sink += str_utils_u64_to_dec(bench_buf, ((uint64_t)value << 32) | value));
+	BENCH_MEASURE(
+		"str_utils_u64_to_hex",
+		bench_sink += str_utils_u64_to_hex(bench_buf, ((uint64_t)value << 32) | value));
+
+	uart_printf("str_utils_format:\n");
+	BENCH_MEASURE(
+		"\"val=%d hex=%x\\n\"",
+		bench_sink += str_utils_format(bench_buf, sizeof(bench_buf), "val=%d hex=%x\n", (int)value, value));
+
+	uart_printf("fmt.h:\n");
+	BENCH_MEASURE(
+		"fmt_bench_value_format",
+		bench_sink += fmt_bench_value_format(bench_buf, sizeof(bench_buf), (int32_t)value, value));
+
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
@@ -0,0 +1,227 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+/*
+ * 	Memory function benchmark.
+ *
+ * 	Reports the cycles per memcpy(), memmove(), memset(), memcmp() and
+ * 	strlen() call of the word-oriented versions in src/mem.c, for a few
+ * 	sizes, next to byte-by-byte loops, which is how the C library's generic
+ * 	versions, built for size, work. The byte loops execute from flash, as the
+ * 	C library does, and the src/mem.c functions from SRAM (RAMFUNC), unless
+ * 	built with RAMFUNC=0. Cycles are measured with profile.h.
+ */
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "profile.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigMaxSize	= 4096,
+	kBenchConfigRounds	= 8,
+} BenchConfig;
+
+/*
+ * 	Without -ftree-loop-distribute-patterns, so that the byte loops are not turned into calls to
+ * 	the functions they are compared with.
+ */
+#define BENCH_BYTEWISE __attribute__((noinline, optimize("no-tree-loop-distribute-patterns")))
+
+
+static uint8_t bench_a[kBenchConfigMaxSize + 8] __attribute__((aligned(4)));
+static uint8_t bench_b[kBenchConfigMaxSize + 8] __attribute__((aligned(4)));
+
+static volatile size_t bench_sink;
+
+
+static BENCH_BYTEWISE void
+bench_bytewise_memcpy(uint8_t *  dst, const uint8_t *  src, size_t n)
+{
+	while (n--)
+	{
+		*dst++ = *src++;
+	}
+}
+
+static BENCH_BYTEWISE void
+bench_bytewise_memmove(uint8_t *  dst, const uint8_t *  src, size_t n)
+{
+	dst += n;
+	src += n;
+	while (n--)
+	{
+		*--dst = *--src;
+	}
+}
+
+static BENCH_BYTEWISE void
+bench_bytewise_memset(uint8_t *  dst, int c, size_t n)
+{
+	while (n--)
+	{
+		*dst++ = c;
+	}
+}
+
+static BENCH_BYTEWISE int
+bench_bytewise_memcmp(const uint8_t *  a, const uint8_t *  b, size_t n)
+{
+	while (n--)
+	{
+		if (*a != *b)
+		{
+			return *a - *b;
+		}
+		a++;
+		b++;
+	}
+
+	return 0;
+}
+
+static BENCH_BYTEWISE size_t
+bench_bytewise_strlen(const char *  s)
+{
+	const char *  p = s;
+
+	while (*p != '\0')
+	{
+		p++;
+	}
+
+	return p - s;
+}
+
+typedef enum
+{
+	kBenchFunctionMemcpy,
+	kBenchFunctionMemcpyMisaligned,
+	kBenchFunctionMemmove,
+	kBenchFunctionMemset,
+	kBenchFunctionMemcmp,
+	kBenchFunctionStrlen,
+	kBenchFunctionCount,
+} BenchFunction;
+
+static const char *  bench_function_names[kBenchFunctionCount] = {
+	"memcpy",
+	"memcpy, misaligned",
+	"memmove, backwards",
+	"memset",
+	"memcmp",
+	"strlen",
+};
+
+/*
+ * 	Returns the minimum cycles per call over kBenchConfigRounds calls.
+ */
+static uint32_t
+bench_run(BenchFunction function, int bytewise, size_t n)
+{
+	uint64_t min = UINT64_MAX;
+
+	for (int round = 0; round < kBenchConfigRounds; round++)
+	{
+		uint64_t start = profile_now();
+
+		switch (function)
+		{
+			case kBenchFunctionMemcpy:
+				bytewise ? bench_bytewise_memcpy(bench_a, bench_b, n) : (void)memcpy(bench_a, bench_b, n);
+				break;
+			case kBenchFunctionMemcpyMisaligned:
+				bytewise ? bench_bytewise_memcpy(bench_a, bench_b + 1, n) : (void)memcpy(bench_a, bench_b + 1, n);
+				break;
+			case kBenchFunctionMemmove:
+				bytewise ? bench_bytewise_memmove(bench_a + 4, bench_a, n) : (void)memmove(bench_a + 4, bench_a, n);
+				break;
+			case kBenchFunctionMemset:
+				bytewise ? bench_bytewise_memset(bench_a, 0x5a, n) : (void)memset(bench_a, 0x5a, n);
+				break;
+			case kBenchFunctionMemcmp:
+				bench_sink = bytewise ? bench_bytewise_memcmp(bench_a, bench_b, n) : memcmp(bench_a, bench_b, n);
+				break;
+			default:
+				bench_sink = bytewise ? bench_bytewise_strlen((const char *)bench_b) : strlen((const char *)bench_b);
+				break;
+		}
+
+		uint64_t cycles = profile_now() - start;
+
+		if (cycles < min)
+		{
+			min = cycles;
+		}
+	}
+
+	return (uint32_t)min;
+}
+
+int
+main(void)
+{
+	static const uint32_t sizes[] = {8, 64, 512, 4096};
+
+	timer0_init();
+	uart_init();
+	profile_init();
+
+	irq_setie(1);
+
+	uart_printf("\nmem_bench: cycles per call, minimum of %u calls\n", (uint32_t)kBenchConfigRounds);
+	uart_printf("%*s %*s %*s %*s\n", 20, "function", 6, "bytes", 10, "mem.c", 10, "bytewise");
+
+	for (BenchFunction function = 0; function < kBenchFunctionCount; function++)
+	{
+		for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		{
+			uint32_t n = sizes[i];
+
+			for (uint32_t j = 0; j < kBenchConfigMaxSize + 8; j++)
+			{
+				bench_a[j] = 0x5a;
+				bench_b[j] = 0x5a;
+			}
+			bench_b[n] = '\0';
+
+			uint32_t mem_cycles	 = bench_run(function, 0, n);
+			uint32_t bytewise_cycles = bench_run(function, 1, n);
+
+			uart_printf("%*s %*u %*u %*u\n", 20, bench_function_names[function], 6, n, 10, mem_cycles, 10, bytewise_cycles);
+		}
+	}
+
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
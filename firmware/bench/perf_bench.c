@@ -0,0 +1,192 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	CPU bus performance counters benchmark.
+ *
+ * 	Runs workloads bound by different parts of the SoC, and prints the bus
+ * 	transactions and wait states of each, from the gateware's performance
+ * 	counters (PERF_COUNTERS=1 in config.mk):
+ * 	- the same checksum loop over an SRAM buffer, executing in place from
+ * 	  flash, and from SRAM (RAMFUNC), to show the cost of instruction fetches
+ * 	  from flash,
+ * 	- a checksum of a table in flash, executing from SRAM, to show the cost of
+ * 	  data reads from flash,
+ * 	- a CSR polling loop.
+ * 	With BOOT_MODE=sram, all the code and data is in SRAM, and the first three
+ * 	workloads should only differ in their instruction counts.
+ */
+
+#include <generated/csr.h>
+#include <generated/soc.h>
+#include <irq.h>
+#include <stdint.h>
+#include "perf_counters.h"
+#include "profile.h"
+#include "ramfunc.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigBufferWords	= 1024,
+	kBenchConfigCsrReads	= 1024,
+} BenchConfig;
+
+
+static uint32_t bench_buffer[kBenchConfigBufferWords];
+
+/*
+ * 	In flash when executing in place, since it is const.
+ */
+static const uint32_t bench_table[kBenchConfigBufferWords] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+static volatile uint32_t bench_sink;
+
+
+static __attribute__((noinline)) uint32_t
+bench_checksum_flash(const uint32_t *  words, uint32_t count)
+{
+	uint32_t sum = 0;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		sum = (sum << 1 | sum >> 31) ^ words[i];
+	}
+
+	return sum;
+}
+
+static __attribute__((noinline)) RAMFUNC uint32_t
+bench_checksum_ram(const uint32_t *  words, uint32_t count)
+{
+	uint32_t sum = 0;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		sum = (sum << 1 | sum >> 31) ^ words[i];
+	}
+
+	return sum;
+}
+
+static __attribute__((noinline)) RAMFUNC uint32_t
+bench_csr_poll(uint32_t count)
+{
+	uint32_t sum = 0;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		sum += timer0_value_read();
+	}
+
+	return sum;
+}
+
+typedef enum
+{
+	kBenchWorkloadFlashCode,
+	kBenchWorkloadRamCode,
+	kBenchWorkloadFlashData,
+	kBenchWorkloadCsr,
+	kBenchWorkloadCount,
+} BenchWorkload;
+
+static const char *  bench_workload_names[kBenchWorkloadCount] = {
+	"code in flash",
+	"code in SRAM",
+	"data in flash",
+	"CSR polling",
+};
+
+static void
+bench_run(BenchWorkload workload)
+{
+	PerfCounters start;
+	PerfCounters end;
+
+	uart_flush();
+
+	perf_counters_snapshot(&start);
+
+	switch (workload)
+	{
+		case kBenchWorkloadFlashCode:
+			bench_sink = bench_checksum_flash(bench_buffer, kBenchConfigBufferWords);
+			break;
+		case kBenchWorkloadRamCode:
+			bench_sink = bench_checksum_ram(bench_buffer, kBenchConfigBufferWords);
+			break;
+		case kBenchWorkloadFlashData:
+			bench_sink = bench_checksum_ram(bench_table, kBenchConfigBufferWords);
+			break;
+		default:
+			bench_sink = bench_csr_poll(kBenchConfigCsrReads);
+			break;
+	}
+
+	perf_counters_snapshot(&end);
+	perf_counters_diff(&start, &end, &end);
+	perf_counters_print(bench_workload_names[workload], &end);
+}
+
+int
+main(void)
+{
+	timer0_init();
+	uart_init();
+	profile_init();
+
+	irq_setie(1);
+
+	if (!perf_counters_supported())
+	{
+		uart_printf("\nperf_bench: no performance counters in the gateware, build it with PERF_COUNTERS=1\n");
+	}
+	else
+	{
+		perf_counters_init();
+
+		for (uint32_t i = 0; i < kBenchConfigBufferWords; i++)
+		{
+			bench_buffer[i] = i * 2654435761u;
+		}
+
+		uart_printf("\nperf_bench: %u-word checksums, %u CSR reads\n", (uint32_t)kBenchConfigBufferWords, (uint32_t)kBenchConfigCsrReads);
+
+		for (BenchWorkload workload = 0; workload < kBenchWorkloadCount; workload++)
+		{
+			bench_run(workload);
+		}
+	}
+
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Binary protocol benchmark.
+ *
+ * 	Serves the framed binary protocol (proto.h) on the UART, from a task posted
+ * 	by the UART RX callback, for the host side in tools/c0link.py, e.g.:
+ *
+ * 	python3 tools/c0link.py --port /dev/ttyACM0 test
+ *
+ * 	which echoes random payloads, pipelined, and reports the throughput. The
+ * 	kBenchCommandStats command returns the protocol counters (ProtoStats), and
+ * 	the UART driver counters (UartStats), as little-endian 32-bit words.
+ */
+
+#include <generated/csr.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "proto.h"
+#include "sched.h"
+#include "timers.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchCommandStats = kProtoCommandUser,
+} BenchCommand;
+
+typedef enum
+{
+	kBenchTaskProto = 0,
+} BenchTask;
+
+
+static SchedTask bench_proto_task;
+
+
+static int32_t
+bench_stats(const uint8_t *  request, uint32_t request_len, uint8_t *  response, uint32_t response_max)
+{
+	ProtoStats proto_stats;
+	UartStats  uart_stats;
+
+	(void)request;
+
+	if (request_len != 0)
+	{
+		return -kProtoStatusBadRequest;
+	}
+
+	if (sizeof(proto_stats) + sizeof(uart_stats) > response_max)
+	{
+		return -kProtoStatusError;
+	}
+
+	proto_get_stats(&proto_stats);
+	uart_get_stats(&uart_stats);
+
+	/*
+	 * 	Both are made of 32-bit counters, and the CPU is little-endian.
+	 */
+	memcpy(response, &proto_stats, sizeof(proto_stats));
+	memcpy(&response[sizeof(proto_stats)], &uart_stats, sizeof(uart_stats));
+
+	return (int32_t)(sizeof(proto_stats) + sizeof(uart_stats));
+}
+
+static const ProtoCommand bench_commands[] = {
+	{kBenchCommandStats, bench_stats},
+};
+
+static void
+bench_proto(void *  ctx)
+{
+	(void)ctx;
+	proto_poll();
+}
+
+static void
+bench_uart_rx_callback(void)
+{
+	sched_post(&bench_proto_task);
+}
+
+int
+main(void)
+{
+	timers_init();
+	uart_init();
+
+	proto_init(bench_commands, sizeof(bench_commands) / sizeof(bench_commands[0]));
+	sched_task_init(&bench_proto_task, kBenchTaskProto, "proto", bench_proto, NULL);
+	uart_set_rx_callback(bench_uart_rx_callback);
+
+	uart_printf("\nproto_bench: serving, window %u, max payload %u\n", (uint32_t)kPROTO_CONF_WINDOW, (uint32_t)kPROTO_CONF_MAX_PAYLOAD);
+
+	sched_run();
+
+	return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+/*
+ * 	Code placement benchmark.
+ *
+ * 	Reports the average cycles per uart_printf() call, and per str_utils_format()
+ * 	call, for the code placement this firmware was built with. Compare a default
+ * 	build (RAMFUNC functions execute from SRAM) with a RAMFUNC=0 build
+ * 	(everything executes in place from flash):
+ * 	make BENCH=ramfunc_bench
+ * 	make BENCH=ramfunc_bench RAMFUNC=0
+ *
+ * 	uart_printf() is measured in interrupt-driven mode, while the TX ring buffer
+ * 	has room for the whole line, so the measurement is the CPU cost of the call,
+ * 	not the time it takes to send the line.
+ */
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <time.h>
+#include <stdint.h>
+#include "ramfunc.h"
+#include "str_utils.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigIterations = 64,
+} BenchConfig;
+
+
+static char bench_buf[64];
+
+/*
+ * 	Average cycles of statement over kBenchConfigIterations calls, minus the counter overhead.
+ * 	The UART TX ring buffer is flushed between calls, outside of the measurement.
+ */
+#define BENCH_MEASURE(name, statement)                                                                   \
+	do                                                                                               \
+	{                                                                                                \
+		uint64_t total = 0;                                                                      \
+		for (int i = 0; i < kBenchConfigIterations; i++)                                         \
+		{                                                                                        \
+			uart_flush();                                                                    \
+			uint64_t start = timer0_get_uptime_cycles();                                     \
+			statement;                                                                       \
+			total += timer0_get_uptime_cycles() - start;                                     \
+		}                                                                                        \
+		uart_flush();                                                                            \
+		uart_printf(                                                                             \
+			"\n  %*s %*u cycles\n",                                                          \
+			36,                                                                              \
+			name,                                                                            \
+			8,                                                                               \
+			(uint32_t)(total / kBenchConfigIterations) - overhead);                          \
+	}                                                                                                \
+	while (0)
+
+int
+main(void)
+{
+	timer0_init();
+	uart_init();
+
+	irq_setie(1);
+
+	uint64_t start	  = timer0_get_uptime_cycles();
+	uint32_t overhead = (uint32_t)(timer0_get_uptime_cycles() - start);
+
+#ifdef CONFIG_RAMFUNC_DISABLE
+	uart_printf("\nramfunc_bench: code executes from flash\n");
+#else
+	uart_printf("\nramfunc_bench: RAMFUNC code executes from SRAM\n");
+#endif
+	uart_printf(
+		"uart_printf at 0x%x, str_utils_format_sink at 0x%x\n",
+		(uint32_t)(uintptr_t)&uart_printf,
+		(uint32_t)(uintptr_t)&str_utils_format_sink);
+
+	BENCH_MEASURE("uart_printf(\"LED: Red\\n\")", uart_printf("LED: Red\n"));
+	BENCH_MEASURE("uart_printf(\"%d %x\\n\")", uart_printf("%d %x\n", -123456, 0xc0ffee));
+	BENCH_MEASURE(
+		"str_utils_format(\"%*s=%u\\n\")",
+		str_utils_format(bench_buf, sizeof(bench_buf), "%*s=%u\n", 12, "cycles", 4000000000U));
+
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
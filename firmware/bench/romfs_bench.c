@@ -0,0 +1,115 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Read-only file image benchmark.
+ *
+ * 	Mounts the image flashed by `make flash-romfs BENCH=romfs_bench`, lists its
+ * 	files, checks the CRC of each, and reports the cycles per romfs_mount(),
+ * 	per romfs_open() of every file and of a name which is not in the image,
+ * 	and the bytes/s of romfs_verify(), which reads the files from flash. Cycles
+ * 	are measured with profile.h.
+ */
+
+#include <generated/csr.h>
+#include <generated/mem.h>
+#include <generated/soc.h>
+#include <irq.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "profile.h"
+#include "romfs.h"
+#include "spiflash.h"
+#include "uart.h"
+
+
+PROFILE_REGION(bench_mount_region, "romfs_mount");
+PROFILE_REGION(bench_open_region, "romfs_open");
+PROFILE_REGION(bench_open_missing_region, "romfs_open, not found");
+
+
+int
+main(void)
+{
+	spiflash_init();
+	timer0_init();
+	uart_init();
+	profile_init();
+
+	irq_setie(1);
+
+	uart_printf("\nromfs_bench: image at 0x%x\n", (uint32_t)(uintptr_t)ROMFS_FLASH_ADDRESS);
+
+	uint64_t		start = profile_now();
+	const RomfsHeader *	image = romfs_mount(ROMFS_FLASH_ADDRESS, ROMFS_FLASH_SIZE);
+
+	profile_stop(&bench_mount_region, start);
+
+	if (image == NULL)
+	{
+		uart_printf("romfs_bench: no image, flash one with make flash-romfs ROMFS_DIR=<directory>\n");
+	}
+	else
+	{
+		uint32_t	bytes	      = 0;
+		uint64_t	verify_cycles = 0;
+		RomfsFile	file;
+		RomfsFile	found;
+
+		for (uint32_t i = 0; romfs_file_at(image, i, &file); i++)
+		{
+			start = profile_now();
+			romfs_open(image, file.name, &found);
+			profile_stop(&bench_open_region, start);
+
+			start	   = profile_now();
+			bool valid = romfs_verify(&file);
+			verify_cycles += profile_now() - start;
+			bytes += file.size;
+
+			uart_printf("  %*u %s %s\n", 10, file.size, file.name, valid ? "" : "(CRC error)");
+		}
+
+		start = profile_now();
+		romfs_open(image, "romfs_bench: not a file", &found);
+		profile_stop(&bench_open_missing_region, start);
+
+		uart_printf(
+			"romfs_bench: %u files, %u bytes, verified at %u bytes/s\n",
+			image->count,
+			bytes,
+			(verify_cycles != 0) ? (uint32_t)(((uint64_t)bytes * CONFIG_CLOCK_FREQUENCY) / verify_cycles) : 0);
+	}
+
+	profile_dump();
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Scheduler benchmark.
+ *
+ * 	A 1ms software timer posts a task, which does a small amount of work, and
+ * 	the UART RX interrupt posts an echo task, as in the demo firmware. After
+ * 	kBenchConfigDurationMs, a report task prints the idle CPU percentage, and
+ * 	the post-to-run latency of each task, in cycles, from the timer0 or UART
+ * 	interrupt to the start of the task. Type into the serial port while the
+ * 	benchmark runs to load the echo task.
+ */
+
+#include <generated/csr.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "profile.h"
+#include "sched.h"
+#include "timers.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigDurationMs	= 5000,
+	kBenchConfigTickMs	= 1,
+	kBenchConfigWorkLoops	= 100,
+} BenchConfig;
+
+typedef enum
+{
+	kBenchTaskUartEcho = 0,
+	kBenchTaskTick	   = 1,
+	kBenchTaskReport   = 2,
+} BenchTask;
+
+
+static SchedTask       bench_uart_echo_task;
+static SchedTask       bench_tick_task;
+static SchedTask       bench_report_task;
+static TimerWheelTimer bench_tick_timer;
+static TimerWheelTimer bench_report_timer;
+
+static volatile uint32_t bench_sink;
+
+
+static void
+bench_uart_echo(void *  ctx)
+{
+	(void)ctx;
+	uart_echo();
+}
+
+static void
+bench_uart_rx_callback(void)
+{
+	sched_post(&bench_uart_echo_task);
+}
+
+static void
+bench_tick(void *  ctx)
+{
+	(void)ctx;
+
+	for (int i = 0; i < kBenchConfigWorkLoops; i++)
+	{
+		bench_sink += i;
+	}
+}
+
+static void
+bench_report(void *  ctx)
+{
+	(void)ctx;
+
+	timers_cancel(&bench_tick_timer);
+	sched_dump();
+}
+
+static void
+bench_post_callback(void *  ctx)
+{
+	sched_post(ctx);
+}
+
+int
+main(void)
+{
+	timers_init();
+	uart_init();
+	profile_init();
+
+	sched_task_init(&bench_uart_echo_task, kBenchTaskUartEcho, "uart_echo", bench_uart_echo, NULL);
+	sched_task_init(&bench_tick_task, kBenchTaskTick, "tick", bench_tick, NULL);
+	sched_task_init(&bench_report_task, kBenchTaskReport, "report", bench_report, NULL);
+
+	uart_set_rx_callback(bench_uart_rx_callback);
+	timers_start_ms(&bench_tick_timer, kBenchConfigTickMs, kBenchConfigTickMs, bench_post_callback, &bench_tick_task);
+	timers_start_ms(&bench_report_timer, kBenchConfigDurationMs, 0, bench_post_callback, &bench_report_task);
+
+	uart_printf("\nsched_bench: %u ms, tick task every %u ms\n", (uint32_t)kBenchConfigDurationMs, (uint32_t)kBenchConfigTickMs);
+
+	sched_run();
+
+	return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+/*
+ * 	SPI flash execute-in-place (XIP) throughput benchmark.
+ *
+ * 	Reads a block of the rom region through the memory mapped flash interface,
+ * 	sequentially and with a large stride, and reports bytes/s and cycles per
+ * 	32-bit word. The measurement loops execute from SRAM, so instruction fetches
+ * 	do not compete with the measured reads. Build one bitstream per
+ * 	--spi-flash-mode (SPI_FLASH_MODE in config.mk) to compare the modes.
+ */
+
+#include <generated/csr.h>
+#include <generated/mem.h>
+#include <generated/soc.h>
+#include <irq.h>
+#include <time.h>
+#include <stdint.h>
+#include "ramfunc.h"
+#include "spiflash.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	/*
+	 * 	Offset of the measured block from the start of the rom region, past the firmware.
+	 */
+	kBenchConfigOffset	  = 0x100000,
+	kBenchConfigBlockSize	  = 16 * 1024,
+	kBenchConfigStride	  = 4096,
+	kBenchConfigStrideReads	  = 256,
+} BenchConfig;
+
+
+static volatile uint32_t bench_sink;
+
+
+static RAMFUNC_REQUIRED uint64_t
+bench_read_sequential(const volatile uint32_t *  block, uint32_t words)
+{
+	uint32_t sum   = 0;
+	uint64_t start = timer0_get_uptime_cycles();
+
+	for (uint32_t i = 0; i < words; i += 4)
+	{
+		sum += block[i] + block[i + 1] + block[i + 2] + block[i + 3];
+	}
+
+	uint64_t cycles = timer0_get_uptime_cycles() - start;
+	bench_sink	= sum;
+
+	return cycles;
+}
+
+static RAMFUNC_REQUIRED uint64_t
+bench_read_strided(const volatile uint32_t *  block, uint32_t reads)
+{
+	uint32_t sum   = 0;
+	uint64_t start = timer0_get_uptime_cycles();
+
+	for (uint32_t i = 0; i < reads; i++)
+	{
+		sum += block[(i * kBenchConfigStride / sizeof(uint32_t)) % (kBenchConfigBlockSize / sizeof(uint32_t))];
+	}
+
+	uint64_t cycles = timer0_get_uptime_cycles() - start;
+	bench_sink	= sum;
+
+	return cycles;
+}
+
+static void
+bench_report(const char *  name, uint32_t bytes, uint64_t cycles)
+{
+	uart_printf(
+		"  %*s %*u bytes/s, %u cycles/word\n",
+		12,
+		name,
+		10,
+		(uint32_t)(((uint64_t)bytes * CONFIG_CLOCK_FREQUENCY) / cycles),
+		(uint32_t)(cycles / (bytes / sizeof(uint32_t))));
+}
+
+int
+main(void)
+{
+	spiflash_init();
+	timer0_init();
+	uart_init();
+
+	irq_setie(1);
+
+	const volatile uint32_t *  block = (const volatile uint32_t *)(ROM_BASE + kBenchConfigOffset);
+
+	uart_printf("\nspiflash_bench: mode %s, %u Hz\n", CONFIG_SPIFLASH_READ_MODE, CONFIG_CLOCK_FREQUENCY);
+	if (spiflash_has_master())
+	{
+		uart_printf(
+			"status registers: 0x%x 0x%x\n",
+			spiflash_read_status(kSpiFlashCmdReadStatus1),
+			spiflash_read_status(kSpiFlashCmdReadStatus2));
+	}
+	uart_flush();
+
+	/*
+	 * 	Interrupts off, so that the UART does not add to the measurement
+	 */
+	irq_setie(0);
+	uint64_t sequential = bench_read_sequential(block, kBenchConfigBlockSize / sizeof(uint32_t));
+	uint64_t strided    = bench_read_strided(block, kBenchConfigStrideReads);
+	irq_setie(1);
+
+	bench_report("sequential", kBenchConfigBlockSize, sequential);
+	bench_report("strided", kBenchConfigStrideReads * sizeof(uint32_t), strided);
+
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
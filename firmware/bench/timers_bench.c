@@ -0,0 +1,153 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Timer wheel benchmark.
+ *
+ * 	Reports the cycles per timer_wheel_tick() call, i.e. the work the timer0
+ * 	tick interrupt does on top of the trap entry and exit, for a growing number
+ * 	of pending periodic timers, and the cycles per timers_start_ms() and
+ * 	timers_cancel() call. Cycles are measured with profile.h.
+ */
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "profile.h"
+#include "timer_wheel.h"
+#include "timers.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigTicks	= 4096,
+	kBenchConfigMaxTimers	= 256,
+	kBenchConfigOps		= 256,
+} BenchConfig;
+
+
+static TimerWheel      bench_wheel;
+static TimerWheelTimer bench_timers[kBenchConfigMaxTimers];
+static uint32_t	       bench_rng_state = 0x12345678;
+
+
+static uint32_t
+bench_rand(void)
+{
+	/*
+	 * 	xorshift32
+	 */
+	bench_rng_state ^= bench_rng_state << 13;
+	bench_rng_state ^= bench_rng_state >> 17;
+	bench_rng_state ^= bench_rng_state << 5;
+	return bench_rng_state;
+}
+
+static void
+bench_nop_callback(void *  ctx)
+{
+	(void)ctx;
+}
+
+/*
+ * 	Periods of up to 4 wheel revolutions, so that the slots also hold timers which are skipped.
+ */
+static void
+bench_ticks(int timers)
+{
+	PROFILE_REGION(region, "timer_wheel_tick");
+
+	timer_wheel_init(&bench_wheel);
+
+	for (int i = 0; i < timers; i++)
+	{
+		uint32_t period = 1 + bench_rand() % (4 * kTIMER_WHEEL_CONF_SLOTS);
+		timer_wheel_start(&bench_wheel, &bench_timers[i], bench_rand() % period, period, bench_nop_callback, NULL);
+	}
+
+	uint32_t fired = 0;
+	for (int tick = 0; tick < kBenchConfigTicks; tick++)
+	{
+		uint64_t start = profile_now();
+		fired += timer_wheel_tick(&bench_wheel);
+		profile_stop(&region, start);
+	}
+
+	uart_printf(
+		"%*u timers: %*u min %*u mean %*u max cycles/tick, %u callbacks\n",
+		4,
+		(uint32_t)timers,
+		6,
+		region.min,
+		6,
+		(uint32_t)(region.total / region.count),
+		6,
+		region.max,
+		fired);
+
+	profile_reset();
+}
+
+int
+main(void)
+{
+	uart_init();
+	timers_init();
+	profile_init();
+
+	irq_setie(1);
+
+	uart_printf("\ntimers_bench: %u ticks per case, %u slots\n", (uint32_t)kBenchConfigTicks, (uint32_t)kTIMER_WHEEL_CONF_SLOTS);
+
+	for (int timers = 1; timers <= kBenchConfigMaxTimers; timers *= 4)
+	{
+		bench_ticks(timers);
+	}
+
+	for (int i = 0; i < kBenchConfigOps; i++)
+	{
+		PROFILE_SCOPE("timers_start_ms");
+		timers_start_ms(&bench_timers[0], 1000 + i, 0, bench_nop_callback, NULL);
+	}
+
+	for (int i = 0; i < kBenchConfigOps; i++)
+	{
+		timers_start_ms(&bench_timers[0], 1000 + i, 0, bench_nop_callback, NULL);
+
+		PROFILE_SCOPE("timers_cancel");
+		timers_cancel(&bench_timers[0]);
+	}
+
+	profile_dump();
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
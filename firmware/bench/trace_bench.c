@@ -0,0 +1,98 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Tracing benchmark.
+ *
+ * 	Reports the cycles per TRACE_INSTANT() trace point, next to the cycles per
+ * 	uart_printf() of the same information, both until it is enqueued and until
+ * 	it has been handed to the UART. Then prints the recorded trace, which can be
+ * 	decoded with tools/trace_decode.py. Cycles are measured with profile.h.
+ */
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <stdint.h>
+#include "profile.h"
+#include "trace.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigIterations = 64,
+} BenchConfig;
+
+
+PROFILE_REGION(bench_trace_region, "TRACE_INSTANT");
+PROFILE_REGION(bench_printf_region, "uart_printf");
+PROFILE_REGION(bench_printf_flush_region, "uart_printf + uart_flush");
+
+
+int
+main(void)
+{
+	timer0_init();
+	uart_init();
+	profile_init();
+
+	irq_setie(1);
+
+	uart_printf("\ntrace_bench: %u iterations\n", (uint32_t)kBenchConfigIterations);
+	uart_flush();
+
+	for (uint32_t i = 0; i < kBenchConfigIterations; i++)
+	{
+		uint64_t start = profile_now();
+		TRACE_INSTANT("trace_bench", i);
+		profile_stop(&bench_trace_region, start);
+	}
+
+	for (uint32_t i = 0; i < kBenchConfigIterations; i++)
+	{
+		uint64_t start = profile_now();
+		uart_printf("trace_bench %u\n", i);
+		profile_stop(&bench_printf_region, start);
+		uart_flush();
+	}
+
+	for (uint32_t i = 0; i < kBenchConfigIterations; i++)
+	{
+		uint64_t start = profile_now();
+		uart_printf("trace_bench %u\n", i);
+		uart_flush();
+		profile_stop(&bench_printf_flush_region, start);
+	}
+
+	profile_dump();
+	trace_dump();
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+/*
+ * 	UART driver benchmark.
+ *
+ * 	1. TX: measures the CPU time spent inside uart_printf() for a line that fits in
+ * 	   the TX ring buffer, and the sustained throughput of a transfer much larger
+ * 	   than the ring buffer.
+ * 	2. RX: keeps the main loop busy for kBenchConfigBusyPeriodMs at a time, and
+ * 	   reports how many received bytes were kept and how many were dropped.
+ * 	   Send a burst from the host while it runs, e.g.:
+ * 	   head -c 4096 /dev/urandom > /dev/ttyACM0
+ */
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <time.h>
+#include <stdint.h>
+#include "uart.h"
+#include "leds.h"
+
+
+typedef enum
+{
+	kBenchConfigLineLength	   = 64,
+	kBenchConfigLineCount	   = 256,
+	kBenchConfigBusyPeriodMs   = 100,
+	kBenchConfigReportPeriodMs = 1000,
+} BenchConfig;
+
+
+static char bench_line[kBenchConfigLineLength + 1];
+
+
+static timer0_t
+bench_now(void)
+{
+	return timer0_get_time_passed_since_last_load();
+}
+
+static uint32_t
+bench_bytes_per_second(uint32_t bytes, timer0_t ticks)
+{
+	if (ticks == 0)
+	{
+		return 0;
+	}
+
+	return (uint32_t)(((uint64_t)bytes * CONFIG_CLOCK_FREQUENCY) / ticks);
+}
+
+static void
+bench_tx(void)
+{
+	for (int i = 0; i < kBenchConfigLineLength - 1; i++)
+	{
+		bench_line[i] = 'a' + (i % 26);
+	}
+	bench_line[kBenchConfigLineLength - 1] = '\n';
+	bench_line[kBenchConfigLineLength]     = '\0';
+
+	/*
+	 * 	Cost of a single call, while the ring buffer has room for the whole line.
+	 */
+	uart_flush();
+	timer0_t start	     = bench_now();
+	uart_printf("%s", bench_line);
+	timer0_t single_call = timer0_get_duration(start, bench_now());
+	uart_flush();
+
+	/*
+	 * 	Sustained throughput: kBenchConfigLineCount lines, mostly limited by the baud rate.
+	 */
+	UartStats before;
+	UartStats after;
+	uart_get_stats(&before);
+
+	start = bench_now();
+	for (int i = 0; i < kBenchConfigLineCount; i++)
+	{
+		uart_printf("%s", bench_line);
+	}
+	timer0_t enqueued = timer0_get_duration(start, bench_now());
+	uart_flush();
+	timer0_t drained = timer0_get_duration(start, bench_now());
+
+	uart_get_stats(&after);
+
+	uint32_t bytes = kBenchConfigLineLength * kBenchConfigLineCount;
+
+	uart_printf("\nTX: single uart_printf of %d bytes: %d ticks\n", kBenchConfigLineLength, single_call);
+	uart_printf(
+		"TX: %d bytes, enqueue %d ms, drain %d ms, %d bytes/s, %d stalls\n",
+		bytes,
+		timer0_ticks_to_ms(enqueued),
+		timer0_ticks_to_ms(drained),
+		bench_bytes_per_second(bytes, drained),
+		after.tx_stalls - before.tx_stalls);
+}
+
+static void
+bench_rx(void)
+{
+	char	 buf[32];
+	timer0_t last_report = bench_now();
+
+	uart_printf("RX: busy for %d ms per loop, send data now\n", kBenchConfigBusyPeriodMs);
+
+	while (1)
+	{
+		/*
+		 * 	Pretend to be busy, without touching the UART.
+		 */
+		timer0_t busy_start = bench_now();
+		while (timer0_ticks_to_ms(timer0_get_duration(busy_start, bench_now())) < kBenchConfigBusyPeriodMs)
+		{
+			;
+		}
+
+		while (uart_read(buf, sizeof(buf)) != 0)
+		{
+			;
+		}
+
+		if (timer0_ticks_to_ms(timer0_get_duration(last_report, bench_now())) >= kBenchConfigReportPeriodMs)
+		{
+			UartStats stats;
+			uart_get_stats(&stats);
+			uart_printf("RX: %d bytes received, %d dropped\n", stats.rx_bytes, stats.rx_dropped);
+			last_report = bench_now();
+			leds_toggle();
+		}
+	}
+}
+
+int
+main(void)
+{
+	timer0_init();
+	leds_init();
+	uart_init();
+
+	irq_setie(1);
+
+	timer0_set_periodic_mode_ticks(UINT32_MAX);
+
+	bench_tx();
+	bench_rx();
+
+	return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	UART TX DMA benchmark.
+ *
+ * 	Sends a kBenchConfigBlockSize block through the TX ring buffer (uart_write_async()
+ * 	falls back to uart_putchar() without the TX DMA) and through the TX DMA, and
+ * 	reports the cycles spent in the call, the cycles until the block is sent, and
+ * 	the percentage of that time the CPU had left for the main loop. The CPU time
+ * 	left is measured by counting the iterations of an idle loop until the block is
+ * 	sent, against the cycles per iteration of the same loop with the UART idle.
+ * 	Needs gateware built with UART_TX_DMA=1 in config.mk for the DMA rounds.
+ */
+
+#include <generated/csr.h>
+#include <generated/soc.h>
+#include <irq.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "profile.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigBlockSize		= 4096,
+	kBenchConfigCalibrateIterations	= 100000,
+	kBenchConfigRounds		= 3,
+} BenchConfig;
+
+
+static char bench_block[kBenchConfigBlockSize];
+static volatile uint32_t bench_idle;
+
+
+/**
+ * 	@brief Idle loop iteration, the unit of CPU time left to the main loop.
+ */
+static inline void
+bench_idle_iteration(void)
+{
+	bench_idle++;
+}
+
+static void
+bench_round(const char *  name, bool dma, uint32_t idle_cycles_per_1k)
+{
+	uart_flush();
+
+	bench_idle     = 0;
+	uint64_t start = profile_now();
+
+	if (dma)
+	{
+		uart_write_async(bench_block, kBenchConfigBlockSize);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < kBenchConfigBlockSize; i++)
+		{
+			uart_putchar(bench_block[i]);
+		}
+	}
+
+	uint64_t call = profile_now() - start;
+
+	while (uart_tx_busy())
+	{
+		bench_idle_iteration();
+	}
+
+	uint64_t elapsed = profile_now() - start;
+	uint64_t idle	 = ((uint64_t)bench_idle * idle_cycles_per_1k) / 1000;
+
+	uart_printf(
+		"\nuart_dma_bench: %s: %u cycles in the call, %u cycles until sent, %u%% CPU left\n",
+		name,
+		(uint32_t)call,
+		(uint32_t)elapsed,
+		(uint32_t)((idle * 100) / elapsed));
+}
+
+int
+main(void)
+{
+	timer0_init();
+	uart_init();
+	profile_init();
+
+	irq_setie(1);
+
+	for (uint32_t i = 0; i < kBenchConfigBlockSize; i++)
+	{
+		bench_block[i] = ((i % 64) == 63) ? '\n' : 'a' + (i % 26);
+	}
+
+	uart_flush();
+
+	bench_idle     = 0;
+	uint64_t start = profile_now();
+
+	for (uint32_t i = 0; i < kBenchConfigCalibrateIterations; i++)
+	{
+		bench_idle_iteration();
+	}
+
+	uint32_t idle_cycles_per_1k = (uint32_t)(((profile_now() - start) * 1000) / kBenchConfigCalibrateIterations);
+
+#ifdef CSR_UART_TX_DMA_BASE_ADDR
+	uart_printf("\nuart_dma_bench: %u-byte block, TX DMA present\n", (uint32_t)kBenchConfigBlockSize);
+#else
+	uart_printf("\nuart_dma_bench: %u-byte block, no TX DMA in the gateware\n", (uint32_t)kBenchConfigBlockSize);
+#endif
+
+	for (uint32_t round = 0; round < kBenchConfigRounds; round++)
+	{
+		bench_round("ring buffer", false, idle_cycles_per_1k);
+		bench_round("uart_write_async", true, idle_cycles_per_1k);
+	}
+
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
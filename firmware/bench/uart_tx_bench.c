@@ -0,0 +1,138 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Sustained UART TX throughput benchmark.
+ *
+ * 	Keeps the TX ring buffer full for kBenchConfigDurationMs, and reports the
+ * 	bytes per second handed to the UART, next to the line rate of the baud rate
+ * 	the gateware was built with (CONFIG_UART_BAUDRATE, 10 bits per byte), e.g.
+ * 	to check a higher UART_BAUDRATE or UART_FIFO_DEPTH in config.mk. Measure on
+ * 	the host as well, e.g.:
+ * 	cat /dev/ttyACM0 | pv > /dev/null
+ */
+
+#include <generated/csr.h>
+#include <generated/soc.h>
+#include <irq.h>
+#include <stdint.h>
+#include "profile.h"
+#include "uart.h"
+
+
+/*
+ * 	Gateware built before the UART configuration was exported uses LiteX's defaults.
+ */
+#ifndef CONFIG_UART_BAUDRATE
+	#define CONFIG_UART_BAUDRATE	115200
+	#define CONFIG_UART_FIFO_DEPTH	16
+#endif
+
+typedef enum
+{
+	kBenchConfigDurationMs	= 2000,
+	kBenchConfigLineLength	= 64,
+	kBenchConfigRounds	= 3,
+} BenchConfig;
+
+
+static char bench_line[kBenchConfigLineLength + 1];
+
+
+static void
+bench_round(uint32_t round)
+{
+	UartStats before;
+	UartStats after;
+	uint64_t  duration = (uint64_t)CONFIG_CLOCK_FREQUENCY * kBenchConfigDurationMs / 1000;
+
+	uart_flush();
+	uart_get_stats(&before);
+
+	uint64_t start = profile_now();
+
+	while (profile_now() - start < duration)
+	{
+		uart_printf("%s", bench_line);
+	}
+
+	uart_flush();
+
+	uint64_t elapsed = profile_now() - start;
+
+	uart_get_stats(&after);
+
+	uint32_t bytes		= after.tx_bytes - before.tx_bytes;
+	uint32_t bytes_per_s	= (uint32_t)(((uint64_t)bytes * CONFIG_CLOCK_FREQUENCY) / elapsed);
+	uint32_t line_rate	= CONFIG_UART_BAUDRATE / 10;
+	uint32_t line_permille	= (uint32_t)(((uint64_t)bytes_per_s * 1000) / line_rate);
+
+	uart_printf(
+		"\nuart_tx_bench: round %u: %u bytes in %u ms, %u bytes/s, %u.%u%% of the %u bytes/s line rate, %u stalls\n",
+		round,
+		bytes,
+		(uint32_t)((elapsed * 1000) / CONFIG_CLOCK_FREQUENCY),
+		bytes_per_s,
+		line_permille / 10,
+		line_permille % 10,
+		line_rate,
+		after.tx_stalls - before.tx_stalls);
+}
+
+int
+main(void)
+{
+	timer0_init();
+	uart_init();
+	profile_init();
+
+	irq_setie(1);
+
+	for (int i = 0; i < kBenchConfigLineLength - 1; i++)
+	{
+		bench_line[i] = 'a' + (i % 26);
+	}
+	bench_line[kBenchConfigLineLength - 1] = '\n';
+	bench_line[kBenchConfigLineLength]     = '\0';
+
+	uart_printf(
+		"\nuart_tx_bench: %u baud, %u-byte hardware FIFOs, %u-byte TX ring buffer\n",
+		(uint32_t)CONFIG_UART_BAUDRATE,
+		(uint32_t)CONFIG_UART_FIFO_DEPTH,
+		(uint32_t)kUART_CONF_TX_BUFFER_SIZE);
+
+	for (uint32_t round = 0; round < kBenchConfigRounds; round++)
+	{
+		bench_round(round);
+	}
+
+	uart_flush();
+
+	while (1)
+	{
+		;
+	}
+
+	return 0;
+}
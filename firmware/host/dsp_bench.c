@@ -0,0 +1,601 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Host accuracy test and benchmark for the dsp fixed-point kernels.
+ *
+ * 	1. Accuracy: runs every kernel on random and sinusoidal signals, next to a
+ * 	   double-precision reference fed with the same quantized coefficients and
+ * 	   samples, and checks the largest error, in LSBs of the output format,
+ * 	   against a limit set by the kernel's rounding.
+ * 	2. Benchmark: reports ns per sample of each kernel.
+ *
+ * 	Exits with a non-zero status if any kernel exceeds its error limit.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "dsp.h"
+
+
+typedef enum
+{
+	kBenchConfigSamples	= 4096,
+	kBenchConfigFirTaps	= 32,
+	kBenchConfigBiquads	= 2,
+	kBenchConfigAverage	= 100,
+	kBenchConfigWelford	= 100000,
+	kBenchConfigBenchRounds	= 200,
+} BenchConfig;
+
+
+static uint32_t bench_rng_state = 0x12345678;
+static int	bench_failures	= 0;
+
+static DspQ15	bench_in_q15[kBenchConfigSamples];
+static DspQ15	bench_out_q15[kBenchConfigSamples];
+static DspQ31	bench_in_q31[kBenchConfigSamples];
+static DspQ31	bench_out_q31[kBenchConfigSamples];
+static double	bench_reference[kBenchConfigSamples];
+
+
+static uint32_t
+bench_rand(void)
+{
+	/*
+	 * 	xorshift32
+	 */
+	bench_rng_state ^= bench_rng_state << 13;
+	bench_rng_state ^= bench_rng_state >> 17;
+	bench_rng_state ^= bench_rng_state << 5;
+	return bench_rng_state;
+}
+
+/*
+ * 	Uniform in [-amplitude, amplitude).
+ */
+static double
+bench_uniform(double amplitude)
+{
+	return amplitude * ((double)bench_rand() / 2147483648.0 - 1.0);
+}
+
+static DspQ15
+bench_to_q15(double value)
+{
+	return dsp_q15_saturate((int32_t)lround(value * 32768.0));
+}
+
+static DspQ31
+bench_to_q31(double value)
+{
+	return dsp_q31_saturate(llround(value * 2147483648.0));
+}
+
+/*
+ * 	Half random noise, half the sum of two sines, at amplitude.
+ */
+static void
+bench_signal(double amplitude)
+{
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		double value = (i < kBenchConfigSamples / 2)
+			? bench_uniform(amplitude)
+			: amplitude * (0.6 * sin(0.01 * i) + 0.4 * sin(0.37 * i));
+
+		bench_in_q15[i] = bench_to_q15(value);
+		bench_in_q31[i] = bench_to_q31(value);
+	}
+}
+
+static void
+bench_check(const char *  name, double error, double limit)
+{
+	bool failed = !(error <= limit);
+
+	printf("accuracy: %-28s max error %10.4f LSB (limit %g)%s\n", name, error, limit, failed ? " FAIL" : "");
+	bench_failures += failed;
+}
+
+static double
+bench_max_error_q15(void)
+{
+	double error = 0;
+
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		error = fmax(error, fabs(bench_out_q15[i] - bench_reference[i] * 32768.0));
+	}
+
+	return error;
+}
+
+static double
+bench_max_error_q31(void)
+{
+	double error = 0;
+
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		error = fmax(error, fabs(bench_out_q31[i] - bench_reference[i] * 2147483648.0));
+	}
+
+	return error;
+}
+
+static void
+bench_accuracy_dot(void)
+{
+	bench_signal(1.0);
+
+	/*
+	 * 	The Q15 products are exact.
+	 */
+	double reference = 0;
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		reference += (double)bench_in_q15[i] * bench_in_q15[kBenchConfigSamples - 1 - i];
+	}
+	DspQ15 reversed_q15[kBenchConfigSamples];
+	DspQ31 reversed_q31[kBenchConfigSamples];
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		reversed_q15[i] = bench_in_q15[kBenchConfigSamples - 1 - i];
+		reversed_q31[i] = bench_in_q31[kBenchConfigSamples - 1 - i];
+	}
+	bench_check(
+		"dot_q15 (Q30)",
+		fabs((double)dsp_dot_q15(bench_in_q15, reversed_q15, kBenchConfigSamples) - reference),
+		0);
+
+	/*
+	 * 	Each Q31 product is truncated to Q30, so each term may be off by up to one Q30 LSB.
+	 */
+	reference = 0;
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		reference += (double)bench_in_q31[i] * reversed_q31[i] / 4294967296.0;
+	}
+	bench_check(
+		"dot_q31 (Q30)",
+		fabs((double)dsp_dot_q31(bench_in_q31, reversed_q31, kBenchConfigSamples) - reference),
+		kBenchConfigSamples);
+}
+
+static void
+bench_accuracy_fir(void)
+{
+	DspQ15	  coeffs[kBenchConfigFirTaps];
+	DspQ15	  state[2 * kBenchConfigFirTaps];
+	DspFirQ15 fir;
+
+	/*
+	 * 	Hann-windowed sinc low-pass at a tenth of the sample rate.
+	 */
+	for (int k = 0; k < kBenchConfigFirTaps; k++)
+	{
+		double t      = k - (kBenchConfigFirTaps - 1) / 2.0;
+		double sinc   = (t == 0) ? 0.2 : sin(0.2 * M_PI * t) / (M_PI * t);
+		double window = 0.5 - 0.5 * cos(2 * M_PI * k / (kBenchConfigFirTaps - 1));
+		coeffs[k]     = bench_to_q15(sinc * window);
+	}
+
+	bench_signal(0.99);
+	dsp_fir_q15_init(&fir, coeffs, state, kBenchConfigFirTaps);
+	dsp_fir_q15(&fir, bench_in_q15, bench_out_q15, kBenchConfigSamples / 3);
+	dsp_fir_q15(&fir, bench_in_q15 + kBenchConfigSamples / 3, bench_out_q15 + kBenchConfigSamples / 3, kBenchConfigSamples - kBenchConfigSamples / 3);
+
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		double acc = 0;
+		for (int k = 0; k < kBenchConfigFirTaps && k <= i; k++)
+		{
+			acc += (coeffs[k] / 32768.0) * (bench_in_q15[i - k] / 32768.0);
+		}
+		bench_reference[i] = acc;
+	}
+
+	bench_check("fir_q15, 32 taps, 2 blocks", bench_max_error_q15(), 0.5);
+}
+
+/*
+ * 	RBJ low-pass biquad, normalized so that a0 = 1.
+ */
+static void
+bench_biquad_design(double frequency, double q, double coeffs[5])
+{
+	double w0    = 2 * M_PI * frequency;
+	double alpha = sin(w0) / (2 * q);
+	double a0    = 1 + alpha;
+
+	coeffs[0] = (1 - cos(w0)) / 2 / a0;
+	coeffs[1] = (1 - cos(w0)) / a0;
+	coeffs[2] = (1 - cos(w0)) / 2 / a0;
+	coeffs[3] = -2 * cos(w0) / a0;
+	coeffs[4] = (1 - alpha) / a0;
+}
+
+/*
+ * 	Runs the double-precision cascade on in, in the given input and coefficient scale.
+ */
+static void
+bench_biquad_reference(double coeffs[][5], int stages, const double *  in)
+{
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		bench_reference[i] = in[i];
+	}
+
+	for (int stage = 0; stage < stages; stage++)
+	{
+		double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+		double *c = coeffs[stage];
+
+		for (int i = 0; i < kBenchConfigSamples; i++)
+		{
+			double x = bench_reference[i];
+			double y = c[0] * x + c[1] * x1 + c[2] * x2 - c[3] * y1 - c[4] * y2;
+
+			x2		   = x1;
+			x1		   = x;
+			y2		   = y1;
+			y1		   = y;
+			bench_reference[i] = y;
+		}
+	}
+}
+
+static void
+bench_accuracy_biquad(void)
+{
+	double			design[kBenchConfigBiquads][5];
+	double			quantized[kBenchConfigBiquads][5];
+	double			in[kBenchConfigSamples];
+	DspBiquadCoeffsQ15	coeffs_q15[kBenchConfigBiquads];
+	DspBiquadStateQ15	state_q15[kBenchConfigBiquads];
+	DspBiquadCoeffsQ31	coeffs_q31[kBenchConfigBiquads];
+	DspBiquadStateQ31	state_q31[kBenchConfigBiquads];
+	DspBiquadQ15		biquad_q15;
+	DspBiquadQ31		biquad_q31;
+
+	bench_biquad_design(0.05, 0.54, design[0]);
+	bench_biquad_design(0.05, 1.31, design[1]);
+	bench_signal(0.5);
+
+	/*
+	 * 	Q15, in Q14 coefficients.
+	 */
+	for (int stage = 0; stage < kBenchConfigBiquads; stage++)
+	{
+		DspQ15 *c = &coeffs_q15[stage].b0;
+		for (int k = 0; k < 5; k++)
+		{
+			c[k]		    = dsp_q15_saturate((int32_t)lround(design[stage][k] * 16384.0));
+			quantized[stage][k] = c[k] / 16384.0;
+		}
+	}
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		in[i] = bench_in_q15[i] / 32768.0;
+	}
+	dsp_biquad_q15_init(&biquad_q15, coeffs_q15, state_q15, kBenchConfigBiquads);
+	dsp_biquad_q15(&biquad_q15, bench_in_q15, bench_out_q15, kBenchConfigSamples);
+	bench_biquad_reference(quantized, kBenchConfigBiquads, in);
+	bench_check("biquad_q15, 2 sections", bench_max_error_q15(), 16);
+
+	/*
+	 * 	Q31, in Q30 coefficients.
+	 */
+	for (int stage = 0; stage < kBenchConfigBiquads; stage++)
+	{
+		DspQ31 *c = &coeffs_q31[stage].b0;
+		for (int k = 0; k < 5; k++)
+		{
+			c[k]		    = dsp_q31_saturate(llround(design[stage][k] * 1073741824.0));
+			quantized[stage][k] = c[k] / 1073741824.0;
+		}
+	}
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		in[i] = bench_in_q31[i] / 2147483648.0;
+	}
+	dsp_biquad_q31_init(&biquad_q31, coeffs_q31, state_q31, kBenchConfigBiquads);
+	dsp_biquad_q31(&biquad_q31, bench_in_q31, bench_out_q31, kBenchConfigSamples);
+	bench_biquad_reference(quantized, kBenchConfigBiquads, in);
+	/*
+	 * 	The products are truncated to Q29, and the feedback amplifies their errors.
+	 */
+	bench_check("biquad_q31, 2 sections", bench_max_error_q31(), 1024);
+}
+
+static void
+bench_accuracy_iir1(void)
+{
+	DspIir1Q15 iir;
+	DspQ15	   alpha = DSP_Q15(0.01);
+	double	   y	 = 0;
+
+	bench_signal(0.99);
+	dsp_iir1_q15_init(&iir, alpha);
+	dsp_iir1_q15(&iir, bench_in_q15, bench_out_q15, kBenchConfigSamples);
+
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		y += (alpha / 32768.0) * (bench_in_q15[i] / 32768.0 - y);
+		bench_reference[i] = y;
+	}
+
+	bench_check("iir1_q15, alpha 0.01", bench_max_error_q15(), 1);
+}
+
+static void
+bench_accuracy_moving_average(void)
+{
+	DspQ15		    window[kBenchConfigAverage];
+	DspMovingAverageQ15 average;
+	double		    sum = 0;
+
+	bench_signal(1.0);
+	dsp_moving_average_q15_init(&average, window, kBenchConfigAverage);
+	dsp_moving_average_q15(&average, bench_in_q15, bench_out_q15, kBenchConfigSamples);
+
+	for (int i = 0; i < kBenchConfigSamples; i++)
+	{
+		sum += bench_in_q15[i] / 32768.0;
+		if (i >= kBenchConfigAverage)
+		{
+			sum -= bench_in_q15[i - kBenchConfigAverage] / 32768.0;
+		}
+		bench_reference[i] = sum / kBenchConfigAverage;
+	}
+
+	bench_check("moving_average_q15, 100", bench_max_error_q15(), 0.5);
+}
+
+static void
+bench_accuracy_welford(void)
+{
+	static DspQ15 samples[kBenchConfigWelford];
+	DspWelfordQ15 welford;
+	double	      mean     = 0;
+	double	      variance = 0;
+
+	/*
+	 * 	An offset, so that a naive sum of squares would lose precision.
+	 */
+	for (int i = 0; i < kBenchConfigWelford; i++)
+	{
+		samples[i] = bench_to_q15(0.7 + bench_uniform(0.25));
+		mean += samples[i] / 32768.0;
+	}
+	mean /= kBenchConfigWelford;
+	for (int i = 0; i < kBenchConfigWelford; i++)
+	{
+		double delta = samples[i] / 32768.0 - mean;
+		variance += delta * delta;
+	}
+	variance /= kBenchConfigWelford - 1;
+
+	dsp_welford_q15_init(&welford);
+	for (int i = 0; i < kBenchConfigWelford; i += 1000)
+	{
+		dsp_welford_q15_update(&welford, &samples[i], 1000);
+	}
+
+	/*
+	 * 	In Q15 LSBs, since the samples are Q15.
+	 */
+	bench_check("welford_q15 mean (Q15)", fabs(dsp_welford_q15_mean(&welford) / 65536.0 - mean * 32768.0), 0.01);
+	bench_check("welford_q15 variance (Q15)", fabs(dsp_welford_q15_variance(&welford) / 65536.0 - variance * 32768.0), 0.01);
+}
+
+static void
+bench_accuracy_fft(void)
+{
+	static DspComplexQ15 data[1 << kDSP_CONF_FFT_MAX_LOG2];
+	static double	     re[1 << kDSP_CONF_FFT_MAX_LOG2];
+	static double	     im[1 << kDSP_CONF_FFT_MAX_LOG2];
+
+	for (uint32_t log2n = 1; log2n <= kDSP_CONF_FFT_MAX_LOG2; log2n++)
+	{
+		uint32_t n     = 1u << log2n;
+		double	 error = 0;
+
+		/*
+		 * 	Complex samples of magnitude below 1.
+		 */
+		for (uint32_t i = 0; i < n; i++)
+		{
+			data[i].re = bench_to_q15(bench_uniform(0.7));
+			data[i].im = bench_to_q15(bench_uniform(0.7));
+			re[i]	   = data[i].re / 32768.0;
+			im[i]	   = data[i].im / 32768.0;
+		}
+
+		dsp_fft_q15(data, log2n);
+
+		for (uint32_t k = 0; k < n; k++)
+		{
+			double sum_re = 0;
+			double sum_im = 0;
+
+			for (uint32_t i = 0; i < n; i++)
+			{
+				double angle = -2 * M_PI * (double)((uint64_t)i * k % n) / n;
+				sum_re += re[i] * cos(angle) - im[i] * sin(angle);
+				sum_im += re[i] * sin(angle) + im[i] * cos(angle);
+			}
+
+			error = fmax(error, fabs(data[k].re - sum_re / n * 32768.0));
+			error = fmax(error, fabs(data[k].im - sum_im / n * 32768.0));
+		}
+
+		/*
+		 * 	Each stage rounds its twiddle products and its scaling by 1/2.
+		 */
+		char name[32];
+		snprintf(name, sizeof(name), "fft_q15, %u points", n);
+		bench_check(name, error, 0.5 * log2n);
+	}
+}
+
+static uint64_t
+bench_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static volatile int64_t bench_sink;
+
+static void
+bench_report(const char *  name, uint64_t start, uint64_t samples)
+{
+	printf("  %-28s %8.2f ns/sample\n", name, (double)(bench_now_ns() - start) / samples);
+}
+
+static void
+bench_speed(void)
+{
+	static DspQ15		  coeffs[kBenchConfigFirTaps];
+	static DspQ15		  state[2 * kBenchConfigFirTaps];
+	static DspQ15		  window[kBenchConfigAverage];
+	static DspComplexQ15	  data[1 << kDSP_CONF_FFT_MAX_LOG2];
+	static DspBiquadCoeffsQ15 biquad_coeffs[kBenchConfigBiquads];
+	static DspBiquadStateQ15  biquad_state[kBenchConfigBiquads];
+	DspFirQ15		  fir;
+	DspBiquadQ15		  biquad;
+	DspIir1Q15		  iir;
+	DspMovingAverageQ15	  average;
+	DspWelfordQ15		  welford;
+	uint64_t		  samples = (uint64_t)kBenchConfigBenchRounds * kBenchConfigSamples;
+	uint64_t		  start;
+
+	bench_signal(0.5);
+	for (int k = 0; k < kBenchConfigFirTaps; k++)
+	{
+		coeffs[k] = DSP_Q15(1.0 / kBenchConfigFirTaps);
+	}
+	for (int stage = 0; stage < kBenchConfigBiquads; stage++)
+	{
+		biquad_coeffs[stage] = (DspBiquadCoeffsQ15){DSP_Q14(0.02), DSP_Q14(0.04), DSP_Q14(0.02), DSP_Q14(-1.56), DSP_Q14(0.64)};
+	}
+
+	printf("speed:\n");
+
+	start = bench_now_ns();
+	for (int round = 0; round < kBenchConfigBenchRounds; round++)
+	{
+		bench_sink = dsp_dot_q15(bench_in_q15, bench_in_q15, kBenchConfigSamples);
+	}
+	bench_report("dot_q15", start, samples);
+
+	start = bench_now_ns();
+	for (int round = 0; round < kBenchConfigBenchRounds; round++)
+	{
+		bench_sink = dsp_dot_q31(bench_in_q31, bench_in_q31, kBenchConfigSamples);
+	}
+	bench_report("dot_q31", start, samples);
+
+	dsp_fir_q15_init(&fir, coeffs, state, kBenchConfigFirTaps);
+	start = bench_now_ns();
+	for (int round = 0; round < kBenchConfigBenchRounds; round++)
+	{
+		dsp_fir_q15(&fir, bench_in_q15, bench_out_q15, kBenchConfigSamples);
+	}
+	bench_report("fir_q15, 32 taps", start, samples);
+
+	dsp_biquad_q15_init(&biquad, biquad_coeffs, biquad_state, kBenchConfigBiquads);
+	start = bench_now_ns();
+	for (int round = 0; round < kBenchConfigBenchRounds; round++)
+	{
+		dsp_biquad_q15(&biquad, bench_in_q15, bench_out_q15, kBenchConfigSamples);
+	}
+	bench_report("biquad_q15, 2 sections", start, samples);
+
+	dsp_iir1_q15_init(&iir, DSP_Q15(0.01));
+	start = bench_now_ns();
+	for (int round = 0; round < kBenchConfigBenchRounds; round++)
+	{
+		dsp_iir1_q15(&iir, bench_in_q15, bench_out_q15, kBenchConfigSamples);
+	}
+	bench_report("iir1_q15", start, samples);
+
+	dsp_moving_average_q15_init(&average, window, kBenchConfigAverage);
+	start = bench_now_ns();
+	for (int round = 0; round < kBenchConfigBenchRounds; round++)
+	{
+		dsp_moving_average_q15(&average, bench_in_q15, bench_out_q15, kBenchConfigSamples);
+	}
+	bench_report("moving_average_q15", start, samples);
+
+	dsp_welford_q15_init(&welford);
+	start = bench_now_ns();
+	for (int round = 0; round < kBenchConfigBenchRounds; round++)
+	{
+		dsp_welford_q15_update(&welford, bench_in_q15, kBenchConfigSamples);
+		dsp_welford_q15_init(&welford);
+	}
+	bench_report("welford_q15", start, samples);
+
+	start = bench_now_ns();
+	for (int round = 0; round < kBenchConfigBenchRounds; round++)
+	{
+		for (int i = 0; i < (1 << kDSP_CONF_FFT_MAX_LOG2); i++)
+		{
+			data[i].re = bench_in_q15[i];
+			data[i].im = 0;
+		}
+		dsp_fft_q15(data, kDSP_CONF_FFT_MAX_LOG2);
+	}
+	bench_report("fft_q15, 1024 points", start, (uint64_t)kBenchConfigBenchRounds << kDSP_CONF_FFT_MAX_LOG2);
+}
+
+int
+main(void)
+{
+	bench_accuracy_dot();
+	bench_accuracy_fir();
+	bench_accuracy_biquad();
+	bench_accuracy_iir1();
+	bench_accuracy_moving_average();
+	bench_accuracy_welford();
+	bench_accuracy_fft();
+
+	bench_speed();
+
+	if (bench_failures != 0)
+	{
+		printf("FAIL: %d kernels exceed their error limit\n", bench_failures);
+		return 1;
+	}
+
+	return 0;
+}
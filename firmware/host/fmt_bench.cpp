@@ -0,0 +1,325 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Host benchmark and fuzz harness for the compile-time formatting front end (include/fmt.h).
+ *
+ * 	1. Fuzz: formats random arguments with fmt::format(), for formats covering every conversion specifier,
+ * 	   length modifier and padding, into buffers of random size, and compares both the output and the returned
+ * 	   length with str_utils_format() given the same format string. The C shims of include/fmt_shims.h are
+ * 	   checked the same way, with uart_putchar() capturing the output of the UART variants.
+ * 	2. Benchmark: reports ns/call of fmt::format(), next to str_utils_format(), for a few representative formats.
+ *
+ * 	Exits with a non-zero status if any fuzz case does not match str_utils_format().
+ */
+
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "fmt.h"
+#include "fmt_shims.h"
+#include "str_utils.h"
+
+
+typedef enum
+{
+	kBenchConfigFuzzIterations  = 100000,
+	kBenchConfigBenchIterations = 1000000,
+	kBenchConfigMaxWidth	    = 40,
+	kBenchConfigBufferSize	    = 256,
+	kBenchConfigMaxFailures	    = 10,
+} BenchConfig;
+
+
+static uint32_t bench_rng_state = 0x12345678;
+static int	bench_failures	= 0;
+static int	bench_cases	= 0;
+
+/*
+ * 	Output of uart_putchar(), which the UART variants of the shims write to.
+ */
+static char	bench_uart[kBenchConfigBufferSize];
+static size_t	bench_uart_len = 0;
+
+static const int64_t bench_edge_i64s[] = {
+	0,
+	1,
+	-1,
+	9,
+	-10,
+	INT_MAX,
+	INT_MIN,
+	(int64_t)UINT32_MAX + 1,
+	INT64_MAX,
+	INT64_MIN,
+};
+
+static const char * const bench_strings[] = {
+	"",
+	"a",
+	"hello",
+	"Signaloid C0-microSD",
+	"a string that is longer than the padding chunk size",
+	nullptr,
+};
+
+
+extern "C" void
+uart_putchar(char c)
+{
+	if (bench_uart_len < sizeof(bench_uart))
+	{
+		bench_uart[bench_uart_len++] = c;
+	}
+}
+
+static uint32_t
+bench_rand(void)
+{
+	/*
+	 * 	xorshift32
+	 */
+	bench_rng_state ^= bench_rng_state << 13;
+	bench_rng_state ^= bench_rng_state >> 17;
+	bench_rng_state ^= bench_rng_state << 5;
+	return bench_rng_state;
+}
+
+static int64_t
+bench_rand_i64(void)
+{
+	uint64_t value = ((uint64_t)bench_rand() << 32) | bench_rand();
+
+	switch (bench_rand() % 4)
+	{
+		case 0:
+			return bench_edge_i64s[bench_rand() % (sizeof(bench_edge_i64s) / sizeof(bench_edge_i64s[0]))];
+		case 1:
+			/*
+			 * 	Cover every digit count
+			 */
+			return (int64_t)value >> (bench_rand() % 64);
+		default:
+			return (int64_t)value;
+	}
+}
+
+static const char *
+bench_rand_string(void)
+{
+	return bench_strings[bench_rand() % (sizeof(bench_strings) / sizeof(bench_strings[0]))];
+}
+
+/**
+ * 	@brief Returns a width, sometimes negative, which is the same as no padding.
+ */
+static int
+bench_rand_width(void)
+{
+	return (int)(bench_rand() % (kBenchConfigMaxWidth + 5)) - 4;
+}
+
+/**
+ * 	@brief Picks the destination size: usually large enough, sometimes truncating.
+ */
+static size_t
+bench_rand_size(void)
+{
+	if (bench_rand() % 2 == 0)
+	{
+		return kBenchConfigBufferSize;
+	}
+
+	return bench_rand() % 64;
+}
+
+static void
+bench_compare(const char *  format, size_t size, int exp_len, const char *  expected, int got_len, const char *  actual)
+{
+	int match = (exp_len == got_len);
+
+	if (match && size != 0)
+	{
+		size_t n = (size_t)exp_len < size - 1 ? (size_t)exp_len : size - 1;
+		match	 = memcmp(expected, actual, n + 1) == 0;
+	}
+
+	bench_cases++;
+
+	if (!match)
+	{
+		if (bench_failures < kBenchConfigMaxFailures)
+		{
+			printf("MISMATCH: fmt=\"%s\" size=%zu\n", format, size);
+			printf("    str_utils_format: %d \"%s\"\n", exp_len, expected);
+			printf("    fmt:              %d \"%s\"\n", got_len, actual);
+		}
+		bench_failures++;
+	}
+}
+
+/**
+ * 	@brief Formats args with fmt::format() and with str_utils_format(), and compares the results.
+ */
+template <fmt::Literal string, typename... Args>
+static void
+bench_check(const Args &... args)
+{
+	char	expected[kBenchConfigBufferSize];
+	char	actual[kBenchConfigBufferSize];
+	size_t	size = bench_rand_size();
+
+	memset(expected, 0x55, sizeof(expected));
+	memset(actual, 0x55, sizeof(actual));
+
+	int exp_len = str_utils_format(expected, size, string.chars, args...);
+	int got_len = fmt::format<string>(actual, size, args...);
+	bench_compare(string.chars, size, exp_len, expected, got_len, actual);
+}
+
+static void
+bench_fuzz(void)
+{
+	int64_t		v  = bench_rand_i64();
+	int32_t		d  = (int32_t)v;
+	uint32_t	u  = (uint32_t)v;
+	int		w0 = bench_rand_width();
+	int		w1 = bench_rand_width();
+	char		c  = (char)(' ' + bench_rand() % ('~' - ' '));
+	const char *	s  = bench_rand_string();
+
+	bench_check<"no conversions">();
+	bench_check<"%d">(d);
+	bench_check<"[%u|%x]">(u, u);
+	bench_check<"%*d|%*u|%*x">(w0, d, w1, u, w0, u);
+	bench_check<"%ld %lu %lx">((long)v, (unsigned long)v, (unsigned long)v);
+	bench_check<"%lld %llu %*llx">((long long)v, (unsigned long long)v, w0, (unsigned long long)v);
+	bench_check<"%*lld|">(w1, (long long)v);
+	bench_check<"small %d %u %x">((int16_t)v, (uint8_t)v, (uint16_t)v);
+	bench_check<"%c%*c">(c, w0, c);
+	bench_check<"%s|%*s|">(s, w1, s);
+	bench_check<"100%% %*% %%%d%%">(w0, d);
+	bench_check<"%s = %*s">("array", w0, "literal");
+}
+
+static void
+bench_fuzz_shims(void)
+{
+	int32_t		d = (int32_t)bench_rand_i64();
+	uint32_t	u = bench_rand();
+	uint32_t	a = bench_rand();
+	char		expected[kBenchConfigBufferSize];
+	char		actual[kBenchConfigBufferSize];
+	size_t		size = bench_rand_size();
+
+	memset(expected, 0x55, sizeof(expected));
+	memset(actual, 0x55, sizeof(actual));
+
+	int exp_len = str_utils_format(expected, size, "val=%d hex=%x\n", d, u);
+	int got_len = fmt_bench_value_format(actual, size, d, u);
+	bench_compare("val=%d hex=%x\\n", size, exp_len, expected, got_len, actual);
+
+	bench_uart_len = 0;
+	exp_len	       = str_utils_format(expected, sizeof(expected), "trace: %x %x %x\n", a, u, (uint32_t)d);
+	got_len	       = fmt_trace_event(a, u, (uint32_t)d);
+	bench_uart[bench_uart_len < sizeof(bench_uart) ? bench_uart_len : sizeof(bench_uart) - 1] = '\0';
+	bench_compare("trace: %x %x %x\\n", sizeof(expected), exp_len, expected, got_len, bench_uart);
+}
+
+static uint64_t
+bench_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+bench_report(const char *  name, const char *  impl, uint64_t ns)
+{
+	printf("  %-10s %-18s %8.2f ns/call\n", name, impl, (double)ns / (double)kBenchConfigBenchIterations);
+}
+
+/*
+ * 	Times kBenchConfigBenchIterations calls of both fmt::format and str_utils_format with the same arguments.
+ * 	The format string of str_utils_format is read through a volatile pointer, and the arguments are read from
+ * 	volatile variables by the caller, so that neither call can be folded.
+ */
+#define BENCH_CASE(name, string, ...)                                                                   \
+	do                                                                                              \
+	{                                                                                               \
+		const char * volatile bench_fmt = string;                                               \
+		char	 buf[kBenchConfigBufferSize];                                                   \
+		uint64_t chars = 0;                                                                     \
+		uint64_t start = bench_now_ns();                                                        \
+		for (int i = 0; i < kBenchConfigBenchIterations; i++)                                   \
+		{                                                                                       \
+			chars += fmt::format<string>(buf, sizeof(buf), ##__VA_ARGS__);                  \
+		}                                                                                       \
+		bench_report(name, "fmt::format", bench_now_ns() - start);                              \
+		start = bench_now_ns();                                                                 \
+		for (int i = 0; i < kBenchConfigBenchIterations; i++)                                   \
+		{                                                                                       \
+			chars -= str_utils_format(buf, sizeof(buf), bench_fmt, ##__VA_ARGS__);          \
+		}                                                                                       \
+		bench_report(name, "str_utils_format", bench_now_ns() - start);                         \
+		if (chars != 0)                                                                         \
+		{                                                                                       \
+			printf("MISMATCH: fmt=\"%s\" length\n", string);                                \
+			bench_failures++;                                                               \
+		}                                                                                       \
+	}                                                                                               \
+	while (0)
+
+int
+main(void)
+{
+	for (int i = 0; i < kBenchConfigFuzzIterations; i++)
+	{
+		bench_fuzz();
+		bench_fuzz_shims();
+	}
+
+	printf("fuzz: %d cases, %d mismatches\n", bench_cases, bench_failures);
+
+	volatile int		 d0 = 7, d1 = -12345, d2 = 2000000000;
+	volatile unsigned	 u0 = 42, u1 = 0xdeadbeef;
+	volatile unsigned long long ll = 0x123456789abcdefULL;
+	const char * volatile	 s0 = "uart";
+	const char * volatile	 s1 = "Signaloid C0-microSD";
+
+	printf("benchmark: %d iterations per case\n", kBenchConfigBenchIterations);
+	BENCH_CASE("literal", "LED: Red\n");
+	BENCH_CASE("decimal", "%d %d %d\n", (int)d0, (int)d1, (int)d2);
+	BENCH_CASE("unsigned", "%u %u\n", (unsigned)u0, (unsigned)u1);
+	BENCH_CASE("hex", "0x%x 0x%x\n", (unsigned)u0, (unsigned)u1);
+	BENCH_CASE("64-bit", "%llu 0x%llx\n", (unsigned long long)ll, (unsigned long long)ll);
+	BENCH_CASE("string", "%s: %s\n", (const char *)s0, (const char *)s1);
+	BENCH_CASE("padded", "%*s|%*d|%*x\n", 12, (const char *)s0, 8, (int)d0, 8, (unsigned)u1);
+
+	return bench_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
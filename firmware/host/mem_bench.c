@@ -0,0 +1,417 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+/*
+ * 	Host test and benchmark for the word-oriented mem functions (src/mem.c).
+ *
+ * 	1. Correctness: runs memcpy, memmove, memset, memcmp and strlen for every
+ * 	   source and destination alignment, and every length up to a few words
+ * 	   past the unrolled loops, on random data, and checks the results against
+ * 	   byte-by-byte references, including that no byte outside the destination
+ * 	   was written. memmove is checked on every overlap, in both directions,
+ * 	   memcmp on a difference at every position, with bytes above 0x7f, and
+ * 	   strlen on strings holding, and followed by, bytes around which a
+ * 	   zero-byte test can go wrong.
+ * 	2. Benchmark: reports ns per call and bytes per ns of each function, for a
+ * 	   few sizes, next to the host C library's.
+ *
+ * 	src/mem.c is built with CONFIG_MEM_HOST, which names its functions
+ * 	mem_memcpy() etc., so that they do not replace the C library's.
+ *
+ * 	Exits with a non-zero status if any check fails.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+void *	mem_memcpy(void * restrict dst, const void * restrict src, size_t n);
+void *	mem_memmove(void *  dst, const void *  src, size_t n);
+void *	mem_memset(void *  dst, int c, size_t n);
+int	mem_memcmp(const void *  a, const void *  b, size_t n);
+size_t	mem_strlen(const char *  s);
+
+
+typedef enum
+{
+	kBenchConfigMaxLength	= 80,
+	kBenchConfigGuard	= 16,
+	kBenchConfigBufferSize	= 2 * kBenchConfigGuard + 8 + kBenchConfigMaxLength,
+	kBenchConfigBenchBytes	= 1 << 26,
+	kBenchConfigMaxFailures	= 10,
+} BenchConfig;
+
+
+static uint32_t bench_rng_state = 0x12345678;
+static int	bench_failures	= 0;
+
+static uint8_t	bench_src[kBenchConfigBufferSize];
+static uint8_t	bench_dst[kBenchConfigBufferSize];
+static uint8_t	bench_expected[kBenchConfigBufferSize];
+
+
+static uint32_t
+bench_rand(void)
+{
+	/*
+	 * 	xorshift32
+	 */
+	bench_rng_state ^= bench_rng_state << 13;
+	bench_rng_state ^= bench_rng_state >> 17;
+	bench_rng_state ^= bench_rng_state << 5;
+	return bench_rng_state;
+}
+
+static void
+bench_fill(uint8_t *  buffer, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		buffer[i] = bench_rand();
+	}
+}
+
+static void
+bench_fail(const char *  name, size_t dst_offset, size_t src_offset, size_t n)
+{
+	if (bench_failures++ < kBenchConfigMaxFailures)
+	{
+		printf("  FAIL %s: dst offset %zu, src offset %zu, length %zu\n", name, dst_offset, src_offset, n);
+	}
+}
+
+/*
+ * 	Compares the whole destination buffer, guard bytes included, with the expected one.
+ */
+static void
+bench_check_buffer(const char *  name, const uint8_t *  buffer, size_t dst_offset, size_t src_offset, size_t n)
+{
+	for (size_t i = 0; i < kBenchConfigBufferSize; i++)
+	{
+		if (buffer[i] != bench_expected[i])
+		{
+			bench_fail(name, dst_offset, src_offset, n);
+			return;
+		}
+	}
+}
+
+static void
+bench_test_memcpy_memset(void)
+{
+	for (size_t dst_offset = 0; dst_offset < 8; dst_offset++)
+	{
+		for (size_t src_offset = 0; src_offset < 8; src_offset++)
+		{
+			for (size_t n = 0; n <= kBenchConfigMaxLength; n++)
+			{
+				uint8_t *  dst = bench_dst + kBenchConfigGuard + dst_offset;
+				uint8_t *  src = bench_src + kBenchConfigGuard + src_offset;
+
+				bench_fill(bench_src, kBenchConfigBufferSize);
+				bench_fill(bench_dst, kBenchConfigBufferSize);
+				memcpy(bench_expected, bench_dst, kBenchConfigBufferSize);
+				for (size_t i = 0; i < n; i++)
+				{
+					bench_expected[kBenchConfigGuard + dst_offset + i] = src[i];
+				}
+
+				if (mem_memcpy(dst, src, n) != dst)
+				{
+					bench_fail("memcpy return value", dst_offset, src_offset, n);
+				}
+				bench_check_buffer("memcpy", bench_dst, dst_offset, src_offset, n);
+
+				/*
+				 * 	Non-overlapping memmove is a memcpy.
+				 */
+				memcpy(bench_dst, bench_expected, kBenchConfigBufferSize);
+				bench_fill(dst, n);
+				mem_memmove(dst, src, n);
+				bench_check_buffer("memmove, disjoint", bench_dst, dst_offset, src_offset, n);
+			}
+		}
+
+		for (size_t n = 0; n <= kBenchConfigMaxLength; n++)
+		{
+			uint8_t *  dst = bench_dst + kBenchConfigGuard + dst_offset;
+			int	   c   = (int)(bench_rand() | 0x80) - (n & 1 ? 256 : 0);
+
+			bench_fill(bench_dst, kBenchConfigBufferSize);
+			memcpy(bench_expected, bench_dst, kBenchConfigBufferSize);
+			for (size_t i = 0; i < n; i++)
+			{
+				bench_expected[kBenchConfigGuard + dst_offset + i] = (uint8_t)c;
+			}
+
+			if (mem_memset(dst, c, n) != dst)
+			{
+				bench_fail("memset return value", dst_offset, 0, n);
+			}
+			bench_check_buffer("memset", bench_dst, dst_offset, 0, n);
+		}
+	}
+}
+
+/*
+ * 	Every overlap of source and destination in one buffer, in both directions.
+ */
+static void
+bench_test_memmove_overlap(void)
+{
+	for (size_t dst_offset = 0; dst_offset < kBenchConfigBufferSize - 2 * kBenchConfigGuard; dst_offset++)
+	{
+		for (size_t src_offset = 0; src_offset < kBenchConfigBufferSize - 2 * kBenchConfigGuard; src_offset++)
+		{
+			size_t	   end = dst_offset > src_offset ? dst_offset : src_offset;
+			size_t	   n   = kBenchConfigBufferSize - 2 * kBenchConfigGuard - end;
+			uint8_t *  dst = bench_dst + kBenchConfigGuard + dst_offset;
+			uint8_t *  src = bench_dst + kBenchConfigGuard + src_offset;
+
+			bench_fill(bench_dst, kBenchConfigBufferSize);
+			memcpy(bench_expected, bench_dst, kBenchConfigBufferSize);
+			memcpy(bench_src, src, n);
+			for (size_t i = 0; i < n; i++)
+			{
+				bench_expected[kBenchConfigGuard + dst_offset + i] = bench_src[i];
+			}
+
+			if (mem_memmove(dst, src, n) != dst)
+			{
+				bench_fail("memmove return value", dst_offset, src_offset, n);
+			}
+			bench_check_buffer("memmove, overlapping", bench_dst, dst_offset, src_offset, n);
+		}
+	}
+}
+
+static int
+bench_sign(int value)
+{
+	return (value > 0) - (value < 0);
+}
+
+static void
+bench_test_memcmp(void)
+{
+	for (size_t a_offset = 0; a_offset < 8; a_offset++)
+	{
+		for (size_t b_offset = 0; b_offset < 8; b_offset++)
+		{
+			for (size_t n = 0; n <= kBenchConfigMaxLength; n++)
+			{
+				uint8_t *  a = bench_src + kBenchConfigGuard + a_offset;
+				uint8_t *  b = bench_dst + kBenchConfigGuard + b_offset;
+
+				bench_fill(a, n);
+				memcpy(b, a, n);
+
+				if (mem_memcmp(a, b, n) != 0)
+				{
+					bench_fail("memcmp, equal", a_offset, b_offset, n);
+				}
+
+				/*
+				 * 	A difference at every position, with later bytes differing the other way,
+				 * 	so that only the first difference gives the right sign.
+				 */
+				for (size_t position = 0; position < n; position++)
+				{
+					uint8_t saved = b[position];
+
+					b[position] = a[position] ^ (0x80 | (bench_rand() & 0x7f));
+					if (position + 1 < n)
+					{
+						b[n - 1] = ~a[n - 1];
+					}
+
+					if (bench_sign(mem_memcmp(a, b, n)) != bench_sign(memcmp(a, b, n)))
+					{
+						bench_fail("memcmp, different", a_offset, b_offset, n);
+					}
+
+					b[position] = saved;
+					b[n - 1]    = a[n - 1];
+				}
+			}
+		}
+	}
+}
+
+static void
+bench_test_strlen(void)
+{
+	/*
+	 * 	Bytes above 0x7f, and 0x01 bytes next to zero bytes, around which a zero-byte test can go wrong.
+	 */
+	static const uint8_t tricky[] = {0x80, 0x01, 0x81, 0xff, 0x7f, 0x00, 0x01, 0x80};
+
+	for (size_t offset = 0; offset < 8; offset++)
+	{
+		for (size_t n = 0; n <= kBenchConfigMaxLength; n++)
+		{
+			char *	s = (char *)bench_src + kBenchConfigGuard + offset;
+
+			for (size_t i = 0; i < n; i++)
+			{
+				s[i] = 1 + bench_rand() % 255;
+				if (bench_rand() % 4 == 0)
+				{
+					s[i] = tricky[bench_rand() % 5];
+				}
+			}
+			s[n] = '\0';
+			for (size_t i = n + 1; i < kBenchConfigMaxLength + 8; i++)
+			{
+				s[i] = tricky[i % sizeof(tricky)];
+			}
+
+			if (mem_strlen(s) != n)
+			{
+				bench_fail("strlen", 0, offset, n);
+			}
+		}
+	}
+}
+
+static uint64_t
+bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static volatile size_t bench_sink;
+
+typedef enum
+{
+	kBenchFunctionMemcpy,
+	kBenchFunctionMemcpyMisaligned,
+	kBenchFunctionMemmove,
+	kBenchFunctionMemset,
+	kBenchFunctionMemcmp,
+	kBenchFunctionStrlen,
+	kBenchFunctionCount,
+} BenchFunction;
+
+static const char * const bench_function_names[kBenchFunctionCount] = {
+	"memcpy",
+	"memcpy, misaligned",
+	"memmove, backwards",
+	"memset",
+	"memcmp",
+	"strlen",
+};
+
+static double
+bench_run(BenchFunction function, int libc, uint8_t *  a, uint8_t *  b, size_t n)
+{
+	size_t	 iterations = kBenchConfigBenchBytes / n;
+	uint64_t start	    = bench_now_ns();
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		switch (function)
+		{
+			case kBenchFunctionMemcpy:
+				libc ? memcpy(a, b, n) : mem_memcpy(a, b, n);
+				break;
+			case kBenchFunctionMemcpyMisaligned:
+				libc ? memcpy(a, b + 1, n) : mem_memcpy(a, b + 1, n);
+				break;
+			case kBenchFunctionMemmove:
+				libc ? memmove(a + 4, a, n) : mem_memmove(a + 4, a, n);
+				break;
+			case kBenchFunctionMemset:
+				libc ? memset(a, (int)i, n) : mem_memset(a, (int)i, n);
+				break;
+			case kBenchFunctionMemcmp:
+				bench_sink = libc ? memcmp(a, b, n) : mem_memcmp(a, b, n);
+				break;
+			default:
+				bench_sink = libc ? strlen((char *)b) : mem_strlen((char *)b);
+				break;
+		}
+		__asm__ volatile("" : : "r"(a), "r"(b) : "memory");
+	}
+
+	return (double)(bench_now_ns() - start) / iterations;
+}
+
+static void
+bench_speed(void)
+{
+	static const size_t sizes[] = {8, 64, 512, 4096};
+	uint8_t *	    a	    = malloc(4096 + 16);
+	uint8_t *	    b	    = malloc(4096 + 16);
+
+	printf("\n  %-20s %6s %12s %12s %10s\n", "function", "bytes", "mem ns/call", "libc ns/call", "mem B/ns");
+
+	for (BenchFunction function = 0; function < kBenchFunctionCount; function++)
+	{
+		for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		{
+			size_t n = sizes[i];
+
+			memset(a, 0x5a, 4096 + 16);
+			memset(b, 0x5a, 4096 + 16);
+			b[n] = '\0';
+
+			double mem_ns  = bench_run(function, 0, a, b, n);
+			double libc_ns = bench_run(function, 1, a, b, n);
+
+			printf("  %-20s %6zu %12.2f %12.2f %10.2f\n", bench_function_names[function], n, mem_ns, libc_ns, n / mem_ns);
+		}
+	}
+
+	free(a);
+	free(b);
+}
+
+int
+main(void)
+{
+	printf("mem_bench: correctness\n");
+
+	bench_test_memcpy_memset();
+	bench_test_memmove_overlap();
+	bench_test_memcmp();
+	bench_test_strlen();
+
+	if (bench_failures != 0)
+	{
+		printf("mem_bench: %d checks FAILED\n", bench_failures);
+		return 1;
+	}
+
+	printf("  memcpy, memmove, memset, memcmp, strlen: all alignments and lengths up to %d bytes OK\n", (int)kBenchConfigMaxLength);
+
+	bench_speed();
+
+	return 0;
+}
@@ -0,0 +1,336 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+/*
+ * 	Host loopback test for the framed binary UART protocol.
+ *
+ * 	1. Checks cobs_encode()/cobs_decode() round trips on random buffers, rich in
+ * 	   zeros and in 254-byte runs, and crc16_update() against its check value.
+ * 	2. Runs proto.c, the device side of the protocol, on the master side of a
+ * 	   PTY, in place of the board's UART, and runs the command given as
+ * 	   arguments, e.g. tools/c0link.py, with "--port <PTY> test" appended. The
+ * 	   UART shim corrupts and drops bytes in both directions, so that the host's
+ * 	   retransmissions and the device's response cache are exercised.
+ *
+ * 	Without arguments, serves the protocol on the PTY until interrupted, for
+ * 	manual testing with tools/c0link.py.
+ *
+ * 	Exits with a non-zero status if a check or the command fails.
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#include "cobs.h"
+#include "crc16.h"
+#include "proto.h"
+#include "uart.h"
+
+
+typedef enum
+{
+	kBenchConfigCobsIterations	= 100000,
+	kBenchConfigCobsMaxLength	= 1024,
+
+	/*
+	 * 	One byte in kBenchConfigErrorPeriod is corrupted, and one in kBenchConfigErrorPeriod is dropped.
+	 */
+	kBenchConfigErrorPeriod		= 4096,
+	kBenchConfigPollMs		= 10,
+	kBenchConfigTxBufferSize	= 4096,
+	kBenchConfigMaxFailures		= 10,
+} BenchConfig;
+
+
+static int	bench_pty	= -1;
+static uint8_t	bench_tx[kBenchConfigTxBufferSize];
+static uint32_t bench_tx_len	  = 0;
+static uint32_t bench_rng_state	  = 0x12345678;
+static uint32_t bench_corrupted	  = 0;
+static uint32_t bench_dropped	  = 0;
+static int	bench_failures	  = 0;
+
+
+static uint32_t
+bench_rand(void)
+{
+	bench_rng_state ^= bench_rng_state << 13;
+	bench_rng_state ^= bench_rng_state >> 17;
+	bench_rng_state ^= bench_rng_state << 5;
+
+	return bench_rng_state;
+}
+
+static void
+bench_fail(const char *  what, uint32_t iteration)
+{
+	if (bench_failures++ < kBenchConfigMaxFailures)
+	{
+		printf("FAIL: %s, iteration %u\n", what, iteration);
+	}
+}
+
+/*
+ * 	Applies the line errors to len bytes in place, and returns the new length.
+ */
+static uint32_t
+bench_line_errors(uint8_t *  data, uint32_t len)
+{
+	uint32_t out = 0;
+
+	for (uint32_t i = 0; i < len; i++)
+	{
+		uint32_t r = bench_rand() % kBenchConfigErrorPeriod;
+
+		if (r == 0)
+		{
+			bench_dropped++;
+			continue;
+		}
+
+		if (r == 1)
+		{
+			data[i] ^= 1U << (bench_rand() % 8);
+			bench_corrupted++;
+		}
+
+		data[out++] = data[i];
+	}
+
+	return out;
+}
+
+/*
+ * 	UART driver shim, on the PTY. proto.c only uses uart_read() and uart_putchar().
+ */
+uint32_t
+uart_read(char *  buf, uint32_t len)
+{
+	ssize_t n = read(bench_pty, buf, len);
+
+	if (n <= 0)
+	{
+		return 0;
+	}
+
+	return bench_line_errors((uint8_t *)buf, (uint32_t)n);
+}
+
+void
+uart_putchar(char c)
+{
+	if (bench_tx_len == sizeof(bench_tx))
+	{
+		return;
+	}
+
+	bench_tx[bench_tx_len++] = (uint8_t)c;
+}
+
+static void
+bench_flush_tx(void)
+{
+	uint32_t len = bench_line_errors(bench_tx, bench_tx_len);
+
+	for (uint32_t off = 0; off < len;)
+	{
+		ssize_t n = write(bench_pty, &bench_tx[off], len - off);
+
+		if (n > 0)
+		{
+			off += (uint32_t)n;
+		}
+		else
+		{
+			poll(&(struct pollfd){.fd = bench_pty, .events = POLLOUT}, 1, kBenchConfigPollMs);
+		}
+	}
+
+	bench_tx_len = 0;
+}
+
+static void
+bench_check_cobs(void)
+{
+	static uint8_t src[kBenchConfigCobsMaxLength];
+	static uint8_t encoded[COBS_ENCODED_MAX(kBenchConfigCobsMaxLength)];
+	static uint8_t decoded[kBenchConfigCobsMaxLength];
+
+	for (uint32_t iteration = 0; iteration < kBenchConfigCobsIterations; iteration++)
+	{
+		/*
+		 * 	Mostly short buffers, and lengths around multiples of 254.
+		 */
+		uint32_t len	 = (iteration % 2) ? bench_rand() % 8 : bench_rand() % kBenchConfigCobsMaxLength;
+		uint32_t density = bench_rand() % 4;
+
+		if (iteration % 3 == 0)
+		{
+			len = (254 * (1 + bench_rand() % 3) + bench_rand() % 3 - 1) % kBenchConfigCobsMaxLength;
+		}
+
+		for (uint32_t i = 0; i < len; i++)
+		{
+			src[i] = (density == 0 || bench_rand() % (density * 64) != 0) ? 1 + bench_rand() % 255 : 0;
+		}
+
+		uint32_t encoded_len = cobs_encode(encoded, src, len);
+
+		if (encoded_len > COBS_ENCODED_MAX(len) || memchr(encoded, 0, encoded_len) != NULL)
+		{
+			bench_fail("cobs_encode() length or zero byte", iteration);
+			continue;
+		}
+
+		int32_t decoded_len = cobs_decode(decoded, sizeof(decoded), encoded, encoded_len);
+
+		if (decoded_len != (int32_t)len || memcmp(decoded, src, len) != 0)
+		{
+			bench_fail("cobs_decode() round trip", iteration);
+		}
+
+		if (len > 0 && cobs_decode(decoded, len - 1, encoded, encoded_len) != -1)
+		{
+			bench_fail("cobs_decode() overflow", iteration);
+		}
+	}
+
+	if (crc16_update(kCRC16_CONF_INIT, (const uint8_t *)"123456789", 9) != 0x29b1)
+	{
+		bench_fail("crc16_update() check value", 0);
+	}
+
+	printf("cobs/crc16: %u round trips, %d failures\n", (uint32_t)kBenchConfigCobsIterations, bench_failures);
+}
+
+static const char *
+bench_open_pty(void)
+{
+	bench_pty = posix_openpt(O_RDWR | O_NOCTTY);
+
+	if ((bench_pty < 0) || (grantpt(bench_pty) != 0) || (unlockpt(bench_pty) != 0))
+	{
+		perror("proto_loopback: posix_openpt");
+		exit(EXIT_FAILURE);
+	}
+
+	const char *  path = ptsname(bench_pty);
+
+	/*
+	 * 	Keep the slave open, so that reads do not fail before the host opens it,
+	 * 	and make it raw, so that the line discipline does not alter the bytes.
+	 */
+	int		slave = open(path, O_RDWR | O_NOCTTY);
+	struct termios	attributes;
+
+	if ((slave < 0) || (tcgetattr(slave, &attributes) != 0))
+	{
+		perror("proto_loopback: open");
+		exit(EXIT_FAILURE);
+	}
+
+	cfmakeraw(&attributes);
+	tcsetattr(slave, TCSANOW, &attributes);
+	fcntl(bench_pty, F_SETFL, O_NONBLOCK);
+
+	return path;
+}
+
+int
+main(int argc, char *  argv[])
+{
+	bench_check_cobs();
+
+	const char *  path = bench_open_pty();
+	pid_t	      pid  = -1;
+
+	proto_init(NULL, 0);
+
+	if (argc > 1)
+	{
+		char *	host_argv[argc + 3];
+
+		for (int i = 1; i < argc; i++)
+		{
+			host_argv[i - 1] = argv[i];
+		}
+
+		host_argv[argc - 1] = "--port";
+		host_argv[argc]	    = (char *)path;
+		host_argv[argc + 1] = "test";
+		host_argv[argc + 2] = NULL;
+
+		fflush(stdout);
+		pid = fork();
+
+		if (pid == 0)
+		{
+			execvp(host_argv[0], host_argv);
+			perror("proto_loopback: execvp");
+			_exit(EXIT_FAILURE);
+		}
+	}
+	else
+	{
+		printf("proto_loopback: serving on %s\n", path);
+		fflush(stdout);
+	}
+
+	int status = 0;
+
+	while ((pid < 0) || (waitpid(pid, &status, WNOHANG) == 0))
+	{
+		poll(&(struct pollfd){.fd = bench_pty, .events = POLLIN}, 1, kBenchConfigPollMs);
+		proto_poll();
+		bench_flush_tx();
+	}
+
+	ProtoStats stats;
+
+	proto_get_stats(&stats);
+	printf(
+		"proto: %u frames received, %u sent, %u CRC errors, %u framing errors, %u duplicates, %u out of order\n",
+		stats.frames_rx,
+		stats.frames_tx,
+		stats.crc_errors,
+		stats.framing_errors,
+		stats.duplicates,
+		stats.out_of_order);
+	printf("line: %u bytes corrupted, %u dropped\n", bench_corrupted, bench_dropped);
+
+	if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+	{
+		bench_fail("host command", 0);
+	}
+
+	return bench_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
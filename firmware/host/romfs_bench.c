@@ -0,0 +1,477 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Host test and benchmark for the read-only file image (src/romfs.c).
+ *
+ * 	1. Correctness: writes directories of random files, with nested names and
+ * 	   names that differ in one character, packs each with the command given
+ * 	   as arguments, e.g. tools/mkromfs.py, with "pack <directory> --align 16
+ * 	   -o <image>" appended, and checks that romfs_mount() accepts the image,
+ * 	   that romfs_open() finds every file with its data, aligned, and with a
+ * 	   matching CRC, that it does not find names which are not in the image,
+ * 	   and that romfs_file_at() lists every file once. Then checks that a
+ * 	   corrupt directory, and sizes out of bounds, are rejected by
+ * 	   romfs_mount(), and corrupt data by romfs_verify().
+ * 	2. Benchmark: reports ns per romfs_open() call, for a growing number of
+ * 	   files, next to a linear search of the names.
+ *
+ * 	Exits with a non-zero status if any check fails.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "romfs.h"
+
+
+typedef enum
+{
+	kBenchConfigAlign	= 16,
+	kBenchConfigMaxSize	= 300,
+	kBenchConfigNameMax	= 64,
+	kBenchConfigLookups	= 1 << 20,
+	kBenchConfigMaxFailures	= 10,
+} BenchConfig;
+
+
+static uint32_t bench_rng_state = 0x12345678;
+static int	bench_failures	= 0;
+static char **	bench_command;
+static char	bench_directory[] = "/tmp/romfs_bench.XXXXXX";
+
+
+static uint32_t
+bench_rand(void)
+{
+	/*
+	 * 	xorshift32
+	 */
+	bench_rng_state ^= bench_rng_state << 13;
+	bench_rng_state ^= bench_rng_state >> 17;
+	bench_rng_state ^= bench_rng_state << 5;
+	return bench_rng_state;
+}
+
+static void
+bench_fail(const char *  check, const char *  name)
+{
+	if (bench_failures++ < kBenchConfigMaxFailures)
+	{
+		printf("  FAIL %s: %s\n", check, name);
+	}
+}
+
+static uint64_t
+bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * 	Name and contents of file i, the same for every run with the same seed. Every fourth name is in a
+ * 	subdirectory, and names differ from their neighbours in one character, so that lookups must compare them.
+ */
+static void
+bench_file(uint32_t i, char *  name, uint8_t *  data, uint32_t *  size)
+{
+	snprintf(name, kBenchConfigNameMax, "%sfile%05u.bin", (i % 4 == 0) ? "sub/dir/" : "", i);
+
+	bench_rng_state = 0x9e3779b9 ^ (i * 0x85ebca6b);
+	*size		= bench_rand() % kBenchConfigMaxSize;
+	for (uint32_t j = 0; j < *size; j++)
+	{
+		data[j] = bench_rand();
+	}
+}
+
+static void
+bench_run_command(char *  image_path, const char *  files_path)
+{
+	int	command_length = 0;
+
+	while (bench_command[command_length] != NULL)
+	{
+		command_length++;
+	}
+
+	char *	argv[command_length + 7];
+
+	for (int i = 0; i < command_length; i++)
+	{
+		argv[i] = bench_command[i];
+	}
+
+	argv[command_length]	 = "pack";
+	argv[command_length + 1] = (char *)files_path;
+	argv[command_length + 2] = "--align";
+	argv[command_length + 3] = "16";
+	argv[command_length + 4] = "-o";
+	argv[command_length + 5] = image_path;
+	argv[command_length + 6] = NULL;
+
+	fflush(stdout);
+
+	pid_t	pid = fork();
+
+	if (pid == 0)
+	{
+		execvp(argv[0], argv);
+		perror("romfs_bench: execvp");
+		_exit(EXIT_FAILURE);
+	}
+
+	int	status = 0;
+
+	waitpid(pid, &status, 0);
+	if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+	{
+		printf("romfs_bench: packing failed\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * 	Writes count files, packs them, and returns the image, in a buffer aligned like the flash.
+ */
+static uint8_t *
+bench_pack(uint32_t count, size_t *  image_size)
+{
+	char	files_path[sizeof(bench_directory) + 32];
+	char	image_path[sizeof(bench_directory) + 32];
+	char	command[sizeof(files_path) + kBenchConfigNameMax + 16];
+	char	name[kBenchConfigNameMax];
+	char	path[sizeof(files_path) + kBenchConfigNameMax];
+	uint8_t data[kBenchConfigMaxSize];
+	uint32_t size;
+
+	snprintf(files_path, sizeof(files_path), "%s/files%u", bench_directory, count);
+	snprintf(image_path, sizeof(image_path), "%s/romfs%u.bin", bench_directory, count);
+	snprintf(path, sizeof(path), "%s/sub/dir", files_path);
+	snprintf(command, sizeof(command), "mkdir -p %s", path);
+	if (system(command) != 0)
+	{
+		exit(EXIT_FAILURE);
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		bench_file(i, name, data, &size);
+		snprintf(path, sizeof(path), "%s/%s", files_path, name);
+
+		FILE *	file = fopen(path, "wb");
+
+		if ((file == NULL) || (fwrite(data, 1, size, file) != size) || (fclose(file) != 0))
+		{
+			perror(path);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	bench_run_command(image_path, files_path);
+
+	FILE *	image_file = fopen(image_path, "rb");
+	struct stat st;
+
+	if ((image_file == NULL) || (fstat(fileno(image_file), &st) != 0))
+	{
+		perror(image_path);
+		exit(EXIT_FAILURE);
+	}
+
+	uint8_t *  image = aligned_alloc(4096, ((size_t)st.st_size + 4095) & ~(size_t)4095);
+
+	if (fread(image, 1, st.st_size, image_file) != (size_t)st.st_size)
+	{
+		perror(image_path);
+		exit(EXIT_FAILURE);
+	}
+
+	fclose(image_file);
+	*image_size = st.st_size;
+
+	return image;
+}
+
+static void
+bench_check(uint32_t count)
+{
+	size_t			image_size;
+	uint8_t *		image_data = bench_pack(count, &image_size);
+	const RomfsHeader *	image	   = romfs_mount(image_data, image_size);
+	char			name[kBenchConfigNameMax];
+	uint8_t			data[kBenchConfigMaxSize];
+	uint32_t		size;
+	RomfsFile		file;
+
+	if ((image == NULL) || (image->count != count))
+	{
+		bench_fail("romfs_mount", "packed image");
+		free(image_data);
+		return;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		bench_file(i, name, data, &size);
+
+		if (!romfs_open(image, name, &file))
+		{
+			bench_fail("romfs_open", name);
+			continue;
+		}
+
+		if ((strcmp(file.name, name) != 0) || (file.size != size) || (memcmp(file.data, data, size) != 0))
+		{
+			bench_fail("romfs_open data", name);
+		}
+
+		if ((((const uint8_t *)file.data - image_data) % kBenchConfigAlign) != 0)
+		{
+			bench_fail("alignment", name);
+		}
+
+		if (!romfs_verify(&file))
+		{
+			bench_fail("romfs_verify", name);
+		}
+
+		/*
+		 * 	Names that are not in the image: a changed character, a prefix, and an extension.
+		 */
+		char	missing[kBenchConfigNameMax + 1];
+
+		strcpy(missing, name);
+		missing[strlen(missing) - 5] ^= 0x40;
+		if (romfs_open(image, missing, &file))
+		{
+			bench_fail("romfs_open of a changed name", missing);
+		}
+
+		strcpy(missing, name);
+		missing[strlen(missing) - 1] = '\0';
+		if (romfs_open(image, missing, &file))
+		{
+			bench_fail("romfs_open of a prefix", missing);
+		}
+
+		strcat(strcpy(missing, name), "x");
+		if (romfs_open(image, missing, &file))
+		{
+			bench_fail("romfs_open of an extension", missing);
+		}
+	}
+
+	if (romfs_open(image, "", &file))
+	{
+		bench_fail("romfs_open of an empty name", "");
+	}
+
+	uint32_t	listed = 0;
+
+	for (uint32_t i = 0; romfs_file_at(image, i, &file); i++)
+	{
+		RomfsFile	found;
+
+		if (!romfs_open(image, file.name, &found) || (found.data != file.data))
+		{
+			bench_fail("romfs_file_at", file.name);
+		}
+		listed++;
+	}
+
+	if (listed != count)
+	{
+		bench_fail("romfs_file_at count", "");
+	}
+
+	/*
+	 * 	Sizes which do not fit: an image truncated by max_size, an image smaller than its header, and a
+	 * 	directory which would wrap past the end of the address space, even with an unbounded max_size.
+	 */
+	RomfsHeader *	header = (RomfsHeader *)image_data;
+	RomfsHeader	saved  = *header;
+
+	if (romfs_mount(image_data, image_size - 1) != NULL)
+	{
+		bench_fail("romfs_mount", "image larger than max_size");
+	}
+
+	header->size = sizeof(RomfsHeader) - 1;
+	if (romfs_mount(image_data, UINT32_MAX) != NULL)
+	{
+		bench_fail("romfs_mount", "image smaller than its header");
+	}
+
+	header->size		= UINT32_MAX;
+	header->directory_size	= UINT32_MAX - sizeof(RomfsHeader) / 2;
+	if (romfs_mount(image_data, UINT32_MAX) != NULL)
+	{
+		bench_fail("romfs_mount", "directory size wrapping past the end");
+	}
+
+	*header = saved;
+
+	/*
+	 * 	A corrupt byte in the names fails the directory CRC, and one in the data the file CRC.
+	 */
+	if ((count != 0) && romfs_file_at(image, count - 1, &file))
+	{
+		((uint8_t *)file.name)[0] ^= 1;
+		if (romfs_mount(image_data, image_size) != NULL)
+		{
+			bench_fail("romfs_mount of a corrupt directory", file.name);
+		}
+		((uint8_t *)file.name)[0] ^= 1;
+
+		if (file.size != 0)
+		{
+			((uint8_t *)file.data)[file.size / 2] ^= 0x80;
+			if (romfs_verify(&file))
+			{
+				bench_fail("romfs_verify of corrupt data", file.name);
+			}
+		}
+	}
+
+	if ((romfs_mount(image_data + 4, image_size - 4) != NULL) || (romfs_mount(image_data + 20, image_size - 20) != NULL))
+	{
+		bench_fail("romfs_mount", "address without an image");
+	}
+
+	free(image_data);
+}
+
+static volatile bool bench_sink;
+
+static void
+bench_speed(uint32_t count)
+{
+	size_t			image_size;
+	uint8_t *		image_data = bench_pack(count, &image_size);
+	const RomfsHeader *	image	   = romfs_mount(image_data, image_size);
+	char			names[count][kBenchConfigNameMax];
+	uint32_t		size;
+	uint8_t			data[kBenchConfigMaxSize];
+	RomfsFile		file;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		bench_file(i, names[i], data, &size);
+	}
+
+	uint64_t	start = bench_now_ns();
+
+	for (uint32_t i = 0; i < kBenchConfigLookups; i++)
+	{
+		bench_sink = romfs_open(image, names[i % count], &file);
+	}
+
+	double	romfs_ns = (double)(bench_now_ns() - start) / kBenchConfigLookups;
+	uint32_t lookups = kBenchConfigLookups / count;
+
+	start = bench_now_ns();
+
+	for (uint32_t i = 0; i < lookups; i++)
+	{
+		const char *  name = names[i % count];
+
+		for (uint32_t j = 0; romfs_file_at(image, j, &file); j++)
+		{
+			if (strcmp(file.name, name) == 0)
+			{
+				bench_sink = true;
+				break;
+			}
+		}
+	}
+
+	double	linear_ns = (double)(bench_now_ns() - start) / lookups;
+
+	printf("  %6u %10zu %14.1f %14.1f\n", count, image_size, romfs_ns, linear_ns);
+
+	free(image_data);
+}
+
+int
+main(int argc, char *  argv[])
+{
+	static const uint32_t counts[] = {0, 1, 16, 256, 4096};
+
+	if (argc < 2)
+	{
+		printf("usage: romfs_bench <mkromfs command>\n");
+		return EXIT_FAILURE;
+	}
+
+	bench_command = &argv[1];
+	if (mkdtemp(bench_directory) == NULL)
+	{
+		perror("romfs_bench: mkdtemp");
+		return EXIT_FAILURE;
+	}
+
+	printf("romfs_bench: correctness\n");
+
+	for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+	{
+		bench_check(counts[i]);
+	}
+
+	if (bench_failures == 0)
+	{
+		printf("  romfs_mount, romfs_open, romfs_file_at, romfs_verify: up to %u files OK\n", counts[4]);
+		printf("\n  %6s %10s %14s %14s\n", "files", "bytes", "romfs ns/open", "linear ns/open");
+
+		for (size_t i = 2; i < sizeof(counts) / sizeof(counts[0]); i++)
+		{
+			bench_speed(counts[i]);
+		}
+	}
+	else
+	{
+		printf("romfs_bench: %d checks FAILED\n", bench_failures);
+	}
+
+	char	command[sizeof(bench_directory) + 16];
+
+	snprintf(command, sizeof(command), "rm -rf %s", bench_directory);
+	if (system(command) != 0)
+	{
+		bench_failures++;
+	}
+
+	return bench_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
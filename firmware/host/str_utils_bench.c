@@ -0,0 +1,411 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+/*
+ * 	Host benchmark and fuzz harness for str_utils.
+ *
+ * 	1. Fuzz: formats random format strings with random arguments, using every supported specifier
+ * 	   and length modifier, with and without padding, into buffers of random size, and compares both the output and the
+ * 	   returned length with libc snprintf.
+ * 	2. Benchmark: reports ns/char and bytes/s of str_utils_format, next to snprintf, for a few
+ * 	   representative format strings.
+ *
+ * 	Exits with a non-zero status if any fuzz case does not match snprintf.
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "str_utils.h"
+
+
+typedef enum
+{
+	kBenchConfigFuzzIterations  = 200000,
+	kBenchConfigBenchIterations = 1000000,
+	kBenchConfigMaxWidth	    = 40,
+	kBenchConfigMaxLiteral	    = 24,
+	kBenchConfigBufferSize	    = 512,
+	kBenchConfigMaxFailures	    = 10,
+} BenchConfig;
+
+
+static uint32_t bench_rng_state = 0x12345678;
+static int	bench_failures	= 0;
+
+static const uint64_t bench_edge_u64s[] = {
+	0,
+	1,
+	99999999,
+	100000000,
+	UINT32_MAX,
+	(uint64_t)UINT32_MAX + 1,
+	9999999999999999ULL,
+	10000000000000000ULL,
+	(uint64_t)INT64_MAX,
+	(uint64_t)INT64_MIN,
+	UINT64_MAX,
+};
+
+static const char * const bench_strings[] = {
+	"",
+	"a",
+	"hello",
+	"Signaloid C0-microSD",
+	"a string that is longer than the padding chunk size",
+};
+
+static const int bench_edge_ints[] = {
+	0,
+	1,
+	-1,
+	9,
+	10,
+	-10,
+	INT_MAX,
+	INT_MIN,
+	INT_MIN + 1,
+	0x7fff,
+	0x10000,
+};
+
+
+static uint32_t
+bench_rand(void)
+{
+	/*
+	 * 	xorshift32
+	 */
+	bench_rng_state ^= bench_rng_state << 13;
+	bench_rng_state ^= bench_rng_state >> 17;
+	bench_rng_state ^= bench_rng_state << 5;
+	return bench_rng_state;
+}
+
+static int
+bench_rand_int(void)
+{
+	switch (bench_rand() % 4)
+	{
+		case 0:
+			return bench_edge_ints[bench_rand() % (sizeof(bench_edge_ints) / sizeof(bench_edge_ints[0]))];
+		case 1:
+			return (int)(bench_rand() % 1000) - 500;
+		default:
+			return (int)bench_rand();
+	}
+}
+
+static uint64_t
+bench_rand_u64(void)
+{
+	uint64_t value = ((uint64_t)bench_rand() << 32) | bench_rand();
+
+	switch (bench_rand() % 4)
+	{
+		case 0:
+			return bench_edge_u64s[bench_rand() % (sizeof(bench_edge_u64s) / sizeof(bench_edge_u64s[0]))];
+		case 1:
+			/*
+			 * 	Cover every digit count
+			 */
+			return value >> (bench_rand() % 64);
+		default:
+			return value;
+	}
+}
+
+static const char *
+bench_rand_string(void)
+{
+	return bench_strings[bench_rand() % (sizeof(bench_strings) / sizeof(bench_strings[0]))];
+}
+
+static int
+bench_rand_width(void)
+{
+	return bench_rand() % (kBenchConfigMaxWidth + 1);
+}
+
+/**
+ * 	@brief Returns one of the int argument specifiers: d, u, x or c.
+ */
+static char
+bench_rand_int_spec(void)
+{
+	static const char specs[] = "duxc";
+	return specs[bench_rand() % (sizeof(specs) - 1)];
+}
+
+/**
+ * 	@brief Returns one of the 64-bit argument specifiers: d, u or x.
+ */
+static char
+bench_rand_u64_spec(void)
+{
+	static const char specs[] = "dux";
+	return specs[bench_rand() % (sizeof(specs) - 1)];
+}
+
+/**
+ * 	@brief Appends random literal text, possibly containing %% escapes, to fmt.
+ */
+static void
+bench_append_literal(char *  fmt)
+{
+	size_t len = strlen(fmt);
+	int    n   = bench_rand() % (kBenchConfigMaxLiteral + 1);
+
+	for (int i = 0; i < n; i++)
+	{
+		if (bench_rand() % 16 == 0)
+		{
+			fmt[len++] = '%';
+			fmt[len++] = '%';
+		}
+		else
+		{
+			fmt[len++] = ' ' + (bench_rand() % ('~' - ' '));
+			if (fmt[len - 1] == '%')
+			{
+				fmt[len - 1] = '#';
+			}
+		}
+	}
+	fmt[len] = '\0';
+}
+
+static void
+bench_append_spec(char *  fmt, int padded, const char *  length, char spec)
+{
+	size_t len = strlen(fmt);
+
+	fmt[len++] = '%';
+	if (padded)
+	{
+		fmt[len++] = '*';
+	}
+	while (*length != '\0')
+	{
+		fmt[len++] = *length++;
+	}
+	fmt[len++] = spec;
+	fmt[len]   = '\0';
+}
+
+/**
+ * 	@brief Picks the destination size: usually large enough, sometimes truncating.
+ */
+static size_t
+bench_rand_size(int full_len)
+{
+	if (bench_rand() % 2 == 0)
+	{
+		return kBenchConfigBufferSize;
+	}
+
+	return bench_rand() % (full_len + 3);
+}
+
+static void
+bench_compare(const char *  fmt, size_t size, int exp_len, const char *  expected, int got_len, const char *  actual)
+{
+	int match = (exp_len == got_len);
+
+	if (match && size != 0)
+	{
+		size_t n = (size_t)exp_len < size - 1 ? (size_t)exp_len : size - 1;
+		match	 = memcmp(expected, actual, n + 1) == 0;
+	}
+
+	if (!match)
+	{
+		if (bench_failures < kBenchConfigMaxFailures)
+		{
+			printf("MISMATCH: fmt=\"%s\" size=%zu\n", fmt, size);
+			printf("    snprintf:         %d \"%s\"\n", exp_len, expected);
+			printf("    str_utils_format: %d \"%s\"\n", got_len, actual);
+		}
+		bench_failures++;
+	}
+}
+
+/**
+ * 	@brief Fuzz case where every conversion is padded: lit %*<int> lit %*s lit %*<int> lit %*<int> lit
+ */
+static void
+bench_fuzz_padded(void)
+{
+	char	    fmt[256] = "";
+	char	    expected[kBenchConfigBufferSize];
+	char	    actual[kBenchConfigBufferSize];
+	int	    w0 = bench_rand_width(), w1 = bench_rand_width(), w2 = bench_rand_width(), w3 = bench_rand_width();
+	int	    i0 = bench_rand_int(), i2 = bench_rand_int(), i3 = bench_rand_int();
+	const char *  s1 = bench_rand_string();
+
+	bench_append_literal(fmt);
+	bench_append_spec(fmt, 1, "", bench_rand_int_spec());
+	bench_append_literal(fmt);
+	bench_append_spec(fmt, 1, "", 's');
+	bench_append_literal(fmt);
+	bench_append_spec(fmt, 1, "", bench_rand_int_spec());
+	bench_append_literal(fmt);
+	bench_append_spec(fmt, 1, "", bench_rand_int_spec());
+	bench_append_literal(fmt);
+
+	int    full = snprintf(expected, sizeof(expected), fmt, w0, i0, w1, s1, w2, i2, w3, i3);
+	size_t size = bench_rand_size(full);
+
+	memset(actual, 0x55, sizeof(actual));
+	int exp_len = snprintf(expected, size, fmt, w0, i0, w1, s1, w2, i2, w3, i3);
+	int got_len = str_utils_format(actual, size, fmt, w0, i0, w1, s1, w2, i2, w3, i3);
+	bench_compare(fmt, size, exp_len, expected, got_len, actual);
+}
+
+/**
+ * 	@brief Fuzz case without padding: lit %<int> lit %s lit %<int> lit
+ */
+static void
+bench_fuzz_plain(void)
+{
+	char	    fmt[256] = "";
+	char	    expected[kBenchConfigBufferSize];
+	char	    actual[kBenchConfigBufferSize];
+	int	    i0 = bench_rand_int(), i2 = bench_rand_int();
+	const char *  s1 = bench_rand_string();
+
+	bench_append_literal(fmt);
+	bench_append_spec(fmt, 0, "", bench_rand_int_spec());
+	bench_append_literal(fmt);
+	bench_append_spec(fmt, 0, "", 's');
+	bench_append_literal(fmt);
+	bench_append_spec(fmt, 0, "", bench_rand_int_spec());
+	bench_append_literal(fmt);
+
+	int    full = snprintf(expected, sizeof(expected), fmt, i0, s1, i2);
+	size_t size = bench_rand_size(full);
+
+	memset(actual, 0x55, sizeof(actual));
+	int exp_len = snprintf(expected, size, fmt, i0, s1, i2);
+	int got_len = str_utils_format(actual, size, fmt, i0, s1, i2);
+	bench_compare(fmt, size, exp_len, expected, got_len, actual);
+}
+
+/**
+ * 	@brief Fuzz case with 64-bit and long arguments: lit %*ll<spec> lit %ll<spec> lit %*l<spec> lit
+ */
+static void
+bench_fuzz_long(void)
+{
+	char		   fmt[256] = "";
+	char		   expected[kBenchConfigBufferSize];
+	char		   actual[kBenchConfigBufferSize];
+	int		   w0 = bench_rand_width(), w2 = bench_rand_width();
+	unsigned long long v0 = bench_rand_u64(), v1 = bench_rand_u64();
+	unsigned long	   v2 = (unsigned long)bench_rand_u64();
+
+	bench_append_literal(fmt);
+	bench_append_spec(fmt, 1, "ll", bench_rand_u64_spec());
+	bench_append_literal(fmt);
+	bench_append_spec(fmt, 0, "ll", bench_rand_u64_spec());
+	bench_append_literal(fmt);
+	bench_append_spec(fmt, 1, "l", bench_rand_u64_spec());
+	bench_append_literal(fmt);
+
+	int    full = snprintf(expected, sizeof(expected), fmt, w0, v0, v1, w2, v2);
+	size_t size = bench_rand_size(full);
+
+	memset(actual, 0x55, sizeof(actual));
+	int exp_len = snprintf(expected, size, fmt, w0, v0, v1, w2, v2);
+	int got_len = str_utils_format(actual, size, fmt, w0, v0, v1, w2, v2);
+	bench_compare(fmt, size, exp_len, expected, got_len, actual);
+}
+
+static uint64_t
+bench_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+bench_report(const char *  name, const char *  impl, uint64_t ns, uint64_t chars)
+{
+	double ns_per_char    = (double)ns / chars;
+	double bytes_per_second = chars * 1e9 / ns;
+	printf("  %-10s %-18s %8.2f ns/char %10.2f MB/s\n", name, impl, ns_per_char, bytes_per_second / 1e6);
+}
+
+/*
+ * 	Times kBenchConfigBenchIterations calls of both str_utils_format and snprintf with the same arguments.
+ * 	The format string is read through a volatile pointer, so that the compiler cannot fold snprintf.
+ */
+#define BENCH_CASE(name, fmt, ...)                                                                      \
+	do                                                                                              \
+	{                                                                                               \
+		const char * volatile bench_fmt = fmt;                                                  \
+		char	 buf[kBenchConfigBufferSize];                                                   \
+		uint64_t chars = 0;                                                                     \
+		uint64_t start = bench_now_ns();                                                        \
+		for (int i = 0; i < kBenchConfigBenchIterations; i++)                                   \
+		{                                                                                       \
+			chars += str_utils_format(buf, sizeof(buf), bench_fmt, ##__VA_ARGS__);          \
+		}                                                                                       \
+		bench_report(name, "str_utils_format", bench_now_ns() - start, chars);                  \
+		chars = 0;                                                                              \
+		start = bench_now_ns();                                                                 \
+		for (int i = 0; i < kBenchConfigBenchIterations; i++)                                   \
+		{                                                                                       \
+			chars += snprintf(buf, sizeof(buf), bench_fmt, ##__VA_ARGS__);                  \
+		}                                                                                       \
+		bench_report(name, "snprintf", bench_now_ns() - start, chars);                          \
+	}                                                                                               \
+	while (0)
+
+int
+main(void)
+{
+	for (int i = 0; i < kBenchConfigFuzzIterations; i++)
+	{
+		bench_fuzz_padded();
+		bench_fuzz_plain();
+		bench_fuzz_long();
+	}
+
+	printf("fuzz: %d cases, %d mismatches\n", 3 * kBenchConfigFuzzIterations, bench_failures);
+
+	printf("benchmark: %d iterations per case\n", kBenchConfigBenchIterations);
+	BENCH_CASE("literal", "LED: Red\n");
+	BENCH_CASE("decimal", "%d %d %d\n", 7, -12345, 2000000000);
+	BENCH_CASE("unsigned", "%u %u\n", 42U, 4000000000U);
+	BENCH_CASE("hex", "0x%x 0x%x\n", 0xbeef, 0xdeadbeef);
+	BENCH_CASE("64-bit", "%llu 0x%llx\n", 18446744073709551615ULL, 0x123456789abcdefULL);
+	BENCH_CASE("string", "%s: %s\n", "uart", "Signaloid C0-microSD");
+	BENCH_CASE("padded", "%*s|%*d|%*x\n", 12, "value", 8, 42, 8, 0xff);
+
+	return bench_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,356 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Host stress test and benchmark for timer_wheel.
+ *
+ * 	1. Stress: starts, restarts and cancels thousands of timers at random, with
+ * 	   delays spanning many wheel revolutions, one-shot and periodic, including
+ * 	   from inside callbacks, and checks every callback against a model of when
+ * 	   each timer should fire: at its exact tick, exactly once per period, and
+ * 	   never after being cancelled.
+ * 	2. Benchmark: reports ns per tick for a growing number of pending periodic
+ * 	   timers, and ns per start/cancel pair.
+ *
+ * 	Exits with a non-zero status if any callback does not match the model.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "timer_wheel.h"
+
+
+typedef enum
+{
+	kBenchConfigStressTimers	= 4096,
+	kBenchConfigStressTicks		= 200000,
+	kBenchConfigStressOpsPerTick	= 8,
+	kBenchConfigStressMaxDelay	= 20 * kTIMER_WHEEL_CONF_SLOTS,
+	kBenchConfigBenchTicks		= 100000,
+	kBenchConfigBenchOps		= 1000000,
+	kBenchConfigMaxFailures		= 10,
+} BenchConfig;
+
+
+/*
+ * 	A timer, and the model of when it should fire.
+ */
+typedef struct
+{
+	TimerWheelTimer timer;
+	bool		armed;
+	uint32_t	expected;
+	uint32_t	period;
+	uint64_t	fires;
+} BenchTimer;
+
+
+static TimerWheel bench_wheel;
+static BenchTimer bench_timers[kBenchConfigStressTimers];
+static uint32_t	  bench_armed	  = 0;
+static uint64_t	  bench_fires	  = 0;
+static uint32_t	  bench_rng_state = 0x12345678;
+static int	  bench_failures  = 0;
+
+/*
+ * 	Set while timer_wheel_tick() runs, when timers expiring at the current tick may not have been called yet.
+ */
+static bool bench_in_tick = false;
+
+
+static uint32_t
+bench_rand(void)
+{
+	/*
+	 * 	xorshift32
+	 */
+	bench_rng_state ^= bench_rng_state << 13;
+	bench_rng_state ^= bench_rng_state >> 17;
+	bench_rng_state ^= bench_rng_state << 5;
+	return bench_rng_state;
+}
+
+static void
+bench_fail(const BenchTimer *  bench_timer, const char *  reason)
+{
+	if (bench_failures++ < kBenchConfigMaxFailures)
+	{
+		printf(
+			"FAIL: timer %d at tick %u: %s (armed %d, expected %u, period %u)\n",
+			(int)(bench_timer - bench_timers),
+			bench_wheel.now,
+			reason,
+			bench_timer->armed,
+			bench_timer->expected,
+			bench_timer->period);
+	}
+}
+
+static void bench_random_op(void);
+
+static void
+bench_callback(void *  ctx)
+{
+	BenchTimer *bench_timer = ctx;
+
+	bench_fires++;
+	bench_timer->fires++;
+
+	if (!bench_timer->armed)
+	{
+		bench_fail(bench_timer, "fired while not armed");
+		return;
+	}
+
+	if (bench_timer->expected != bench_wheel.now)
+	{
+		bench_fail(bench_timer, "fired at the wrong tick");
+	}
+
+	if (bench_timer->period != 0)
+	{
+		bench_timer->expected += bench_timer->period;
+	}
+	else
+	{
+		bench_timer->armed = false;
+		bench_armed--;
+	}
+
+	/*
+	 * 	Start and cancel timers from the callback, sometimes this one.
+	 */
+	if (bench_rand() % 8 == 0)
+	{
+		bench_random_op();
+	}
+}
+
+static void
+bench_start(BenchTimer *  bench_timer, uint32_t delay, uint32_t period)
+{
+	timer_wheel_start(&bench_wheel, &bench_timer->timer, delay, period, bench_callback, bench_timer);
+
+	if (!bench_timer->armed)
+	{
+		bench_armed++;
+	}
+	bench_timer->armed    = true;
+	bench_timer->expected = bench_wheel.now + (delay == 0 ? 1 : delay);
+	bench_timer->period   = period;
+}
+
+static void
+bench_cancel(BenchTimer *  bench_timer)
+{
+	timer_wheel_cancel(&bench_wheel, &bench_timer->timer);
+
+	if (bench_timer->armed)
+	{
+		bench_armed--;
+	}
+	bench_timer->armed = false;
+}
+
+/*
+ * 	Checks that an armed timer has not missed its tick.
+ */
+static void
+bench_check(const BenchTimer *  bench_timer)
+{
+	if (bench_timer->armed != timer_wheel_is_pending(&bench_timer->timer))
+	{
+		bench_fail(bench_timer, "pending state does not match the model");
+	}
+
+	int32_t remaining = (int32_t)(bench_timer->expected - bench_wheel.now);
+
+	if (bench_timer->armed && (remaining < 0 || (remaining == 0 && !bench_in_tick)))
+	{
+		bench_fail(bench_timer, "missed its tick");
+	}
+}
+
+static void
+bench_random_op(void)
+{
+	BenchTimer *bench_timer = &bench_timers[bench_rand() % kBenchConfigStressTimers];
+	uint32_t    op		= bench_rand() % 8;
+
+	bench_check(bench_timer);
+
+	if (op == 0)
+	{
+		bench_cancel(bench_timer);
+	}
+	else if (op == 1)
+	{
+		/*
+		 * 	Periodic, with periods around and across the wheel size.
+		 */
+		bench_start(
+			bench_timer,
+			bench_rand() % kBenchConfigStressMaxDelay,
+			1 + bench_rand() % (3 * kTIMER_WHEEL_CONF_SLOTS));
+	}
+	else
+	{
+		bench_start(bench_timer, bench_rand() % kBenchConfigStressMaxDelay, 0);
+	}
+}
+
+static void
+bench_stress(void)
+{
+	timer_wheel_init(&bench_wheel);
+
+	for (int i = 0; i < kBenchConfigStressTimers; i++)
+	{
+		timer_wheel_timer_init(&bench_timers[i].timer);
+	}
+
+	for (int tick = 0; tick < kBenchConfigStressTicks; tick++)
+	{
+		for (int op = 0; op < kBenchConfigStressOpsPerTick; op++)
+		{
+			bench_random_op();
+		}
+
+		bench_in_tick = true;
+		timer_wheel_tick(&bench_wheel);
+		bench_in_tick = false;
+
+		if (bench_wheel.pending != bench_armed)
+		{
+			if (bench_failures++ < kBenchConfigMaxFailures)
+			{
+				printf(
+					"FAIL: tick %u: %u timers pending, %u armed\n",
+					bench_wheel.now,
+					bench_wheel.pending,
+					bench_armed);
+			}
+		}
+	}
+
+	for (int i = 0; i < kBenchConfigStressTimers; i++)
+	{
+		bench_check(&bench_timers[i]);
+	}
+
+	printf(
+		"stress: %d timers, %d ticks, %llu callbacks, %u pending, %d failures\n",
+		kBenchConfigStressTimers,
+		kBenchConfigStressTicks,
+		(unsigned long long)bench_fires,
+		bench_wheel.pending,
+		bench_failures);
+}
+
+static uint64_t
+bench_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+bench_nop_callback(void *  ctx)
+{
+	(void)ctx;
+}
+
+/*
+ * 	Times kBenchConfigBenchTicks ticks with timers periodic timers pending, with
+ * 	periods of up to 4 wheel revolutions, so that the slots also hold timers
+ * 	which are skipped.
+ */
+static void
+bench_ticks(int timers)
+{
+	TimerWheelTimer *wheel_timers = calloc(timers, sizeof(TimerWheelTimer));
+	uint64_t	 fired	      = 0;
+
+	timer_wheel_init(&bench_wheel);
+
+	for (int i = 0; i < timers; i++)
+	{
+		uint32_t period = 1 + bench_rand() % (4 * kTIMER_WHEEL_CONF_SLOTS);
+		timer_wheel_start(&bench_wheel, &wheel_timers[i], bench_rand() % period, period, bench_nop_callback, NULL);
+	}
+
+	uint64_t start = bench_now_ns();
+	for (int tick = 0; tick < kBenchConfigBenchTicks; tick++)
+	{
+		fired += timer_wheel_tick(&bench_wheel);
+	}
+	uint64_t ns = bench_now_ns() - start;
+
+	printf(
+		"  %6d timers %8.1f ns/tick %8.2f callbacks/tick\n",
+		timers,
+		(double)ns / kBenchConfigBenchTicks,
+		(double)fired / kBenchConfigBenchTicks);
+
+	free(wheel_timers);
+}
+
+static void
+bench_start_cancel(void)
+{
+	TimerWheelTimer timer;
+
+	timer_wheel_init(&bench_wheel);
+	timer_wheel_timer_init(&timer);
+
+	uint64_t start = bench_now_ns();
+	for (int i = 0; i < kBenchConfigBenchOps; i++)
+	{
+		timer_wheel_start(&bench_wheel, &timer, (uint32_t)i, 0, bench_nop_callback, NULL);
+		timer_wheel_cancel(&bench_wheel, &timer);
+	}
+	uint64_t ns = bench_now_ns() - start;
+
+	printf("  start+cancel %8.1f ns\n", (double)ns / kBenchConfigBenchOps);
+}
+
+int
+main(void)
+{
+	bench_stress();
+
+	printf("benchmark: %d ticks per case, %d slots\n", kBenchConfigBenchTicks, kTIMER_WHEEL_CONF_SLOTS);
+	bench_ticks(16);
+	bench_ticks(256);
+	bench_ticks(1024);
+	bench_ticks(4096);
+	bench_ticks(16384);
+	bench_start_cancel();
+
+	return bench_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,193 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#ifndef __ALLOC_H
+#define __ALLOC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Constant-time memory allocation.
+ *
+ * 	Two allocators share the SRAM between the end of .bss (_end) and the
+ * 	stack, with no headers, no coalescing and no fragmentation:
+ *
+ * 	- Fixed-block pools, for objects that are freed individually. Each pool
+ * 	  is a free list of equal blocks, in .bss, so that the linker checks that
+ * 	  they fit. alloc_pool_alloc() takes a block from the smallest pool whose
+ * 	  blocks fit the request, or from the next larger one when it is empty.
+ * 	- A bump arena, over the rest of the SRAM below the stack reserve, for
+ * 	  objects that live until a known point: alloc_arena_mark() saves the
+ * 	  arena's position, and alloc_arena_reset() frees everything allocated
+ * 	  since, at once.
+ *
+ * 	Both are safe to use from interrupt handlers. alloc_get_stats() reports
+ * 	the blocks and bytes in use, and their high-water marks.
+ *
+ * 	uint8_t *  packet = alloc_pool_alloc(48);
+ * 	...
+ * 	alloc_free(packet);
+ *
+ * 	AllocArenaMark mark = alloc_arena_mark();
+ * 	int32_t *  scratch = alloc_arena_alloc(1024 * sizeof(int32_t));
+ * 	...
+ * 	alloc_arena_reset(mark);
+ */
+
+typedef enum ALLOC_CONF_enum
+{
+	/*
+	 * 	Bytes kept free for the stack, between the arena and the top of the SRAM.
+	 */
+	kALLOC_CONF_STACK_RESERVE	= 8 * 1024,
+
+	/*
+	 * 	Alignment of arena allocations.
+	 */
+	kALLOC_CONF_ALIGN		= 8,
+} ALLOC_CONF;
+
+/*
+ * 	The pools, as POOL(block size, block count), in increasing block size. Block sizes must be
+ * 	multiples of kALLOC_CONF_ALIGN. Define ALLOC_CONF_POOLS before including alloc.h, e.g. with
+ * 	-include, to change them.
+ */
+#ifndef ALLOC_CONF_POOLS
+	#define ALLOC_CONF_POOLS(POOL)	\
+		POOL(16, 64)		\
+		POOL(32, 64)		\
+		POOL(64, 32)		\
+		POOL(128, 16)		\
+		POOL(256, 8)
+#endif
+
+#define ALLOC_COUNT_POOL(block_size, block_count) +1
+
+enum
+{
+	kAllocPools = 0 ALLOC_CONF_POOLS(ALLOC_COUNT_POOL),
+};
+
+/**
+ * 	@brief Position of the arena, to return to with alloc_arena_reset().
+ */
+typedef uintptr_t AllocArenaMark;
+
+/**
+ * 	@brief Counters of a pool.
+ */
+typedef struct
+{
+	uint32_t	block_size;
+	uint32_t	blocks;
+	uint32_t	used;
+	uint32_t	high_water;
+	uint32_t	failures;
+} AllocPoolStats;
+
+/**
+ * 	@brief Counters of the allocators, see alloc_get_stats().
+ */
+typedef struct
+{
+	AllocPoolStats	pools[kAllocPools];
+	uint32_t	arena_size;
+	uint32_t	arena_used;
+	uint32_t	arena_high_water;
+	uint32_t	arena_failures;
+} AllocStats;
+
+/**
+ * 	@brief Empties the pools, and sets up the arena from the end of .bss to the stack reserve, which
+ * 	becomes the stack measured by stack_high_water() (stack.h). Call once at startup, before allocating.
+ */
+void alloc_init(void);
+
+/**
+ * 	@brief Takes a block from the smallest non-empty pool whose blocks fit size bytes.
+ *
+ * 	@param size is the number of bytes needed
+ * 	@return void* the block, aligned to its size up to 16 bytes, or NULL if no pool has a free block that fits
+ */
+void *alloc_pool_alloc(size_t size);
+
+/**
+ * 	@brief Returns a block to its pool. Does nothing for NULL, and for arena allocations, which are only
+ * 	freed by alloc_arena_reset().
+ *
+ * 	@param ptr is a block returned by alloc_pool_alloc()
+ */
+void alloc_free(void *  ptr);
+
+/**
+ * 	@brief Allocates size bytes from the arena, aligned to kALLOC_CONF_ALIGN.
+ *
+ * 	@param size is the number of bytes needed
+ * 	@return void* the allocation, or NULL if the arena is full
+ */
+void *alloc_arena_alloc(size_t size);
+
+/**
+ * 	@brief Allocates size bytes from the arena, aligned to align.
+ *
+ * 	@param size is the number of bytes needed
+ * 	@param align is the alignment, a power of two
+ * 	@return void* the allocation, or NULL if the arena is full
+ */
+void *alloc_arena_alloc_aligned(size_t size, size_t align);
+
+/**
+ * 	@brief Returns the current position of the arena.
+ */
+AllocArenaMark alloc_arena_mark(void);
+
+/**
+ * 	@brief Frees every arena allocation made since mark was taken.
+ *
+ * 	@param mark is a position returned by alloc_arena_mark()
+ */
+void alloc_arena_reset(AllocArenaMark mark);
+
+/**
+ * 	@brief Copies the allocator counters.
+ *
+ * 	@param stats is the destination
+ */
+void alloc_get_stats(AllocStats *  stats);
+
+/**
+ * 	@brief Prints the allocator counters over the UART, one line per pool and one for the arena.
+ */
+void alloc_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __COBS_H
+#define __COBS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Consistent Overhead Byte Stuffing.
+ *
+ * 	Encodes a buffer so that it contains no zero bytes, at the cost of one byte
+ * 	per 254 bytes, plus one. A zero byte can then delimit frames on a byte
+ * 	stream, and a receiver resynchronizes at the next zero after an error.
+ */
+
+/**
+ * 	@brief Maximum encoded length of len bytes.
+ */
+#define COBS_ENCODED_MAX(len) ((len) + ((len) / 254) + 1)
+
+/**
+ * 	@brief Encodes src into dst, without the zero delimiter.
+ *
+ * 	@param dst is the destination, with room for COBS_ENCODED_MAX(len) bytes
+ * 	@param src is the data to encode
+ * 	@param len is the length of src
+ * 	@return uint32_t the encoded length
+ */
+uint32_t cobs_encode(uint8_t *  dst, const uint8_t *  src, uint32_t len);
+
+/**
+ * 	@brief Decodes src, without its zero delimiter, into dst.
+ *
+ * 	@param dst is the destination
+ * 	@param dst_max is the size of dst
+ * 	@param src is the encoded data
+ * 	@param len is the length of src
+ * 	@return int32_t the decoded length, or -1 if src is not valid COBS or does not fit in dst
+ */
+int32_t cobs_decode(uint8_t *  dst, uint32_t dst_max, const uint8_t *  src, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __CRC16_H
+#define __CRC16_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum CRC16_CONF_enum
+{
+	/*
+	 * 	Initial value of CRC-16/CCITT-FALSE (polynomial 0x1021, not reflected).
+	 */
+	kCRC16_CONF_INIT = 0xffff,
+} CRC16_CONF;
+
+/**
+ * 	@brief Updates a CRC-16/CCITT-FALSE with len bytes. Start with kCRC16_CONF_INIT.
+ * 	Matches Python's binascii.crc_hqx(data, 0xffff).
+ *
+ * 	@param crc is the CRC of the preceding bytes, or kCRC16_CONF_INIT
+ * 	@param data is the data
+ * 	@param len is the length of data
+ * 	@return uint16_t the updated CRC
+ */
+uint16_t crc16_update(uint16_t crc, const uint8_t *  data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
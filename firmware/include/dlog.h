@@ -0,0 +1,197 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#ifndef __DLOG_H
+#define __DLOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Deferred logging.
+ *
+ * 	DLOG() takes a format string literal and its arguments, as uart_printf().
+ * 	Building with DLOG=1 defers the formatting to the host. The format string
+ * 	is placed in the .dlog section, which the linker script does not load, and
+ * 	links at address zero, and the log site only copies a record into an SRAM
+ * 	ring buffer, i.e.
+ * 		- the offset of the format string in .dlog, as a varint
+ * 		- the low 32 bits of timer0's uptime counter, little-endian
+ * 		- the arguments: integers as zigzag varints, and strings (char *) as
+ * 		  a varint length followed by at most kDLOG_CONF_STRING_MAX bytes
+ * 	which costs tens of cycles and bytes, instead of formatting and sending
+ * 	every character.
+ *
+ * 	dlog_drain() sends the records over the UART, each followed by its CRC-16
+ * 	(crc16.h), COBS-encoded (cobs.h), and delimited by zero bytes, so that
+ * 	frames can be interleaved with text output. Call it from the lowest
+ * 	priority task (sched.h), so that it only runs when the CPU would be idle.
+ * 	tools/dlog_decode.py reads the format strings from the firmware ELF, and
+ * 	prints the log as text, with the timestamps:
+ *
+ * 	DLOG("spi: %u bytes, status %x\n", len, status);
+ *
+ * 	When the ring buffer is full, new records are dropped, and counted as lost.
+ * 	With DLOG=0, the default, DLOG() is uart_printf(), so that the log can be
+ * 	read without the decoder, and dlog_drain() does nothing.
+ */
+
+typedef enum DLOG_CONF_enum
+{
+	/*
+	 * 	Ring buffer size, in bytes. Must be a power of two.
+	 */
+	kDLOG_CONF_BUFFER_SIZE	= 1024,
+
+	/*
+	 * 	Maximum record size, before the CRC-16 is appended. Records with
+	 * 	arguments that do not fit are dropped, and counted as lost.
+	 */
+	kDLOG_CONF_RECORD_MAX	= 128,
+
+	/*
+	 * 	Longer string arguments are truncated.
+	 */
+	kDLOG_CONF_STRING_MAX	= 48,
+
+	kDLOG_CONF_CRC_SIZE	= 2,
+} DLOG_CONF;
+
+/**
+ * 	@brief A record being built by a log site. Only use through DLOG().
+ */
+typedef struct
+{
+	uint32_t	len;
+	bool		overflow;
+	uint8_t		buf[kDLOG_CONF_RECORD_MAX + kDLOG_CONF_CRC_SIZE];
+} DlogRecord;
+
+/**
+ * 	@brief Deferred logging counters, see dlog_get_stats().
+ */
+typedef struct
+{
+	/*
+	 * 	Records logged, and records dropped because the ring buffer was full or they did not fit in a record.
+	 */
+	uint32_t records;
+	uint32_t lost;
+
+	/*
+	 * 	Frames sent by dlog_drain(), and their bytes, including the delimiters.
+	 */
+	uint32_t frames;
+	uint32_t frame_bytes;
+} DlogStats;
+
+/*
+ * 	Record encoding, called by DLOG() in order. Safe to call from interrupt handlers.
+ */
+void dlog_begin(DlogRecord *  record, uint32_t format_offset);
+void dlog_put_i32(DlogRecord *  record, int32_t value);
+void dlog_put_i64(DlogRecord *  record, int64_t value);
+void dlog_put_string(DlogRecord *  record, const char *  str);
+void dlog_end(DlogRecord *  record);
+
+/*
+ * 	Every integer type is encoded by value, so that the decoder can print it as
+ * 	any of %d, %u, %x and %c, whatever its signedness.
+ */
+#if __SIZEOF_LONG__ == 8
+	#define DLOG_PUT_LONG	dlog_put_i64
+#else
+	#define DLOG_PUT_LONG	dlog_put_i32
+#endif
+
+#define DLOG_PUT(record, arg)                                                                            \
+	_Generic((arg),                                                                                  \
+		char *: dlog_put_string,                                                                 \
+		const char *: dlog_put_string,                                                           \
+		long: DLOG_PUT_LONG,                                                                     \
+		unsigned long: DLOG_PUT_LONG,                                                            \
+		long long: dlog_put_i64,                                                                 \
+		unsigned long long: dlog_put_i64,                                                        \
+		default: dlog_put_i32)(record, arg);
+
+/*
+ * 	DLOG_PUT() of each argument, for up to 8 arguments.
+ */
+#define DLOG_COUNT(...)						DLOG_COUNT_(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define DLOG_COUNT_(_, a1, a2, a3, a4, a5, a6, a7, a8, n, ...)	n
+#define DLOG_CONCAT(a, b)					DLOG_CONCAT_(a, b)
+#define DLOG_CONCAT_(a, b)					a##b
+
+#define DLOG_PUT_0(record)
+#define DLOG_PUT_1(record, arg)		DLOG_PUT(record, arg)
+#define DLOG_PUT_2(record, arg, ...)	DLOG_PUT(record, arg) DLOG_PUT_1(record, __VA_ARGS__)
+#define DLOG_PUT_3(record, arg, ...)	DLOG_PUT(record, arg) DLOG_PUT_2(record, __VA_ARGS__)
+#define DLOG_PUT_4(record, arg, ...)	DLOG_PUT(record, arg) DLOG_PUT_3(record, __VA_ARGS__)
+#define DLOG_PUT_5(record, arg, ...)	DLOG_PUT(record, arg) DLOG_PUT_4(record, __VA_ARGS__)
+#define DLOG_PUT_6(record, arg, ...)	DLOG_PUT(record, arg) DLOG_PUT_5(record, __VA_ARGS__)
+#define DLOG_PUT_7(record, arg, ...)	DLOG_PUT(record, arg) DLOG_PUT_6(record, __VA_ARGS__)
+#define DLOG_PUT_8(record, arg, ...)	DLOG_PUT(record, arg) DLOG_PUT_7(record, __VA_ARGS__)
+
+#ifdef CONFIG_DLOG_DISABLE
+	#define DLOG(format, ...)	uart_printf(format, ##__VA_ARGS__)
+#else
+	#define DLOG(format, ...)                                                                        \
+		do                                                                                       \
+		{                                                                                        \
+			static const char dlog_format[]                                                  \
+				__attribute__((section(".dlog"), used)) = format;                        \
+			DlogRecord dlog_record;                                                          \
+			dlog_begin(&dlog_record, (uint32_t)(uintptr_t)dlog_format);                      \
+			DLOG_CONCAT(DLOG_PUT_, DLOG_COUNT(__VA_ARGS__))(&dlog_record, ##__VA_ARGS__)     \
+			dlog_end(&dlog_record);                                                          \
+		} while (0)
+#endif
+
+/**
+ * 	@brief Sends up to max_records of the oldest records not sent yet over the UART, one frame each.
+ * 	The first call also sends the system clock frequency, and records lost since the previous call are
+ * 	reported by a record of their own.
+ *
+ * 	@param max_records is the maximum number of records to send
+ * 	@return uint32_t the number of records still to send
+ */
+uint32_t dlog_drain(uint32_t max_records);
+
+/**
+ * 	@brief Copies the deferred logging counters.
+ *
+ * 	@param stats is the destination
+ */
+void dlog_get_stats(DlogStats *  stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
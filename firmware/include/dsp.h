@@ -0,0 +1,347 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#ifndef __DSP_H
+#define __DSP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Fixed-point signal processing kernels.
+ *
+ * 	The core is RV32IM without an FPU, so float and double arithmetic goes
+ * 	through soft-float library calls. These kernels work on Q15 (int16_t, 15
+ * 	fractional bits, [-1, 1)) and Q31 (int32_t, 31 fractional bits) samples
+ * 	with integer multiplies only: Q15 products are single mul instructions,
+ * 	and Q31 products use mulh for their high word. The inner loops are
+ * 	unrolled, and the block kernels are RAMFUNC, so that they execute from
+ * 	SRAM rather than from the flash.
+ *
+ * 	Results are rounded to nearest and saturated, unless noted otherwise.
+ * 	Filter states are separate from their (const) coefficients, so that one
+ * 	set of coefficients can filter several channels.
+ */
+
+typedef int16_t DspQ15;
+typedef int32_t DspQ31;
+
+typedef enum DSP_CONF_enum
+{
+	/*
+	 * 	Largest FFT, as log2 of its number of points, set by the size of the twiddle table.
+	 */
+	kDSP_CONF_FFT_MAX_LOG2	= 10,
+} DSP_CONF;
+
+/**
+ * 	@brief Converts a constant to fixed-point with frac_bits fractional bits, rounded and saturated to
+ * 	[-max - 1, max]. Only for compile-time constants: with a variable value, it calls soft-float.
+ */
+#define DSP_FIXED(value, frac_bits, max)						\
+	((value) * (double)(1ll << (frac_bits)) >= (double)(max) ? (max)		\
+	 : (value) * (double)(1ll << (frac_bits)) <= -(double)(max) - 1.0 ? -(max) - 1	\
+	 : (int32_t)((value) * (double)(1ll << (frac_bits)) + ((value) < 0 ? -0.5 : 0.5)))
+
+#define DSP_Q15(value)	((DspQ15)DSP_FIXED((value), 15, INT16_MAX))
+#define DSP_Q14(value)	((DspQ15)DSP_FIXED((value), 14, INT16_MAX))
+#define DSP_Q31(value)	((DspQ31)DSP_FIXED((value), 31, INT32_MAX))
+#define DSP_Q30(value)	((DspQ31)DSP_FIXED((value), 30, INT32_MAX))
+
+/**
+ * 	@brief Saturates a 32-bit value to Q15.
+ */
+static inline DspQ15
+dsp_q15_saturate(int32_t value)
+{
+	return value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : (DspQ15)value;
+}
+
+/**
+ * 	@brief Saturates a 64-bit value to Q31.
+ */
+static inline DspQ31
+dsp_q31_saturate(int64_t value)
+{
+	return value > INT32_MAX ? INT32_MAX : value < INT32_MIN ? INT32_MIN : (DspQ31)value;
+}
+
+/**
+ * 	@brief Q15 product, rounded and saturated.
+ */
+static inline DspQ15
+dsp_q15_mul(DspQ15 a, DspQ15 b)
+{
+	return dsp_q15_saturate(((int32_t)a * b + (1 << 14)) >> 15);
+}
+
+/**
+ * 	@brief Q31 product, rounded and saturated.
+ */
+static inline DspQ31
+dsp_q31_mul(DspQ31 a, DspQ31 b)
+{
+	return dsp_q31_saturate(((int64_t)a * b + (1ll << 30)) >> 31);
+}
+
+/**
+ * 	@brief Sum of the products of two Q15 vectors.
+ *
+ * 	@param a is the first vector
+ * 	@param b is the second vector
+ * 	@param n is the length of the vectors
+ * 	@return int64_t the sum, in Q30, exact
+ */
+int64_t dsp_dot_q15(const DspQ15 *  a, const DspQ15 *  b, uint32_t n);
+
+/**
+ * 	@brief Sum of the products of two Q31 vectors. Each product is truncated to its high word (mulh).
+ *
+ * 	@param a is the first vector
+ * 	@param b is the second vector
+ * 	@param n is the length of the vectors
+ * 	@return int64_t the sum, in Q30
+ */
+int64_t dsp_dot_q31(const DspQ31 *  a, const DspQ31 *  b, uint32_t n);
+
+/**
+ * 	@brief Q15 FIR filter. The accumulator is 32-bit, so the sum of the absolute values of the
+ * 	coefficients must be below 2.
+ */
+typedef struct
+{
+	const DspQ15 *	coeffs;
+	DspQ15 *	state;
+	uint32_t	taps;
+	uint32_t	index;
+} DspFirQ15;
+
+/**
+ * 	@brief Initializes a FIR filter, with a zero history.
+ *
+ * 	@param fir is the filter
+ * 	@param coeffs are the taps coefficients, coeffs[0] applying to the newest sample
+ * 	@param state is the sample history, of 2 * taps samples
+ * 	@param taps is the number of coefficients
+ */
+void dsp_fir_q15_init(DspFirQ15 *  fir, const DspQ15 *  coeffs, DspQ15 *  state, uint32_t taps);
+
+/**
+ * 	@brief Filters a block of samples. in and out may be the same buffer.
+ *
+ * 	@param fir is the filter
+ * 	@param in are the input samples
+ * 	@param out are the output samples
+ * 	@param n is the number of samples
+ */
+void dsp_fir_q15(DspFirQ15 *  fir, const DspQ15 *  in, DspQ15 *  out, uint32_t n);
+
+/**
+ * 	@brief Q15 biquad coefficients, in Q14 so that |a1| can reach 2, for
+ * 	y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2], e.g. scipy's
+ * 	sos sections, with a0 = 1.
+ */
+typedef struct
+{
+	DspQ15	b0;
+	DspQ15	b1;
+	DspQ15	b2;
+	DspQ15	a1;
+	DspQ15	a2;
+} DspBiquadCoeffsQ15;
+
+typedef struct
+{
+	DspQ15	x1;
+	DspQ15	x2;
+	DspQ15	y1;
+	DspQ15	y2;
+} DspBiquadStateQ15;
+
+/**
+ * 	@brief Q31 biquad coefficients, in Q30, as for DspBiquadCoeffsQ15.
+ */
+typedef struct
+{
+	DspQ31	b0;
+	DspQ31	b1;
+	DspQ31	b2;
+	DspQ31	a1;
+	DspQ31	a2;
+} DspBiquadCoeffsQ31;
+
+typedef struct
+{
+	DspQ31	x1;
+	DspQ31	x2;
+	DspQ31	y1;
+	DspQ31	y2;
+} DspBiquadStateQ31;
+
+/**
+ * 	@brief Cascade of biquad sections (direct form I), i.e. an IIR filter of order 2 * stages.
+ */
+typedef struct
+{
+	const DspBiquadCoeffsQ15 *	coeffs;
+	DspBiquadStateQ15 *		state;
+	uint32_t			stages;
+} DspBiquadQ15;
+
+typedef struct
+{
+	const DspBiquadCoeffsQ31 *	coeffs;
+	DspBiquadStateQ31 *		state;
+	uint32_t			stages;
+} DspBiquadQ31;
+
+/**
+ * 	@brief Initializes a biquad cascade, with a zero history.
+ *
+ * 	@param biquad is the filter
+ * 	@param coeffs are the coefficients of each section
+ * 	@param state is the history of each section
+ * 	@param stages is the number of sections
+ */
+void dsp_biquad_q15_init(DspBiquadQ15 *  biquad, const DspBiquadCoeffsQ15 *  coeffs, DspBiquadStateQ15 *  state, uint32_t stages);
+void dsp_biquad_q31_init(DspBiquadQ31 *  biquad, const DspBiquadCoeffsQ31 *  coeffs, DspBiquadStateQ31 *  state, uint32_t stages);
+
+/**
+ * 	@brief Filters a block of samples through every section. in and out may be the same buffer.
+ * 	The Q15 sections accumulate exact products in 64 bits. The Q31 sections accumulate the
+ * 	products' high words (mulh), so their precision is Q29.
+ *
+ * 	@param biquad is the filter
+ * 	@param in are the input samples
+ * 	@param out are the output samples
+ * 	@param n is the number of samples
+ */
+void dsp_biquad_q15(DspBiquadQ15 *  biquad, const DspQ15 *  in, DspQ15 *  out, uint32_t n);
+void dsp_biquad_q31(DspBiquadQ31 *  biquad, const DspQ31 *  in, DspQ31 *  out, uint32_t n);
+
+/**
+ * 	@brief One-pole low-pass IIR filter, y[n] = y[n-1] + alpha (x[n] - y[n-1]). The output is kept
+ * 	with 14 extra fractional bits, so that small alphas do not stall it.
+ */
+typedef struct
+{
+	DspQ15	alpha;
+	int32_t	y;
+} DspIir1Q15;
+
+/**
+ * 	@brief Initializes a one-pole filter, with a zero output.
+ *
+ * 	@param iir is the filter
+ * 	@param alpha is the smoothing factor, in (0, 1)
+ */
+void dsp_iir1_q15_init(DspIir1Q15 *  iir, DspQ15 alpha);
+
+/**
+ * 	@brief Filters a block of samples. in and out may be the same buffer.
+ */
+void dsp_iir1_q15(DspIir1Q15 *  iir, const DspQ15 *  in, DspQ15 *  out, uint32_t n);
+
+/**
+ * 	@brief Moving average over the last length samples, in constant time per sample.
+ */
+typedef struct
+{
+	DspQ15 *	window;
+	uint32_t	length;
+	uint32_t	index;
+	int32_t		sum;
+	uint32_t	reciprocal;
+} DspMovingAverageQ15;
+
+/**
+ * 	@brief Initializes a moving average, with a zero history.
+ *
+ * 	@param average is the moving average
+ * 	@param window is the sample history, of length samples
+ * 	@param length is the number of samples averaged, up to 65536
+ */
+void dsp_moving_average_q15_init(DspMovingAverageQ15 *  average, DspQ15 *  window, uint32_t length);
+
+/**
+ * 	@brief Averages a block of samples. in and out may be the same buffer.
+ */
+void dsp_moving_average_q15(DspMovingAverageQ15 *  average, const DspQ15 *  in, DspQ15 *  out, uint32_t n);
+
+/**
+ * 	@brief Running mean and variance of Q15 samples, with Welford's algorithm. Each sample costs one
+ * 	32-bit division. The sum of squares is 64-bit, which bounds the count to 2^19 samples at a
+ * 	full-scale variance.
+ */
+typedef struct
+{
+	uint32_t	count;
+	int32_t		mean;
+	int64_t		m2;
+} DspWelfordQ15;
+
+void dsp_welford_q15_init(DspWelfordQ15 *  welford);
+
+/**
+ * 	@brief Adds a block of samples.
+ */
+void dsp_welford_q15_update(DspWelfordQ15 *  welford, const DspQ15 *  in, uint32_t n);
+
+/**
+ * 	@brief Returns the mean of the samples so far, in Q31.
+ */
+DspQ31 dsp_welford_q15_mean(const DspWelfordQ15 *  welford);
+
+/**
+ * 	@brief Returns the sample variance (divided by count - 1) of the samples so far, in Q31, saturated.
+ */
+DspQ31 dsp_welford_q15_variance(const DspWelfordQ15 *  welford);
+
+/**
+ * 	@brief A complex Q15 sample.
+ */
+typedef struct
+{
+	DspQ15	re;
+	DspQ15	im;
+} DspComplexQ15;
+
+/**
+ * 	@brief In-place radix-2 decimation-in-time FFT. Every stage scales by 1/2 to prevent overflow,
+ * 	so the result is the DFT divided by the number of points. The magnitude of every input sample
+ * 	must be below 1, e.g. any real signal.
+ *
+ * 	@param data are the 2^log2n samples, overwritten by the spectrum, in natural order
+ * 	@param log2n is log2 of the number of points, up to kDSP_CONF_FFT_MAX_LOG2
+ */
+void dsp_fft_q15(DspComplexQ15 *  data, uint32_t log2n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
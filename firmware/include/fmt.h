@@ -0,0 +1,623 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#ifndef __FMT_H
+#define __FMT_H
+
+#ifndef __cplusplus
+#error "fmt.h is C++ only, C code calls the shims declared in fmt_shims.h"
+#endif
+
+/*
+ * 	Compile-time formatting front end, for the format specifiers of str_utils_format_sink().
+ *
+ * 	The format string is a template argument, which is parsed while compiling. Each call expands to a straight
+ * 	sequence of literal writes and integer conversions, with no format parsing and no va_list at run time, and
+ * 	each argument is checked against its conversion specifier:
+ * 		%d	a signed integer, of at most the size of int (no l), long (l) or long long (ll)
+ * 		%u, %x	an unsigned integer, with the same sizes
+ * 		%c	a char
+ * 		%s	a pointer or array convertible to const char *
+ * 		%*	an integer of at most the size of int, for the width, before the value
+ * 	bool, enumerations and plain char arguments of %d, %u and %x are rejected: cast them to the intended type.
+ * 	A wrong argument count or type, or an unknown conversion specifier, fails the build.
+ *
+ * 	example: 	fmt::print<"LED: %s, %*u ms\n">(name, 5, period);
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "str_utils.h"
+#include "uart.h"
+
+
+namespace fmt
+{
+
+/**
+ * 	@brief A format string, as a template argument.
+ */
+template <std::size_t N>
+struct Literal
+{
+	char chars[N];
+
+	consteval
+	Literal(const char (&string)[N])
+	{
+		for (std::size_t i = 0; i < N; i++)
+		{
+			chars[i] = string[i];
+		}
+	}
+};
+
+enum class Conversion : std::uint8_t
+{
+	kLiteral,
+	kChar,
+	kString,
+	kSigned,
+	kUnsigned,
+	kHex,
+};
+
+/**
+ * 	@brief One literal or one conversion of a parsed format string.
+ */
+struct Segment
+{
+	Conversion	conversion;
+
+	/*
+	 * 	Number of l length modifiers, 0 to 2.
+	 */
+	std::uint8_t	length;
+
+	/*
+	 * 	Left padded to the width given by argument width, for %*.
+	 */
+	bool		padded;
+	std::size_t	width;
+
+	/*
+	 * 	Index of the converted argument.
+	 */
+	std::size_t	argument;
+
+	/*
+	 * 	Position and size of a literal in Program::text.
+	 */
+	std::size_t	start;
+	std::size_t	size;
+};
+
+/**
+ * 	@brief A parsed format string. text holds the literals, with %% already reduced to %.
+ */
+template <std::size_t N>
+struct Program
+{
+	char		text[N];
+	Segment		segments[N];
+	std::size_t	count;
+	std::size_t	arguments;
+};
+
+namespace detail
+{
+
+/*
+ * 	Never defined: calling one of them while parsing a format string fails the
+ * 	build, and the compiler error names the problem.
+ */
+void error_unknown_conversion_specifier();
+void error_format_ends_with_percent();
+void error_length_modifier_on_c_or_s();
+
+/**
+ * 	@brief Appends a character to the literals, extending the previous segment when it is an unpadded literal.
+ */
+template <std::size_t N>
+consteval void
+append_literal(Program<N> &  program, std::size_t &  text_size, char c)
+{
+	Segment *  last = program.count > 0 ? &program.segments[program.count - 1] : nullptr;
+
+	if (last == nullptr || last->conversion != Conversion::kLiteral || last->padded)
+	{
+		last		= &program.segments[program.count++];
+		*last		= Segment {};
+		last->conversion = Conversion::kLiteral;
+		last->start	= text_size;
+	}
+
+	program.text[text_size++] = c;
+	last->size++;
+}
+
+template <Literal string>
+consteval auto
+compile()
+{
+	constexpr std::size_t	N = sizeof(string.chars);
+	Program<N>		program {};
+	std::size_t		text_size = 0;
+	std::size_t		i	  = 0;
+
+	while (string.chars[i] != '\0')
+	{
+		if (string.chars[i] != '%')
+		{
+			append_literal(program, text_size, string.chars[i++]);
+			continue;
+		}
+
+		i++;
+
+		Segment segment {};
+
+		if (string.chars[i] == '*')
+		{
+			segment.padded = true;
+			segment.width  = program.arguments++;
+			i++;
+		}
+
+		while (string.chars[i] == 'l' && segment.length < 2)
+		{
+			segment.length++;
+			i++;
+		}
+
+		switch (string.chars[i])
+		{
+			case '%':
+				if (!segment.padded)
+				{
+					append_literal(program, text_size, '%');
+					i++;
+					continue;
+				}
+
+				/*
+				 * 	A padded %, as its own literal segment
+				 */
+				segment.conversion = Conversion::kLiteral;
+				segment.start	   = text_size;
+				segment.size	   = 1;
+				program.text[text_size++] = '%';
+				break;
+
+			case 'c':
+			case 's':
+				if (segment.length != 0)
+				{
+					error_length_modifier_on_c_or_s();
+				}
+				segment.conversion = string.chars[i] == 'c' ? Conversion::kChar : Conversion::kString;
+				segment.argument   = program.arguments++;
+				break;
+
+			case 'd':
+			case 'u':
+			case 'x':
+				segment.conversion = string.chars[i] == 'd'   ? Conversion::kSigned
+						   : string.chars[i] == 'u' ? Conversion::kUnsigned
+									     : Conversion::kHex;
+				segment.argument = program.arguments++;
+				break;
+
+			case '\0':
+				error_format_ends_with_percent();
+				break;
+
+			default:
+				error_unknown_conversion_specifier();
+				break;
+		}
+
+		program.segments[program.count++] = segment;
+		i++;
+	}
+
+	return program;
+}
+
+/**
+ * 	@brief The parsed format string, as a constant shared by every call with the same format.
+ */
+template <Literal string>
+struct Compiled
+{
+	static constexpr auto program = compile<string>();
+};
+
+/**
+ * 	@brief Returns argument I of the pack.
+ */
+template <std::size_t I, typename First, typename... Rest>
+constexpr const auto &
+argument(const First &  first, const Rest &... rest)
+{
+	if constexpr (I == 0)
+	{
+		return first;
+	}
+	else
+	{
+		return argument<I - 1>(rest...);
+	}
+}
+
+template <std::size_t I, typename... Args>
+using ArgumentType = std::remove_cvref_t<decltype(argument<I>(std::declval<const Args &>()...))>;
+
+/*
+ * 	Argument type checks. sizeof(long) is 4 on RV32, so %d takes an int32_t (long) as well as an int.
+ */
+template <typename T>
+constexpr bool kIsInteger = std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>;
+
+template <typename T, std::uint8_t length>
+constexpr bool kFitsLength = sizeof(T) <= (length == 0 ? sizeof(int) : length == 1 ? sizeof(long) : sizeof(long long));
+
+template <typename T>
+constexpr bool kIsWidth = kIsInteger<T> && sizeof(T) <= sizeof(int);
+
+template <typename T>
+constexpr bool kIsString = std::is_convertible_v<const T &, const char *> && !std::is_null_pointer_v<T>;
+
+/**
+ * 	@brief Emits width - len spaces, if width is larger than len, then the string.
+ *
+ * 	@return int the number of characters emitted
+ */
+template <typename Sink>
+inline int
+put_padded(Sink &  sink, int width, const char *  str, std::size_t len)
+{
+	int count = (int)len;
+
+	if (width > 0 && (std::size_t)width > len)
+	{
+		sink.pad((std::size_t)width - len);
+		count = width;
+	}
+
+	if (len > 0)
+	{
+		sink.put(str, len);
+	}
+
+	return count;
+}
+
+/**
+ * 	@brief Writes the digits of an integer to dst, with 32-bit arithmetic when T fits in 32 bits.
+ *
+ * 	@return std::size_t the number of characters written, at most kSTR_UTILS_CONF_BUFFER_SIZE
+ */
+template <Conversion conversion, typename T>
+inline std::size_t
+convert_integer(char *  dst, T value)
+{
+	using Unsigned = std::conditional_t<(sizeof(T) <= sizeof(std::uint32_t)), std::uint32_t, std::uint64_t>;
+
+	std::size_t	len	  = 0;
+	Unsigned	magnitude = (Unsigned)value;
+
+	if constexpr (std::is_signed_v<T>)
+	{
+		if (value < 0)
+		{
+			dst[len++] = '-';
+			magnitude  = (Unsigned)0 - magnitude;
+		}
+	}
+
+	if constexpr (conversion == Conversion::kHex && sizeof(Unsigned) == sizeof(std::uint32_t))
+	{
+		len += str_utils_u32_to_hex(dst + len, magnitude);
+	}
+	else if constexpr (conversion == Conversion::kHex)
+	{
+		len += str_utils_u64_to_hex(dst + len, magnitude);
+	}
+	else if constexpr (sizeof(Unsigned) == sizeof(std::uint32_t))
+	{
+		len += str_utils_u32_to_dec(dst + len, magnitude);
+	}
+	else
+	{
+		len += str_utils_u64_to_dec(dst + len, magnitude);
+	}
+
+	return len;
+}
+
+/**
+ * 	@brief Converts an integer. Without padding, the digits are written in place when the sink has room for
+ * 	them, instead of being copied from a temporary buffer.
+ *
+ * 	@return int the number of characters emitted
+ */
+template <Conversion conversion, bool padded, typename Sink, typename T>
+inline int
+put_integer(Sink &  sink, int width, T value)
+{
+	if constexpr (!padded)
+	{
+		char *  dst = sink.reserve(kSTR_UTILS_CONF_BUFFER_SIZE);
+
+		if (dst != nullptr)
+		{
+			std::size_t len = convert_integer<conversion>(dst, value);
+			sink.commit(len);
+
+			return (int)len;
+		}
+	}
+
+	char		buf[kSTR_UTILS_CONF_BUFFER_SIZE];
+	std::size_t	len = convert_integer<conversion>(buf, value);
+
+	return put_padded(sink, width, buf, len);
+}
+
+/**
+ * 	@brief Emits segment I of the format string, after checking the type of its arguments.
+ *
+ * 	@return int the number of characters emitted
+ */
+template <Literal string, std::size_t I, typename Sink, typename... Args>
+inline int
+put_segment(Sink &  sink, const Args &... args)
+{
+	constexpr const auto &	program = Compiled<string>::program;
+	constexpr Segment	segment = program.segments[I];
+	int			width	= 0;
+
+	if constexpr (segment.padded)
+	{
+		static_assert(kIsWidth<ArgumentType<segment.width, Args...>>, "fmt: the width of %* is not an int");
+		width = (int)argument<segment.width>(args...);
+	}
+
+	if constexpr (segment.conversion == Conversion::kLiteral)
+	{
+		return put_padded(sink, width, program.text + segment.start, segment.size);
+	}
+	else
+	{
+		using T = ArgumentType<segment.argument, Args...>;
+		const T &  value = argument<segment.argument>(args...);
+
+		if constexpr (segment.conversion == Conversion::kChar)
+		{
+			static_assert(std::is_same_v<T, char>, "fmt: the argument of %c is not a char");
+			return put_padded(sink, width, &value, 1);
+		}
+		else if constexpr (segment.conversion == Conversion::kString)
+		{
+			static_assert(kIsString<T>, "fmt: the argument of %s is not a string");
+			const char *  str = value;
+
+			if (str == nullptr)
+			{
+				str = "(null)";
+			}
+
+			return put_padded(sink, width, str, std::strlen(str));
+		}
+		else if constexpr (segment.conversion == Conversion::kSigned)
+		{
+			static_assert(kIsInteger<T> && std::is_signed_v<T>, "fmt: the argument of %d is not a signed integer");
+			static_assert(kFitsLength<T, segment.length>, "fmt: the argument of %d is larger than its length modifier");
+			return put_integer<segment.conversion, segment.padded>(sink, width, value);
+		}
+		else
+		{
+			static_assert(kIsInteger<T> && std::is_unsigned_v<T>, "fmt: the argument of %u or %x is not an unsigned integer");
+			static_assert(kFitsLength<T, segment.length>, "fmt: the argument of %u or %x is larger than its length modifier");
+			return put_integer<segment.conversion, segment.padded>(sink, width, value);
+		}
+	}
+}
+
+template <Literal string, typename Sink, std::size_t... I, typename... Args>
+inline int
+put_segments(Sink &  sink, std::index_sequence<I...>, const Args &... args)
+{
+	int len = 0;
+
+	/*
+	 * 	A comma fold, so that the segments are emitted in order
+	 */
+	((len += put_segment<string, I>(sink, args...)), ...);
+
+	return len;
+}
+
+} /* namespace detail */
+
+/**
+ * 	@brief Sink that writes straight to the UART, like uart_printf().
+ */
+struct UartSink
+{
+	void
+	put(const char *  str, std::size_t len)
+	{
+		for (std::size_t i = 0; i < len; i++)
+		{
+			uart_putchar(str[i]);
+		}
+	}
+
+	void
+	pad(std::size_t count)
+	{
+		while (count-- > 0)
+		{
+			uart_putchar(' ');
+		}
+	}
+
+	char *
+	reserve(std::size_t len)
+	{
+		(void)len;
+
+		return nullptr;
+	}
+
+	void
+	commit(std::size_t len)
+	{
+		(void)len;
+	}
+};
+
+/**
+ * 	@brief Sink that copies into a bounded buffer, always leaving room for the terminating null character.
+ * 	Characters that do not fit are discarded.
+ */
+struct BufferSink
+{
+	char *		buf;
+	std::size_t	size;
+	std::size_t	pos;
+
+	std::size_t
+	room(std::size_t len) const
+	{
+		if (pos + 1 >= size)
+		{
+			return 0;
+		}
+
+		return len < size - 1 - pos ? len : size - 1 - pos;
+	}
+
+	void
+	put(const char *  str, std::size_t len)
+	{
+		std::size_t n = room(len);
+		std::memcpy(buf + pos, str, n);
+		pos += n;
+	}
+
+	void
+	pad(std::size_t count)
+	{
+		std::size_t n = room(count);
+		std::memset(buf + pos, ' ', n);
+		pos += n;
+	}
+
+	char *
+	reserve(std::size_t len)
+	{
+		return pos + len < size ? buf + pos : nullptr;
+	}
+
+	void
+	commit(std::size_t len)
+	{
+		pos += len;
+	}
+};
+
+/**
+ * 	@brief Formats to any sink with the members of UartSink and BufferSink:
+ * 		put(str, len)	emits len characters
+ * 		pad(count)	emits count spaces
+ * 		reserve(len)	returns where len characters can be written in place, or nullptr
+ * 		commit(len)	emits the first len characters written in place
+ *
+ * 	@return int the number of characters emitted
+ */
+template <Literal string, typename Sink, typename... Args>
+inline int
+write(Sink &  sink, const Args &... args)
+{
+	constexpr std::size_t arguments = detail::Compiled<string>::program.arguments;
+
+	static_assert(arguments == sizeof...(Args), "fmt: the number of arguments does not match the format string");
+
+	if constexpr (arguments == sizeof...(Args))
+	{
+		return detail::put_segments<string>(
+			sink,
+			std::make_index_sequence<detail::Compiled<string>::program.count> {},
+			args...);
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+/**
+ * 	@brief Formats to the UART, the compile-time equivalent of uart_printf().
+ *
+ * 	@return int the number of characters written
+ */
+template <Literal string, typename... Args>
+inline int
+print(const Args &... args)
+{
+	UartSink sink;
+
+	return write<string>(sink, args...);
+}
+
+/**
+ * 	@brief Formats to a buffer, the compile-time equivalent of str_utils_format(). The output is always
+ * 	null terminated when size is not zero, and truncated if it does not fit.
+ *
+ * 	@return int the length of the untruncated output
+ */
+template <Literal string, typename... Args>
+inline int
+format(char *  buf, std::size_t size, const Args &... args)
+{
+	BufferSink sink {buf, size, 0};
+	int	   len = write<string>(sink, args...);
+
+	if (size != 0)
+	{
+		buf[sink.pos] = '\0';
+	}
+
+	return len;
+}
+
+} /* namespace fmt */
+
+#endif
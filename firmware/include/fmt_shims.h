@@ -0,0 +1,100 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#ifndef __FMT_SHIMS_H
+#define __FMT_SHIMS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	C entry points for formats compiled by fmt.h.
+ *
+ * 	Each SHIM(name, format, argument types...) entry of FMT_SHIMS generates, in src/fmt_shims.cpp:
+ * 		int name(arguments...);					prints to the UART, like uart_printf()
+ * 		int name_format(char *buf, size_t size, arguments...);	formats to a buffer, like str_utils_format()
+ * 	The argument types are checked against the format when src/fmt_shims.cpp is compiled, so a mismatch
+ * 	fails the build. An entry takes 1 to 8 arguments. Unused entries are removed by the linker.
+ */
+#define FMT_SHIMS(SHIM)                                                                                  \
+	SHIM(fmt_trace_event, "trace: %x %x %x\n", uint32_t, uint32_t, uint32_t)                         \
+	FMT_SHIMS_EXTRA(SHIM)
+
+/*
+ * 	Entries added by a build, e.g. a benchmark, which defines FMT_SHIMS_EXTRA(SHIM) before including
+ * 	fmt_shims.h, e.g. with -include, so that they are not part of every firmware.
+ */
+#ifndef FMT_SHIMS_EXTRA
+	#define FMT_SHIMS_EXTRA(SHIM)
+#endif
+
+/*
+ * 	Parameter lists a0 to a7 of the shims, selected by the number of argument types.
+ */
+#define FMT_SHIM_COUNT(...)					FMT_SHIM_COUNT_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define FMT_SHIM_COUNT_(t0, t1, t2, t3, t4, t5, t6, t7, n, ...)	n
+#define FMT_SHIM_CONCAT(a, b)					FMT_SHIM_CONCAT_(a, b)
+#define FMT_SHIM_CONCAT_(a, b)					a##b
+
+#define FMT_SHIM_PARAMETERS(...)	FMT_SHIM_CONCAT(FMT_SHIM_PARAMETERS_, FMT_SHIM_COUNT(__VA_ARGS__))(__VA_ARGS__)
+#define FMT_SHIM_PARAMETERS_1(t0)	t0 a0
+#define FMT_SHIM_PARAMETERS_2(t0, t1)	t0 a0, t1 a1
+#define FMT_SHIM_PARAMETERS_3(t0, t1, t2) \
+	t0 a0, t1 a1, t2 a2
+#define FMT_SHIM_PARAMETERS_4(t0, t1, t2, t3) \
+	t0 a0, t1 a1, t2 a2, t3 a3
+#define FMT_SHIM_PARAMETERS_5(t0, t1, t2, t3, t4) \
+	t0 a0, t1 a1, t2 a2, t3 a3, t4 a4
+#define FMT_SHIM_PARAMETERS_6(t0, t1, t2, t3, t4, t5) \
+	t0 a0, t1 a1, t2 a2, t3 a3, t4 a4, t5 a5
+#define FMT_SHIM_PARAMETERS_7(t0, t1, t2, t3, t4, t5, t6) \
+	t0 a0, t1 a1, t2 a2, t3 a3, t4 a4, t5 a5, t6 a6
+#define FMT_SHIM_PARAMETERS_8(t0, t1, t2, t3, t4, t5, t6, t7)                                            \
+	t0 a0, t1 a1, t2 a2, t3 a3, t4 a4, t5 a5, t6 a6, t7 a7
+
+#define FMT_SHIM_ARGUMENTS(...)	FMT_SHIM_CONCAT(FMT_SHIM_ARGUMENTS_, FMT_SHIM_COUNT(__VA_ARGS__))
+#define FMT_SHIM_ARGUMENTS_1	a0
+#define FMT_SHIM_ARGUMENTS_2	a0, a1
+#define FMT_SHIM_ARGUMENTS_3	a0, a1, a2
+#define FMT_SHIM_ARGUMENTS_4	a0, a1, a2, a3
+#define FMT_SHIM_ARGUMENTS_5	a0, a1, a2, a3, a4
+#define FMT_SHIM_ARGUMENTS_6	a0, a1, a2, a3, a4, a5
+#define FMT_SHIM_ARGUMENTS_7	a0, a1, a2, a3, a4, a5, a6
+#define FMT_SHIM_ARGUMENTS_8	a0, a1, a2, a3, a4, a5, a6, a7
+
+#define FMT_SHIM_DECLARE(name, string, ...)                                                              \
+	int name(FMT_SHIM_PARAMETERS(__VA_ARGS__));                                                      \
+	int name##_format(char *  buf, size_t size, FMT_SHIM_PARAMETERS(__VA_ARGS__));
+
+FMT_SHIMS(FMT_SHIM_DECLARE)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -25,11 +25,64 @@
 #define __LEDS_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef enum LEDS_CONF_enum
+{
+	/*
+	 * 	Pattern generator ticks per millisecond. The timebase is the iCE40 10kHz low frequency
+	 * 	oscillator, which is only accurate to a few percent.
+	 */
+	kLEDS_CONF_TICKS_PER_MS	= 10,
+
+	/*
+	 * 	The longest period, duty and phase, in milliseconds (16-bit tick counters).
+	 */
+	kLEDS_CONF_MAX_MS	= 0xffff / kLEDS_CONF_TICKS_PER_MS,
+} LEDS_CONF;
+
+typedef enum
+{
+	kLedsRed	= 0,
+	kLedsGreen	= 1,
+} LedsLed;
+
+typedef enum
+{
+	/*
+	 * 	The LED follows leds_red_on()/leds_green_on() and friends.
+	 */
+	kLedsModeStatic		= 0,
+
+	/*
+	 * 	The LED follows its pattern, set by leds_set_pattern().
+	 */
+	kLedsModePattern	= 1,
+
+	/*
+	 * 	The LED is on whenever the other LED's pattern is off.
+	 */
+	kLedsModeAlternate	= 2,
+} LedsMode;
+
+/**
+ * 	@brief A hardware blink pattern. The LED is on for the first on_ms of every period_ms, repeated
+ * 	burst_count times and followed by burst_gap periods off. A burst_count of 0 repeats the period
+ * 	continuously. After leds_restart_patterns(), the pattern starts phase_ms into its period.
+ */
+typedef struct
+{
+	uint32_t	period_ms;
+	uint32_t	on_ms;
+	uint32_t	phase_ms;
+	uint8_t		burst_count;
+	uint8_t		burst_gap;
+} LedsPattern;
+
 /**
  * 	@brief Turns on the Red LED.
  */
@@ -74,6 +127,65 @@ void leds_init(void);
  */
 void leds_toggle(void);
 
+/**
+ * 	@brief Returns true if the gateware has the LED pattern generators. Without them, the pattern
+ * 	functions below do nothing, and the LEDs only have the static mode.
+ */
+bool leds_pattern_supported(void);
+
+/**
+ * 	@brief Sets the LED's mode.
+ *
+ * 	@param led is the LED
+ * 	@param mode is the source of the LED's state
+ */
+void leds_set_mode(LedsLed led, LedsMode mode);
+
+/**
+ * 	@brief Sets the LED's pattern, and switches it to kLedsModePattern. Times are rounded down to
+ * 	0.1ms, and clamped to kLEDS_CONF_MAX_MS.
+ *
+ * 	@param led is the LED
+ * 	@param pattern is the pattern
+ */
+void leds_set_pattern(LedsLed led, const LedsPattern *  pattern);
+
+/**
+ * 	@brief Sets the LED's brightness, as a PWM duty cycle, in all modes.
+ *
+ * 	@param led is the LED
+ * 	@param brightness is the duty cycle, from 0 (off) to 255 (fully on)
+ */
+void leds_set_brightness(LedsLed led, uint8_t brightness);
+
+/**
+ * 	@brief Restarts both patterns at their phase, e.g. to align them after setting them.
+ */
+void leds_restart_patterns(void);
+
+/**
+ * 	@brief Blinks the red and the green LED in turn, each for period_ms, as leds_toggle() does
+ * 	when called every period_ms, but with no firmware involvement.
+ *
+ * 	@param period_ms is the time each LED stays on
+ */
+void leds_alternate(uint32_t period_ms);
+
+/**
+ * 	@brief Flashes the LED for 50ms every second, to show that the system is alive.
+ *
+ * 	@param led is the LED
+ */
+void leds_heartbeat(LedsLed led);
+
+/**
+ * 	@brief Blinks the LED code times, 200ms on and 200ms off, followed by 1.6s off, repeatedly.
+ *
+ * 	@param led is the LED
+ * 	@param code is the number of blinks, from 1 to 255
+ */
+void leds_status_code(LedsLed led, uint8_t code);
+
 #ifdef __cplusplus
 }
 #endif
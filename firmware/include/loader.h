@@ -0,0 +1,94 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __LOADER_H
+#define __LOADER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Flash-to-SRAM boot (BOOT_MODE=sram).
+ *
+ * 	The loader (firmware/loader/) executes in place from the reset address, and
+ * 	the application image follows it in the SPI flash, after LOADER_SIZE bytes
+ * 	(see the firmware Makefile):
+ *
+ * 	ROM_BASE                          loader
+ * 	ROM_BASE + LOADER_SIZE            LoaderHeader
+ * 	ROM_BASE + LOADER_SIZE + header   image, copied to load_address
+ *
+ * 	firmware/tools/mkimage.py writes the header, and must be kept in sync with it.
+ */
+typedef enum LOADER_CONF_enum
+{
+	/*
+	 * 	"C0LD", little-endian.
+	 */
+	kLOADER_CONF_MAGIC = 0x444c3043,
+
+	/*
+	 * 	Bytes at the top of SRAM used by the loader stack, which the image must not overlap.
+	 */
+	kLOADER_CONF_STACK_SIZE = 512,
+} LOADER_CONF;
+
+/**
+ * 	@brief Application image header. All fields are little-endian.
+ */
+typedef struct
+{
+	/*
+	 * 	kLOADER_CONF_MAGIC.
+	 */
+	uint32_t magic;
+
+	/*
+	 * 	SRAM address the image is copied to. Word aligned.
+	 */
+	uint32_t load_address;
+
+	/*
+	 * 	Image length in bytes, a multiple of 4.
+	 */
+	uint32_t length;
+
+	/*
+	 * 	Address the loader jumps to, inside the image.
+	 */
+	uint32_t entry;
+
+	/*
+	 * 	CRC-32 (IEEE 802.3, as zlib.crc32()) of the image.
+	 */
+	uint32_t crc32;
+} LoaderHeader;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
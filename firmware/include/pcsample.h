@@ -0,0 +1,103 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#ifndef __PCSAMPLE_H
+#define __PCSAMPLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Program counter sampling.
+ *
+ * 	Each timer0 tick interrupt (timers.h, every 1ms) records the address the
+ * 	CPU was interrupted at, in a histogram of the code executing in place from
+ * 	flash, i.e. from _ftext to _etext, in buckets of 2^shift bytes. Samples of
+ * 	code in SRAM (RAMFUNC), including the scheduler's idle loop, are only
+ * 	counted, since they do not fetch from flash. Interrupt handlers are never
+ * 	sampled, since they run with interrupts disabled.
+ *
+ * 	pcsample_dump() prints the histogram over the UART, from which
+ * 	tools/layout.py generates the section-ordering file that places the hot
+ * 	functions together at the start of .text (see the firmware README):
+ *
+ * 	pcsample_start();
+ * 	... run the workload ...
+ * 	pcsample_stop();
+ * 	pcsample_dump();
+ *
+ * 	The timer0 interrupt only samples in firmware built with PCSAMPLE=1. The
+ * 	default, PCSAMPLE=0, defines CONFIG_PCSAMPLE_DISABLE, which leaves the
+ * 	sampling, and its kPCSAMPLE_CONF_BUCKETS words of SRAM, out.
+ */
+
+typedef enum PCSAMPLE_CONF_enum
+{
+	/*
+	 * 	Histogram buckets. The bucket size is the smallest power of two that
+	 * 	covers the code in flash with this many buckets.
+	 */
+	kPCSAMPLE_CONF_BUCKETS		= 512,
+
+	/*
+	 * 	Smallest bucket size, as a power of two, i.e. one instruction.
+	 */
+	kPCSAMPLE_CONF_MIN_SHIFT	= 2,
+} PCSAMPLE_CONF;
+
+/**
+ * 	@brief Clears the histogram, and starts sampling.
+ */
+void pcsample_start(void);
+
+/**
+ * 	@brief Stops sampling. The histogram is kept until the next pcsample_start().
+ */
+void pcsample_stop(void);
+
+/**
+ * 	@brief Records the interrupted program counter, if sampling. Called by the timer0 interrupt.
+ */
+void pcsample_tick(void);
+
+/**
+ * 	@brief Returns the number of samples taken since pcsample_start().
+ */
+uint32_t pcsample_count(void);
+
+/**
+ * 	@brief Prints the histogram over the UART, for tools/layout.py: the histogram base and bucket
+ * 	size, one line per non-empty bucket, and the number of samples outside the code in flash.
+ */
+void pcsample_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#ifndef __PERF_COUNTERS_H
+#define __PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	CPU bus performance counters.
+ *
+ * 	The gateware's performance counters (PERF_COUNTERS=1 in config.mk) count the
+ * 	system clock cycles and, for each region of the CPU's instruction and data
+ * 	buses, the Wishbone transactions and wait states, so that a slowdown can be
+ * 	attributed to flash fetches (execute in place), SRAM, or CSR accesses:
+ *
+ * 	PerfCounters start;
+ * 	PerfCounters end;
+ *
+ * 	perf_counters_snapshot(&start);
+ * 	...
+ * 	perf_counters_snapshot(&end);
+ * 	perf_counters_diff(&start, &end, &end);
+ * 	perf_counters_print("foo", &end);
+ *
+ * 	Wait states are counted per bus, so the waits of a region can exceed its
+ * 	cycles when both buses wait at once. The counters are 32-bit, so intervals
+ * 	must be shorter than 2^32 cycles (358s at 12MHz).
+ */
+
+/**
+ * 	@brief Counters of one bus region.
+ */
+typedef struct
+{
+	uint32_t	accesses;
+	uint32_t	waits;
+} PerfCountersRegion;
+
+/**
+ * 	@brief A snapshot of the counters, or the difference of two snapshots.
+ */
+typedef struct
+{
+	uint32_t		cycles;
+	PerfCountersRegion	flash;
+	PerfCountersRegion	sram;
+	PerfCountersRegion	csr;
+} PerfCounters;
+
+/**
+ * 	@brief Returns true if the gateware has the performance counters. Without them, snapshots are all zeros.
+ */
+bool perf_counters_supported(void);
+
+/**
+ * 	@brief Enables and clears the counters, and measures the counts of taking a snapshot, which
+ * 	perf_counters_diff() subtracts. Call once at startup.
+ */
+void perf_counters_init(void);
+
+/**
+ * 	@brief Clears the counters.
+ */
+void perf_counters_reset(void);
+
+/**
+ * 	@brief Starts or stops the counters, e.g. to only count a region of code over many runs.
+ *
+ * 	@param enable is true to count, false to hold the counters
+ */
+void perf_counters_enable(bool enable);
+
+/**
+ * 	@brief Latches all the counters at once, and reads them.
+ *
+ * 	@param snapshot is the destination
+ */
+void perf_counters_snapshot(PerfCounters *  snapshot);
+
+/**
+ * 	@brief Computes end - start, minus the counts of taking a snapshot. diff may alias start or end.
+ *
+ * 	@param start is the earlier snapshot
+ * 	@param end is the later snapshot
+ * 	@param diff is the destination
+ */
+void perf_counters_diff(const PerfCounters *  start, const PerfCounters *  end, PerfCounters *  diff);
+
+/**
+ * 	@brief Prints the counters over the UART, with the wait states as a percentage of the cycles.
+ *
+ * 	@param name is the name to print them under
+ * 	@param counters is the snapshot or difference to print
+ */
+void perf_counters_print(const char *  name, const PerfCounters *  counters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Cycle profiling.
+ *
+ * 	Regions are timed with timer0's free-running 64-bit uptime counter, which
+ * 	counts system clock cycles independently of timer0's countdown, so that
+ * 	profiling does not disturb an application using timer0, in any mode. The
+ * 	VexRiscv lite core does not implement the cycle CSRs (rdcycle/rdcycleh).
+ *
+ * 	A region accumulates the count, minimum, maximum and total of its samples,
+ * 	minus the cost of taking a sample, as measured by profile_init(). Regions
+ * 	register themselves on their first sample, and profile_dump() prints all
+ * 	registered regions over the UART:
+ *
+ * 	void
+ * 	foo(void)
+ * 	{
+ * 		PROFILE_SCOPE("foo");
+ * 		...
+ * 	}
+ *
+ * 	or, for a region which is not a C scope:
+ *
+ * 	PROFILE_REGION(bar_region, "bar");
+ * 	uint64_t start = profile_now();
+ * 	...
+ * 	profile_stop(&bar_region, start);
+ */
+
+/**
+ * 	@brief Profiled region accumulators. Define with PROFILE_REGION().
+ */
+typedef struct ProfileRegion
+{
+	const char *		name;
+	uint32_t		count;
+	uint32_t		min;
+	uint32_t		max;
+	uint64_t		total;
+	bool			registered;
+	struct ProfileRegion *	next;
+} ProfileRegion;
+
+/**
+ * 	@brief Defines a static ProfileRegion called var, named name in the dump.
+ */
+#define PROFILE_REGION(var, region_name) \
+	static ProfileRegion var = {.name = (region_name), .min = UINT32_MAX}
+
+/**
+ * 	@brief Profiles the rest of the enclosing C scope, as a region named name.
+ * 	The sample is taken when the scope exits, including through return or break.
+ */
+#define PROFILE_SCOPE(region_name) PROFILE_SCOPE_(region_name, __COUNTER__)
+#define PROFILE_SCOPE_(region_name, id) PROFILE_SCOPE__(region_name, id)
+#define PROFILE_SCOPE__(region_name, id)                                    \
+	PROFILE_REGION(profile_region_##id, region_name);                   \
+	ProfileScope profile_scope_##id __attribute__((cleanup(profile_scope_exit))) \
+		= {&profile_region_##id, profile_now()}
+
+/**
+ * 	@brief A running PROFILE_SCOPE() sample.
+ */
+typedef struct
+{
+	ProfileRegion *	region;
+	uint64_t	start;
+} ProfileScope;
+
+/**
+ * 	@brief Returns the current cycle count, to pass to profile_stop().
+ */
+static inline uint64_t
+profile_now(void)
+{
+	return timer0_get_uptime_cycles();
+}
+
+/**
+ * 	@brief Measures the cost of taking a sample, which is subtracted from every sample taken afterwards.
+ * 	Call once at startup, before profiling.
+ */
+void profile_init(void);
+
+/**
+ * 	@brief Adds the cycles since start to region. Safe to call from interrupt handlers.
+ *
+ * 	@param region is the region to add the sample to
+ * 	@param start is the profile_now() value at the start of the region
+ */
+void profile_stop(ProfileRegion *  region, uint64_t start);
+
+/**
+ * 	@brief PROFILE_SCOPE() cleanup handler.
+ */
+void profile_scope_exit(ProfileScope *  scope);
+
+/**
+ * 	@brief Clears the accumulators of every registered region.
+ */
+void profile_reset(void);
+
+/**
+ * 	@brief Prints one line per registered region over the UART: name, count, and min/mean/max/total cycles.
+ */
+void profile_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __PROTO_H
+#define __PROTO_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Framed binary protocol over the UART.
+ *
+ * 	The host sends request frames, and the device answers each with a response
+ * 	frame. Before framing, a request is a sequence number, a command id, the
+ * 	payload, and the CRC-16 (crc16.h) of the preceding bytes, little-endian.
+ * 	A response is the same, with a ProtoStatus instead of the command id. The
+ * 	frame is then COBS-encoded (cobs.h), and terminated by a zero byte.
+ *
+ * 	The host may send up to kPROTO_CONF_WINDOW requests before waiting for
+ * 	their responses. Requests are executed in sequence order, exactly once:
+ * 	a request with an unexpected sequence number, e.g. after a corrupted frame
+ * 	was dropped, is ignored, and the host resends every request from the first
+ * 	one without a response (go-back-N). A resent request which was already
+ * 	executed gets its cached response again. kProtoCommandSync sets the next
+ * 	expected sequence number, whatever it was.
+ *
+ * 	Commands with ids from kProtoCommandUser are dispatched to the handlers
+ * 	passed to proto_init(). tools/c0link.py implements the host side.
+ */
+
+typedef enum PROTO_CONF_enum
+{
+	/*
+	 * 	Maximum request and response payload, so that a frame fits in one COBS block.
+	 */
+	kPROTO_CONF_MAX_PAYLOAD	= 240,
+
+	/*
+	 * 	Sequence number, command id or status, and CRC-16.
+	 */
+	kPROTO_CONF_OVERHEAD	= 4,
+	kPROTO_CONF_FRAME_MAX	= kPROTO_CONF_MAX_PAYLOAD + kPROTO_CONF_OVERHEAD,
+
+	/*
+	 * 	Number of requests the host may send ahead, and of responses cached for resending.
+	 */
+	kPROTO_CONF_WINDOW	= 4,
+
+	kPROTO_CONF_VERSION	= 1,
+} PROTO_CONF;
+
+typedef enum
+{
+	kProtoStatusOk			= 0,
+	kProtoStatusUnknownCommand	= 1,
+	kProtoStatusBadRequest		= 2,
+	kProtoStatusError		= 3,
+} ProtoStatus;
+
+typedef enum
+{
+	/*
+	 * 	Resets the sequence numbers to the request's. Empty response.
+	 */
+	kProtoCommandSync	= 0x00,
+
+	/*
+	 * 	Responds with the protocol version, the window, and the maximum payload (16-bit).
+	 */
+	kProtoCommandInfo	= 0x01,
+
+	/*
+	 * 	Responds with the request payload.
+	 */
+	kProtoCommandEcho	= 0x02,
+
+	/*
+	 * 	First id available to proto_init() handlers.
+	 */
+	kProtoCommandUser	= 0x10,
+} ProtoCommandId;
+
+/**
+ * 	@brief Command handler. Runs in the context of proto_poll().
+ *
+ * 	@param request is the request payload
+ * 	@param request_len is the length of the request payload
+ * 	@param response is where to write the response payload
+ * 	@param response_max is the size of response, kPROTO_CONF_MAX_PAYLOAD
+ * 	@return int32_t the response payload length, or a negative ProtoStatus
+ */
+typedef int32_t (*ProtoHandler)(const uint8_t *  request, uint32_t request_len, uint8_t *  response, uint32_t response_max);
+
+/**
+ * 	@brief Dispatch table entry.
+ */
+typedef struct
+{
+	uint8_t		id;
+	ProtoHandler	handler;
+} ProtoCommand;
+
+/**
+ * 	@brief Protocol counters, see proto_get_stats().
+ */
+typedef struct
+{
+	uint32_t frames_rx;
+	uint32_t frames_tx;
+
+	/*
+	 * 	Frames dropped because of a CRC mismatch, or of invalid COBS or length.
+	 */
+	uint32_t crc_errors;
+	uint32_t framing_errors;
+
+	/*
+	 * 	Requests answered from the response cache, and requests ignored because out of sequence.
+	 */
+	uint32_t duplicates;
+	uint32_t out_of_order;
+} ProtoStats;
+
+/**
+ * 	@brief Initializes the protocol, with a dispatch table for the commands from kProtoCommandUser.
+ *
+ * 	@param commands is the dispatch table, which must stay allocated, or NULL
+ * 	@param count is the number of entries in commands
+ */
+void proto_init(const ProtoCommand *  commands, uint32_t count);
+
+/**
+ * 	@brief Reads the received UART bytes, and executes and answers every complete request.
+ * 	Call it when bytes are received, e.g. from a task posted by the UART RX callback (uart_set_rx_callback()).
+ *
+ * 	@return uint32_t the number of frames received
+ */
+uint32_t proto_poll(void);
+
+/**
+ * 	@brief Copies the protocol counters.
+ *
+ * 	@param stats is the destination
+ */
+void proto_get_stats(ProtoStats *  stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __RAMFUNC_H
+#define __RAMFUNC_H
+
+/*
+ * 	Code placement in SRAM.
+ *
+ * 	By default all code executes in place from the SPI flash, which is read one
+ * 	bit per clock. Functions marked RAMFUNC are placed in the .ramtext section
+ * 	instead, which linker.ld collects into .data: crt0 copies them to SPRAM at
+ * 	boot, together with the initialized data, and they execute from there.
+ *
+ * 	Each function gets its own .ramtext.<n> input section, numbered with
+ * 	__COUNTER__ since a section attribute cannot name the function, so that
+ * 	--gc-sections still drops the unused ones instead of copying them to SRAM.
+ * 	RAMFUNC functions can be inlined into their callers like any other.
+ *
+ * 	RAMDATA does the same for read-only lookup tables used by RAMFUNC code, so
+ * 	that their loads do not go to the flash either. It must only be used on const
+ * 	objects: writable objects are in SRAM already, and mixing the two in the same
+ * 	section is a section type conflict.
+ *
+ * 	Building with RAMFUNC=0 defines CONFIG_RAMFUNC_DISABLE, and leaves everything
+ * 	in flash. This is useful to compare the two placements.
+ *
+ * 	RAMFUNC_REQUIRED is for code that must never execute from flash, e.g. code
+ * 	that sends commands to the flash. It is not affected by RAMFUNC=0, and is
+ * 	also noinline, so that it is not inlined into a caller in flash.
+ *
+ * 	Example:
+ * 	RAMFUNC void
+ * 	isr(void)
+ * 	{
+ * 		...
+ * 	}
+ */
+
+#define RAMFUNC_SECTION_NAME(n)	__attribute__((section(".ramtext." #n)))
+#define RAMFUNC_SECTION(n)	RAMFUNC_SECTION_NAME(n)
+
+#define RAMFUNC_REQUIRED RAMFUNC_SECTION(__COUNTER__) __attribute__((noinline))
+
+#ifdef CONFIG_RAMFUNC_DISABLE
+	#define RAMFUNC
+	#define RAMDATA
+#else
+	#define RAMFUNC RAMFUNC_SECTION(__COUNTER__)
+	#define RAMDATA __attribute__((section(".data.ramdata")))
+#endif
+
+#endif
@@ -0,0 +1,210 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#ifndef __ROMFS_H
+#define __ROMFS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Read-only file image, in the SPI flash after the firmware.
+ *
+ * 	firmware/tools/mkromfs.py packs a directory into an image, and must be kept
+ * 	in sync with it. The image is flashed at ROMFS_OFFSET in the rom region
+ * 	(see the firmware Makefile), and its files are read in place, through the
+ * 	memory-mapped flash:
+ *
+ * 	offset 0                          RomfsHeader
+ * 	sizeof(RomfsHeader)               RomfsEntry[count], sorted by hash and name
+ * 	...                               file names, NUL-terminated
+ * 	sizeof(RomfsHeader) + directory   file data, each aligned to the image alignment
+ *
+ * 	romfs_open() finds a file with a binary search of the entries by the
+ * 	FNV-1a hash of its name, and only compares the names of entries with the
+ * 	same hash:
+ *
+ * 	const RomfsHeader *  image = romfs_mount(ROMFS_FLASH_ADDRESS, ROMFS_FLASH_SIZE);
+ * 	RomfsFile file;
+ *
+ * 	if ((image != NULL) && romfs_open(image, "coefficients.bin", &file))
+ * 	{
+ * 		const int16_t *  coefficients = file.data;
+ * 		...
+ * 	}
+ */
+typedef enum ROMFS_CONF_enum
+{
+	/*
+	 * 	"C0FS", little-endian.
+	 */
+	kROMFS_CONF_MAGIC = 0x53463043,
+
+	kROMFS_CONF_VERSION = 1,
+
+	/*
+	 * 	FNV-1a 32-bit offset basis and prime.
+	 */
+	kROMFS_CONF_HASH_BASIS = 0x811c9dc5,
+	kROMFS_CONF_HASH_PRIME = 0x01000193,
+} ROMFS_CONF;
+
+/**
+ * 	@brief Image header. All fields are little-endian.
+ */
+typedef struct
+{
+	/*
+	 * 	kROMFS_CONF_MAGIC.
+	 */
+	uint32_t magic;
+
+	/*
+	 * 	kROMFS_CONF_VERSION.
+	 */
+	uint16_t version;
+
+	/*
+	 * 	CRC-16/CCITT-FALSE (as crc16_update()) of the directory: the entries and the names.
+	 */
+	uint16_t crc16;
+
+	/*
+	 * 	Number of files.
+	 */
+	uint32_t count;
+
+	/*
+	 * 	Bytes of the entries and the names, which follow the header.
+	 */
+	uint32_t directory_size;
+
+	/*
+	 * 	Bytes of the whole image.
+	 */
+	uint32_t size;
+} RomfsHeader;
+
+/**
+ * 	@brief Directory entry of a file. Offsets are from the start of the image.
+ */
+typedef struct
+{
+	/*
+	 * 	FNV-1a hash of the name.
+	 */
+	uint32_t hash;
+
+	/*
+	 * 	Offset of the name.
+	 */
+	uint32_t name;
+
+	/*
+	 * 	Offset of the data, a multiple of the image alignment.
+	 */
+	uint32_t offset;
+
+	/*
+	 * 	Bytes of data.
+	 */
+	uint32_t size;
+
+	/*
+	 * 	CRC-16/CCITT-FALSE of the data.
+	 */
+	uint16_t crc16;
+
+	/*
+	 * 	Length of the name, without the NUL.
+	 */
+	uint16_t name_length;
+} RomfsEntry;
+
+/**
+ * 	@brief A file, as found by romfs_open() or romfs_file_at().
+ */
+typedef struct
+{
+	const char *	name;
+	const void *	data;
+	uint32_t	size;
+	uint16_t	crc16;
+} RomfsFile;
+
+/*
+ * 	Address of the image flashed by `make flash-romfs`, and the rest of the rom region after it, which
+ * 	bounds the image. Need generated/mem.h.
+ */
+#ifdef CONFIG_ROMFS_OFFSET
+#define ROMFS_FLASH_ADDRESS	((const void *)(ROM_BASE + CONFIG_ROMFS_OFFSET))
+#define ROMFS_FLASH_SIZE	((uint32_t)(ROM_SIZE - CONFIG_ROMFS_OFFSET))
+#endif
+
+/**
+ * 	@brief Checks the header, the bounds and the directory CRC of an image.
+ *
+ * 	@param address is the start of the image, e.g. ROMFS_FLASH_ADDRESS
+ * 	@param max_size is the number of bytes readable from address, e.g. ROMFS_FLASH_SIZE
+ * 	@return const RomfsHeader* the image, or NULL if there is no valid image at address
+ */
+const RomfsHeader *romfs_mount(const void *  address, uint32_t max_size);
+
+/**
+ * 	@brief Finds a file by name, in O(log count).
+ *
+ * 	@param image is a mounted image
+ * 	@param name is the file name, as given to tools/mkromfs.py, e.g. "sub/dir/file.bin"
+ * 	@param file is filled in when the file is found
+ * 	@return true if the file was found
+ */
+bool romfs_open(const RomfsHeader *  image, const char *  name, RomfsFile *  file);
+
+/**
+ * 	@brief Gets the file at an index of the directory, to list the image. The files are in hash order.
+ *
+ * 	@param image is a mounted image
+ * 	@param index is below image->count
+ * 	@param file is filled in when index is valid
+ * 	@return true if index is valid
+ */
+bool romfs_file_at(const RomfsHeader *  image, uint32_t index, RomfsFile *  file);
+
+/**
+ * 	@brief Checks the data of a file against its CRC. Reads the whole file from flash.
+ *
+ * 	@param file is a file found by romfs_open() or romfs_file_at()
+ * 	@return true if the data matches
+ */
+bool romfs_verify(const RomfsFile *  file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __SCHED_H
+#define __SCHED_H
+
+#include <stdint.h>
+#include "profile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Run-to-completion scheduler.
+ *
+ * 	Every task has a unique priority, its bit in a ready mask. Interrupt handlers
+ * 	(or other tasks) post a task with sched_post(), and sched_run() repeatedly
+ * 	runs the highest priority ready task, to completion. Posting a task which is
+ * 	already ready does nothing, so a task must handle everything that is pending
+ * 	when it runs, e.g. read all received UART bytes. When no task is ready, the
+ * 	core waits for the next interrupt with wfi, after sending the pending trace
+ * 	events (trace.h), kSCHED_CONF_TRACE_BATCH at a time, checking for ready
+ * 	tasks in between.
+ *
+ * 	sched_run() measures, per task, the latency from the first sched_post() to
+ * 	the start of the task, as a profile.h region named after the task, and the
+ * 	time spent idle.
+ */
+
+typedef enum SCHED_CONF_enum
+{
+	/*
+	 * 	Number of priorities, i.e. the maximum number of tasks.
+	 */
+	kSCHED_CONF_PRIORITIES = 32,
+
+	/*
+	 * 	Trace events sent per batch when idle.
+	 */
+	kSCHED_CONF_TRACE_BATCH = 16,
+} SCHED_CONF;
+
+typedef void (*SchedTaskFn)(void *  ctx);
+
+/**
+ * 	@brief A task. Initialize with sched_task_init().
+ */
+typedef struct
+{
+	SchedTaskFn	fn;
+	void *		ctx;
+	uint32_t	priority;
+
+	/*
+	 * 	profile_now() at the first sched_post() since the task last ran.
+	 */
+	uint64_t	posted_at;
+
+	/*
+	 * 	Post-to-run latency, in cycles, named after the task.
+	 */
+	ProfileRegion	latency;
+} SchedTask;
+
+/**
+ * 	@brief Scheduler counters, see sched_get_stats().
+ */
+typedef struct
+{
+	/*
+	 * 	Cycles since sched_run() started.
+	 */
+	uint64_t total_cycles;
+
+	/*
+	 * 	Cycles spent waiting for interrupts, with no task ready.
+	 */
+	uint64_t idle_cycles;
+
+	/*
+	 * 	Number of tasks run.
+	 */
+	uint32_t runs;
+} SchedStats;
+
+/**
+ * 	@brief Initializes a task, and registers it with the scheduler.
+ *
+ * 	@param task is the task, which must stay allocated
+ * 	@param priority is the task priority, unique, 0 being the highest, below kSCHED_CONF_PRIORITIES
+ * 	@param name is the task name, used for its latency profile region
+ * 	@param fn is the task function
+ * 	@param ctx is passed to the task function
+ */
+void sched_task_init(SchedTask *  task, uint32_t priority, const char *  name, SchedTaskFn fn, void *  ctx);
+
+/**
+ * 	@brief Makes a task ready to run. Safe to call from interrupt handlers.
+ */
+void sched_post(SchedTask *  task);
+
+/**
+ * 	@brief Runs the ready tasks, highest priority first, and waits for interrupts when none is ready. Never returns.
+ * 	Interrupts must be set up before, but are enabled by sched_run().
+ */
+void sched_run(void) __attribute__((noreturn));
+
+/**
+ * 	@brief Returns a consistent snapshot of the scheduler counters.
+ */
+void sched_get_stats(SchedStats *  stats);
+
+/**
+ * 	@brief Prints the idle CPU percentage, and the per-task latencies (profile_dump()), over the UART.
+ */
+void sched_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __SPIFLASH_H
+#define __SPIFLASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+	kSpiFlashCmdWriteEnable		= 0x06,
+	kSpiFlashCmdReadStatus1		= 0x05,
+	kSpiFlashCmdReadStatus2		= 0x35,
+	kSpiFlashCmdWriteStatus2	= 0x31,
+} SpiFlashCmd;
+
+typedef enum
+{
+	/*
+	 * 	Status register 1: write in progress
+	 */
+	kSpiFlashStatus1Busy = 0x01,
+
+	/*
+	 * 	Status register 2: Quad Enable, turns the WP/HOLD pins into IO2/IO3
+	 */
+	kSpiFlashStatus2QuadEnable = 0x02,
+} SpiFlashStatus;
+
+/**
+ * 	@brief Returns true if the gateware includes the LiteSPI master interface, which is needed to send commands
+ * 	to the flash. It is included for every --spi-flash-mode other than 1x.
+ */
+bool spiflash_has_master(void);
+
+/**
+ * 	@brief Reads a flash status register.
+ *
+ * 	@param cmd is kSpiFlashCmdReadStatus1 or kSpiFlashCmdReadStatus2
+ * 	@return uint8_t the status register value, or 0 without the master interface
+ */
+uint8_t spiflash_read_status(SpiFlashCmd cmd);
+
+/**
+ * 	@brief Sets the non-volatile Quad Enable bit of the flash, if it is not already set.
+ * 	With the bit set, the flash ignores its WP/HOLD pins, which the dual and quad read modes drive as data pins.
+ *
+ * 	The AT25QL128A ships with the bit set. If it has been cleared, a 4x bitstream cannot fetch the firmware
+ * 	from flash, so call this once from a 1x-fast or 2x build to set it again.
+ *
+ * 	@return true if the bit is set when this returns
+ */
+bool spiflash_quad_enable(void);
+
+/**
+ * 	@brief Configures the flash for the --spi-flash-mode the gateware was built with.
+ * 	For the dual and quad modes, makes sure that the Quad Enable bit is set, so that the WP/HOLD pins do not
+ * 	interfere with reads. Does nothing without the master interface, i.e. in 1x mode.
+ */
+void spiflash_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
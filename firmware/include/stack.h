@@ -0,0 +1,108 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#ifndef __STACK_H
+#define __STACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Stack usage measurement.
+ *
+ * 	The stack grows down from the top of the SRAM (_fstack), towards the end
+ * 	of .bss (_ebss). stack_paint() fills the unused stack with a known word,
+ * 	and stack_high_water() finds the lowest word overwritten since, i.e. the
+ * 	deepest the stack has been, including in interrupt handlers. Call
+ * 	stack_paint() first thing in main():
+ *
+ * 	int
+ * 	main(void)
+ * 	{
+ * 		stack_paint();
+ * 		...
+ * 		uart_printf("stack: %u of %u bytes used\n", stack_high_water(), stack_size());
+ * 	}
+ *
+ * 	The allocator (alloc.h) hands out the SRAM below the stack reserve, so
+ * 	alloc_init() moves the bottom of the measured stack up to the end of its
+ * 	arena, with stack_set_bottom().
+ */
+
+typedef enum STACK_CONF_enum
+{
+	/*
+	 * 	Word written over the unused stack.
+	 */
+	kSTACK_CONF_PAINT		= 0x5a5a5a5a,
+
+	/*
+	 * 	Bytes below the caller's frame that stack_paint() leaves alone, for its own use.
+	 */
+	kSTACK_CONF_PAINT_MARGIN	= 64,
+} STACK_CONF;
+
+/**
+ * 	@brief Fills the stack, from its bottom to just below the caller's frame, with kSTACK_CONF_PAINT.
+ */
+void stack_paint(void);
+
+/**
+ * 	@brief Sets the lowest address the stack may grow down to. Only the stack above it is measured.
+ *
+ * 	@param bottom is the new bottom of the stack, between _ebss and _fstack
+ */
+void stack_set_bottom(void *  bottom);
+
+/**
+ * 	@brief Returns the number of bytes between the bottom of the stack and _fstack.
+ */
+uint32_t stack_size(void);
+
+/**
+ * 	@brief Returns the number of bytes the stack currently uses, down to the caller's frame.
+ */
+uint32_t stack_used(void);
+
+/**
+ * 	@brief Returns the largest number of bytes the stack has used since stack_paint(). Takes time
+ * 	proportional to the unused stack, since it scans it for the lowest overwritten word.
+ */
+uint32_t stack_high_water(void);
+
+/**
+ * 	@brief Returns whether the stack has reached its bottom, i.e. its lowest word was overwritten,
+ * 	in which case it may have overflowed into .bss, or the allocator's arena.
+ */
+bool stack_overflowed(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -25,6 +25,8 @@
 #define __STR_UTILS_H
 
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,53 +35,127 @@ extern "C" {
 typedef enum STR_UTILS_CONF_enum
 {
 	/*
-	 * 	Max buffer size for str_utils_format_args integer to decimal/hexadecimal conversion
+	 * 	Max buffer size for str_utils integer to decimal/hexadecimal conversion:
+	 * 	a sign and the 20 digits of UINT64_MAX.
 	 */
-	kSTR_UTILS_CONF_BUFFER_SIZE = 10,
+	kSTR_UTILS_CONF_BUFFER_SIZE = 24,
 } STR_UTILS_CONF;
 
 /**
- * 	@brief Creates a formatted string, given a format string and arguments.
- * 	Tries to imitate the snprintf functionality, with very small code size.
+ * 	@brief Writes the decimal digits of value to dst, without a terminating null character.
+ * 	Uses a digit-pair table and multiply-by-reciprocal, so it executes no divide instructions.
  *
- * 	To be used by str_utils_format, and other functions that have already parsed the variable argument list.
+ * 	@param dst is the destination, with room for at least 10 characters
+ * 	@param value is the value to convert
+ * 	@return size_t the number of characters written
+ */
+size_t str_utils_u32_to_dec(char *  dst, uint32_t value);
+
+/**
+ * 	@brief Writes the decimal digits of a 64-bit value to dst, without a terminating null character.
+ * 	Uses a digit-pair table and multiply-by-reciprocal, so it executes no divide instructions.
+ *
+ * 	@param dst is the destination, with room for at least 20 characters
+ * 	@param value is the value to convert
+ * 	@return size_t the number of characters written
+ */
+size_t str_utils_u64_to_dec(char *  dst, uint64_t value);
+
+/**
+ * 	@brief Writes the lowercase hexadecimal digits of value to dst, without a terminating null character.
+ *
+ * 	@param dst is the destination, with room for at least 8 characters
+ * 	@param value is the value to convert
+ * 	@return size_t the number of characters written
+ */
+size_t str_utils_u32_to_hex(char *  dst, uint32_t value);
+
+/**
+ * 	@brief Writes the lowercase hexadecimal digits of a 64-bit value to dst, without a terminating null character.
+ *
+ * 	@param dst is the destination, with room for at least 16 characters
+ * 	@param value is the value to convert
+ * 	@return size_t the number of characters written
+ */
+size_t str_utils_u64_to_hex(char *  dst, uint64_t value);
+
+/**
+ * 	@brief Output callback of str_utils_format_sink.
+ * 	Receives the formatted output in chunks. The chunks are not null terminated, and are only valid for the
+ * 	duration of the call.
+ *
+ * 	@param ctx is the context pointer given to str_utils_format_sink
+ * 	@param str is the start of the chunk
+ * 	@param len is the number of characters in the chunk
+ */
+typedef void (*StrUtilsPutFn)(void *  ctx, const char *  str, size_t len);
+
+/**
+ * 	@brief Formats a string, given a format string and arguments, and streams the result to a sink.
+ * 	Literal text is emitted straight from the format string, and conversions go through a small fixed scratch
+ * 	buffer, so output of any length is produced in bounded stack space and without an intermediate copy.
  *
  * 	It supports the following format specifiers:
  * 	- %c: character
  * 	- %s: string
  * 	- %d: decimal
+ * 	- %u: unsigned decimal
  * 	- %x: hexadecimal
  * 	- %%: prints a single %
  * 	- %*<specifier>: left padding with spaces (width is given in the arguments)
+ * 	- %l<specifier>, %ll<specifier>: long and long long arguments, for d, u and x
+ *
+ * 	@param put is the sink callback, called once per chunk of output
+ * 	@param ctx is passed unmodified to put
+ * 	@param format is the format string
+ * 	@param args is the arguments for the format string
+ * 	@return int the number of characters emitted, or -1 if an error occurred
+ */
+int str_utils_format_sink(StrUtilsPutFn put, void *  ctx, const char *  format, va_list args);
+
+/**
+ * 	@brief Creates a formatted string, given a format string and arguments.
+ * 	Imitates the vsnprintf functionality, with very small code size.
+ * 	At most size - 1 characters are written, and the result is always null terminated when size is not 0.
+ *
+ * 	To be used by str_utils_format, and other functions that have already parsed the variable argument list.
+ * 	See str_utils_format_sink for the supported format specifiers.
  *
  * 	@param res_buf is the resulting string pointer
+ * 	@param size is the size of res_buf, including the terminating null character
  * 	@param format is the format string
- * 	@param ... is the arguments for the format string
- * 	@return int the number of characters written, or -1 if an error occurred
+ * 	@param args is the arguments for the format string
+ * 	@return int the length of the untruncated formatted string, or -1 if an error occurred.
+ * 		The output was truncated if the return value is size or more.
  */
-int str_utils_format_args(char *  res_buf, const char *  format, va_list args);
+int str_utils_format_args(char *  res_buf, size_t size, const char *  format, va_list args);
 
 /**
  * 	@brief Creates a formatted string, given a format string and arguments.
- * 	Tries to imitate the snprintf functionality, with very small code size.
+ * 	Imitates the snprintf functionality, with very small code size.
+ * 	At most size - 1 characters are written, and the result is always null terminated when size is not 0.
  * 	It supports the following format specifiers:
  * 	- %c: character
  * 	- %s: string
  * 	- %d: decimal
+ * 	- %u: unsigned decimal
  * 	- %x: hexadecimal
  * 	- %%: prints a single %
  * 	- %*<specifier>: left padding with spaces (width is given in the arguments)
- * 		example    : 	str_utils_format(res_str, "%*d", 5, 123);
+ * 	- %l<specifier>, %ll<specifier>: long and long long arguments, for d, u and x
+ * 		example    : 	str_utils_format(res_str, sizeof(res_str), "%*d", 5, 123);
  * 		result     : 	res_str="  123"
  * 		explanation: 	the width is 5 and the value is 123, so we print 2 spaces for padding, then the number,
  * 				for a total of 5 characters.
  *
  * 	@param res_buf is the resulting string pointer
+ * 	@param size is the size of res_buf, including the terminating null character
  * 	@param format is the format string
  * 	@param ... is the arguments for the format string
- * 	@return int the number of characters written, or -1 if an error occurred
+ * 	@return int the length of the untruncated formatted string, or -1 if an error occurred.
+ * 		The output was truncated if the return value is size or more.
  */
-int str_utils_format(char *  res_buf, const char *  format, ...);
+int str_utils_format(char *  res_buf, size_t size, const char *  format, ...);
 
 #ifdef __cplusplus
 }
@@ -61,6 +61,8 @@ timer0_t timer0_get_current_value(void);
 
 /**
  * 	@brief 	Returns the time passed since the last load/reload.
+ * 		To measure code without reconfiguring timer0, use profile.h
+ * 		instead.
  *
  * 	@return timer0_t
  */
@@ -146,6 +148,8 @@ void timer0_wait_to_expire(void);
 /**
  * 	@brief 	Delays for the specified duration in ticks.
  * 		This is blocking, and will not return until the timer expires.
+ * 		It reconfigures timer0, so it must not be used after
+ * 		timers_init(): use timers_delay_ms() instead.
  *
  * 	@param 	duration_ticks	The duration in ticks.
  */
@@ -154,6 +158,8 @@ void timer0_delay_ticks(timer0_t duration_ticks);
 /**
  * 	@brief 	Delays for the specified duration in milliseconds.
  * 		This is blocking, and will not return until the timer expires.
+ * 		It reconfigures timer0, so it must not be used after
+ * 		timers_init(): use timers_delay_ms() instead.
  *
  * 	@param 	duration_ms	The duration in milliseconds.
  */
@@ -205,6 +211,22 @@ timer0_t timer0_get_duration(timer0_t start_time, timer0_t end_time);
  */
 timer0_t timer0_get_duration_ms(timer0_t start_time, timer0_t end_time);
 
+/**
+ * 	@brief 	Returns the number of system clock cycles since reset.
+ *		This reads timer0's free-running 64-bit uptime counter, which
+ *		keeps counting independently of the timer0 configuration, so it
+ *		can be used for cycle-accurate measurements without disturbing
+ *		the timer.
+ *
+ *		Example:
+ *		uint64_t start = timer0_get_uptime_cycles();
+ *		do_something();
+ *		uint64_t cycles = timer0_get_uptime_cycles() - start;
+ *
+ * 	@return uint64_t
+ */
+uint64_t timer0_get_uptime_cycles(void);
+
 #ifdef __cplusplus
 }
 #endif
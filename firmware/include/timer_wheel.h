@@ -0,0 +1,146 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __TIMER_WHEEL_H
+#define __TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Hashed timing wheel.
+ *
+ * 	Multiplexes any number of timeouts onto one periodic tick. A timer expiring
+ * 	at tick t is linked into slot (t % kTIMER_WHEEL_CONF_SLOTS), so starting and
+ * 	cancelling a timer are O(1), and a tick only visits the timers of one slot.
+ * 	Timers further than kTIMER_WHEEL_CONF_SLOTS ticks away stay in their slot for
+ * 	several revolutions, and are skipped until their tick.
+ *
+ * 	The wheel is hardware independent, and does no locking: timers.h drives one
+ * 	from the timer0 interrupt. Timers are owned by the caller, and must stay
+ * 	allocated while pending.
+ */
+
+typedef enum TIMER_WHEEL_CONF_enum
+{
+	/*
+	 * 	Number of slots. Must be a power of two.
+	 */
+	kTIMER_WHEEL_CONF_SLOTS = 256,
+} TIMER_WHEEL_CONF;
+
+typedef void (*TimerWheelCallback)(void *  ctx);
+
+/**
+ * 	@brief Doubly linked list node, the head of a slot or the first member of a timer.
+ */
+typedef struct TimerWheelLink
+{
+	struct TimerWheelLink *	next;
+	struct TimerWheelLink *	prev;
+} TimerWheelLink;
+
+/**
+ * 	@brief A timer. Zero-initialize, or call timer_wheel_timer_init(), before first use.
+ */
+typedef struct
+{
+	TimerWheelLink		link;
+	uint32_t		expires;
+	uint32_t		period;
+	TimerWheelCallback	callback;
+	void *			ctx;
+} TimerWheelTimer;
+
+typedef struct
+{
+	TimerWheelLink	slots[kTIMER_WHEEL_CONF_SLOTS];
+
+	/*
+	 * 	Ticks since timer_wheel_init().
+	 */
+	uint32_t	now;
+
+	/*
+	 * 	Number of pending timers.
+	 */
+	uint32_t	pending;
+} TimerWheel;
+
+/**
+ * 	@brief Initializes an empty wheel, at tick 0.
+ */
+void timer_wheel_init(TimerWheel *  wheel);
+
+/**
+ * 	@brief Initializes a timer, which is not pending.
+ */
+void timer_wheel_timer_init(TimerWheelTimer *  timer);
+
+/**
+ * 	@brief Starts, or restarts, a timer. O(1).
+ *
+ * 	@param wheel is the wheel to add the timer to
+ * 	@param timer is the timer
+ * 	@param delay is the number of ticks until the callback, at least 1: a delay of 0 fires on the next tick
+ * 	@param period is the number of ticks between callbacks after the first one, or 0 for a one-shot timer
+ * 	@param callback is called from timer_wheel_tick() when the timer expires
+ * 	@param ctx is passed to the callback
+ */
+void timer_wheel_start(
+	TimerWheel *  wheel,
+	TimerWheelTimer *  timer,
+	uint32_t delay,
+	uint32_t period,
+	TimerWheelCallback callback,
+	void *  ctx);
+
+/**
+ * 	@brief Cancels a timer. O(1). Does nothing if the timer is not pending.
+ */
+void timer_wheel_cancel(TimerWheel *  wheel, TimerWheelTimer *  timer);
+
+/**
+ * 	@brief Returns true if the timer is started, and has not expired or been cancelled.
+ * 	Periodic timers stay pending until cancelled.
+ */
+bool timer_wheel_is_pending(const TimerWheelTimer *  timer);
+
+/**
+ * 	@brief Advances the wheel by one tick, and calls the callbacks of the timers expiring at the new tick.
+ * 	Callbacks may start and cancel any timer, including their own. Periodic timers are restarted before
+ * 	their callback is called.
+ *
+ * 	@return uint32_t the number of callbacks called
+ */
+uint32_t timer_wheel_tick(TimerWheel *  wheel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __TIMERS_H
+#define __TIMERS_H
+
+#include <stdint.h>
+#include "timer_wheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Software timers.
+ *
+ * 	timers_init() dedicates timer0 to a periodic tick interrupt, which drives a
+ * 	timer wheel (timer_wheel.h), so that any number of timeouts can be pending
+ * 	at the same time. After timers_init(), timer0 must not be reconfigured, e.g.
+ * 	by timer0_delay_ms(): use timers_delay_ms() instead. timer0's uptime counter,
+ * 	used by profile.h, is not affected.
+ *
+ * 	Callbacks are called from the timer0 interrupt, so they must be short, and
+ * 	must not wait for other interrupts, e.g. for space in the UART TX buffer.
+ */
+
+typedef enum TIMERS_CONF_enum
+{
+	/*
+	 * 	Tick period, i.e. the resolution of the timers, in milliseconds.
+	 */
+	kTIMERS_CONF_TICK_MS = 1,
+} TIMERS_CONF;
+
+/**
+ * 	@brief Starts the timer0 tick interrupt. Interrupts must be enabled with irq_setie(1) for the timers to run.
+ */
+void timers_init(void);
+
+/**
+ * 	@brief Handles the timer0 interrupt. Called by isr().
+ */
+void timers_isr(void);
+
+/**
+ * 	@brief Starts, or restarts, a timer. Rounds delay_ms up to whole ticks.
+ *
+ * 	@param timer is the timer, which must stay allocated while pending
+ * 	@param delay_ms is the time until the first callback
+ * 	@param period_ms is the time between callbacks after the first one, or 0 for a one-shot timer
+ * 	@param callback is called from the timer0 interrupt when the timer expires
+ * 	@param ctx is passed to the callback
+ */
+void timers_start_ms(
+	TimerWheelTimer *  timer,
+	uint32_t delay_ms,
+	uint32_t period_ms,
+	TimerWheelCallback callback,
+	void *  ctx);
+
+/**
+ * 	@brief Cancels a timer. Does nothing if the timer is not pending.
+ */
+void timers_cancel(TimerWheelTimer *  timer);
+
+/**
+ * 	@brief Returns the number of ticks since timers_init().
+ */
+uint32_t timers_get_ticks(void);
+
+/**
+ * 	@brief Waits for at least duration_ms, without reconfiguring timer0. Needs interrupts enabled.
+ */
+void timers_delay_ms(uint32_t duration_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
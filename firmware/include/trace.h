@@ -0,0 +1,196 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 	Binary event tracing.
+ *
+ * 	TRACE_INSTANT(), TRACE_BEGIN() and TRACE_END() record a fixed-size event,
+ * 	i.e. an event id, the low 32 bits of timer0's uptime counter, and a 32-bit
+ * 	argument, into an SRAM ring buffer, in a few cycles, and without formatting
+ * 	anything. When the buffer is full, the oldest events are overwritten, so it
+ * 	always holds the latest kTRACE_CONF_EVENTS events.
+ *
+ * 	Event names are string literals, which are placed in the .trace_events
+ * 	section. The linker script does not load that section, and links it at
+ * 	address zero, so that an event id is the offset of its name in the section:
+ * 	names cost no flash, and tools/trace_decode.py reads them from the ELF.
+ *
+ * 	trace_drain() prints events over the UART, in text, so that traces can be
+ * 	captured with the serial console. sched_run() calls it in batches when no
+ * 	task is ready (sched.h), so that events are sent while the CPU would be
+ * 	idle. trace_dump() prints them on demand:
+ *
+ * 	void
+ * 	isr_handler(void)
+ * 	{
+ * 		TRACE_BEGIN("rx", status);
+ * 		...
+ * 		TRACE_END("rx", 0);
+ * 	}
+ *
+ * 	Building with TRACE=0 defines CONFIG_TRACE_DISABLE, which compiles the
+ * 	trace points out.
+ */
+
+typedef enum TRACE_CONF_enum
+{
+	/*
+	 * 	Ring buffer size, in events. Must be a power of two.
+	 */
+	kTRACE_CONF_EVENTS	= 256,
+
+	/*
+	 * 	The event phase is stored above the name offset in the id word.
+	 */
+	kTRACE_CONF_PHASE_SHIFT	= 24,
+} TRACE_CONF;
+
+typedef enum
+{
+	kTracePhaseInstant	= 0,
+	kTracePhaseBegin	= 1,
+	kTracePhaseEnd		= 2,
+} TracePhase;
+
+/**
+ * 	@brief A recorded event.
+ */
+typedef struct
+{
+	/*
+	 * 	TracePhase << kTRACE_CONF_PHASE_SHIFT | offset of the name in .trace_events.
+	 */
+	uint32_t id;
+
+	/*
+	 * 	Low 32 bits of timer0's uptime counter, in system clock cycles.
+	 */
+	uint32_t timestamp;
+	uint32_t arg;
+} TraceEvent;
+
+/*
+ * 	Ring buffer, number of events recorded since boot, and number of events
+ * 	printed or lost since boot. Only use through the functions and macros below.
+ */
+extern TraceEvent	 trace_buffer[kTRACE_CONF_EVENTS];
+extern volatile uint32_t trace_head;
+extern uint32_t		 trace_tail;
+
+/**
+ * 	@brief Records an event. Safe to call from interrupt handlers. Use the TRACE_*() macros instead.
+ *
+ * 	@param id is the phase and name offset, see TraceEvent
+ * 	@param arg is recorded with the event
+ */
+static inline void
+trace_record(uint32_t id, uint32_t arg)
+{
+	uint32_t ie = irq_getie();
+
+	irq_setie(0);
+
+	TraceEvent *  event = &trace_buffer[trace_head & (kTRACE_CONF_EVENTS - 1)];
+
+	/*
+	 * 	Latch the uptime counter, and only read its low word, which is the
+	 * 	second 32-bit CSR of the 64-bit register.
+	 */
+	timer0_uptime_latch_write(1);
+	event->timestamp = csr_read_simple(CSR_TIMER0_UPTIME_CYCLES_ADDR + 4);
+	event->id	 = id;
+	event->arg	 = arg;
+	trace_head++;
+
+	irq_setie(ie);
+}
+
+#ifdef CONFIG_TRACE_DISABLE
+	#define TRACE_EVENT(phase, event_name, event_arg) do { (void)(event_arg); } while (0)
+#else
+	#define TRACE_EVENT(phase, event_name, event_arg)                                              \
+		do                                                                                     \
+		{                                                                                      \
+			static const char trace_event_name[]                                           \
+				__attribute__((section(".trace_events"), used)) = event_name;          \
+			trace_record(                                                                  \
+				((uint32_t)(phase) << kTRACE_CONF_PHASE_SHIFT) | (uint32_t)(uintptr_t)trace_event_name, \
+				(uint32_t)(event_arg));                                                \
+		} while (0)
+#endif
+
+/**
+ * 	@brief Records a point event, named event_name, a string literal.
+ */
+#define TRACE_INSTANT(event_name, event_arg)	TRACE_EVENT(kTracePhaseInstant, event_name, event_arg)
+
+/**
+ * 	@brief Records the start of a duration event, named event_name, a string literal.
+ */
+#define TRACE_BEGIN(event_name, event_arg)	TRACE_EVENT(kTracePhaseBegin, event_name, event_arg)
+
+/**
+ * 	@brief Records the end of the innermost duration event, which must have been begun with the same name.
+ */
+#define TRACE_END(event_name, event_arg)	TRACE_EVENT(kTracePhaseEnd, event_name, event_arg)
+
+/**
+ * 	@brief Returns whether events were recorded which trace_drain() has not printed yet.
+ */
+static inline bool
+trace_pending(void)
+{
+	return trace_head != trace_tail;
+}
+
+/**
+ * 	@brief Prints up to max_events of the oldest events not printed yet over the UART, one per line.
+ * 	Events overwritten before they could be printed are reported as lost.
+ *
+ * 	@param max_events is the maximum number of events to print
+ * 	@return uint32_t the number of events still to print
+ */
+uint32_t trace_drain(uint32_t max_events);
+
+/**
+ * 	@brief Prints all the events not printed yet over the UART.
+ */
+void trace_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -24,7 +24,8 @@
 #ifndef __UART_H
 #define __UART_H
 
-#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,35 +37,175 @@ typedef enum
 	kUartEvRX = 0x2,
 } UartEv;
 
+typedef enum UART_CONF_enum
+{
+	/*
+	 * 	Size of the SRAM receive ring buffer, in bytes. Must be a power of two.
+	 */
+	kUART_CONF_RX_BUFFER_SIZE = 256,
+
+	/*
+	 * 	Size of the SRAM transmit ring buffer, in bytes. Must be a power of two.
+	 */
+	kUART_CONF_TX_BUFFER_SIZE = 512,
+
+	/*
+	 * 	Maximum length of a single UART TX DMA transfer, set by the width of its length register.
+	 * 	uart_write_async() splits longer buffers.
+	 */
+	kUART_CONF_DMA_MAX_LENGTH = 0xffff,
+} UART_CONF;
+
 /**
- * 	@brief Echoes incoming UART data from TX back to the UART RX.
+ * 	@brief Called from uart_isr() after received bytes have been moved into the RX ring buffer.
  */
-void uart_echo(void);
-
+typedef void (*UartRxCallback)(void);
 
-typedef enum UART_PRINTF_CONF_enum
+/**
+ * 	@brief UART driver counters, see uart_get_stats().
+ */
+typedef struct
 {
 	/*
-	 * 	Max buffer size for printf
+	 * 	Bytes moved from the hardware RX FIFO into the RX ring buffer.
 	 */
-	kUART_PRINTF_CONF_BUFFER_SIZE = INT8_MAX,
-} UART_PRINTF_CONF;
+	uint32_t rx_bytes;
+
+	/*
+	 * 	Bytes lost because the RX ring buffer was full.
+	 */
+	uint32_t rx_dropped;
+
+	/*
+	 * 	Bytes handed to the UART by uart_putchar().
+	 */
+	uint32_t tx_bytes;
+
+	/*
+	 * 	Number of uart_putchar() calls that had to wait for space in the TX ring buffer.
+	 */
+	uint32_t tx_stalls;
+
+	/*
+	 * 	Bytes sent by the TX DMA, also counted in tx_bytes.
+	 */
+	uint32_t tx_dma_bytes;
+} UartStats;
+
+/**
+ * 	@brief Initializes the UART driver in interrupt-driven mode.
+ * 	Enables the UART RX/TX events and unmasks the UART interrupt line. Interrupts must also be globally enabled
+ * 	(irq_setie(1)) for the ring buffers to be serviced.
+ *
+ * 	Before this is called, the driver works in polled mode: uart_putchar() spins on the hardware TX FIFO and
+ * 	uart_read() reads the hardware RX FIFO directly.
+ */
+void uart_init(void);
+
+/**
+ * 	@brief UART Interrupt Service Routine.
+ * 	Moves received bytes into the RX ring buffer and refills the hardware TX FIFO from the TX ring buffer.
+ * 	Must be called by isr() when the UART interrupt is pending.
+ */
+void uart_isr(void);
+
+/**
+ * 	@brief UART TX DMA Interrupt Service Routine.
+ * 	Starts the next part of the uart_write_async() buffer, or resumes sending the TX ring buffer.
+ * 	Must be called by isr() when the UART TX DMA interrupt is pending.
+ */
+void uart_tx_dma_isr(void);
+
+/**
+ * 	@brief Sets the function called from the UART interrupt when bytes are received, e.g. to wake up the task
+ * 	reading them. It runs in interrupt context, so it must be short.
+ *
+ * 	@param callback is the callback, or NULL for none
+ */
+void uart_set_rx_callback(UartRxCallback callback);
+
+/**
+ * 	@brief Echoes incoming UART data from TX back to the UART RX.
+ */
+void uart_echo(void);
+
+/**
+ * 	@brief Reads up to len received bytes. Never blocks.
+ *
+ * 	@param buf is the destination buffer
+ * 	@param len is the maximum number of bytes to read
+ * 	@return uint32_t the number of bytes read, 0 if nothing has been received
+ */
+uint32_t uart_read(char *  buf, uint32_t len);
+
+/**
+ * 	@brief Reads a single received byte. Never blocks.
+ *
+ * 	@return int the byte read, or -1 if nothing has been received
+ */
+int uart_getchar_nonblock(void);
+
+/**
+ * 	@brief Returns the number of received bytes waiting in the RX ring buffer.
+ */
+uint32_t uart_rx_available(void);
+
+/**
+ * 	@brief Blocks until every enqueued byte, and every uart_write_async() byte, has been handed to the hardware.
+ */
+void uart_flush(void);
+
+/**
+ * 	@brief Returns true while enqueued or uart_write_async() bytes have not all been handed to the hardware,
+ * 	i.e. while uart_flush() would block.
+ */
+bool uart_tx_busy(void);
+
+/**
+ * 	@brief Copies the driver counters.
+ *
+ * 	@param stats is the destination
+ */
+void uart_get_stats(UartStats *  stats);
 
 /**
  * 	@brief Writes a character on UART.
+ * 	In interrupt-driven mode the character is enqueued in the TX ring buffer and the call returns immediately.
+ * 	It only blocks when the TX ring buffer is full.
  */
 void uart_putchar(char c);
 
+/**
+ * 	@brief Sends len bytes from buf with the UART TX DMA, and returns without waiting for them to be sent.
+ * 	The bytes are sent after the bytes already enqueued, and before the bytes enqueued afterwards, e.g. by
+ * 	uart_putchar(). buf must stay unchanged until uart_write_async_busy() returns false. If a previous transfer
+ * 	is still running, waits for it to finish first.
+ * 	Without the UART TX DMA in the gateware, or before uart_init(), the bytes are written with uart_putchar().
+ *
+ * 	@param buf is the data to send, anywhere on the system bus, with any alignment
+ * 	@param len is the number of bytes to send
+ */
+void uart_write_async(const void *  buf, uint32_t len);
+
+/**
+ * 	@brief Returns true while a uart_write_async() buffer is still being read by the UART TX DMA.
+ */
+bool uart_write_async_busy(void);
+
 /**
  * 	@brief Writes a formatted string on UART.
+ * 	In interrupt-driven mode the formatted string is enqueued and the call returns without waiting for it to be sent.
+ * 	The output is streamed to the UART as it is formatted, so there is no limit on its length.
  * 	Tries to imitate the printf functionality, with very small code size.
  * 	It supports the following format specifiers:
  * 	- %c: character
  * 	- %s: string
  * 	- %d: decimal
+ * 	- %u: unsigned decimal
  * 	- %x: hexadecimal
  * 	- %%: prints a single %
  * 	- %*<specifier>: left padding with spaces (width is given in the arguments)
+ * 	- %l<specifier>, %ll<specifier>: long and long long arguments, for d, u and x
  * 		example    : 	uart_printf("%*d", 5, 123);
  * 		result     : 	"  123"
  * 		explanation: 	the width is 5 and the value is 123, so we print 2 spaces for padding, then the number,
@@ -0,0 +1,198 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	Flash-to-SRAM loader, see include/loader.h.
+ *
+ * 	Executes in place from the SPI flash, without crt0, so it must not use
+ * 	initialized data or .bss: loader.ld checks that both are empty. It runs
+ * 	with interrupts disabled, as they are at reset.
+ */
+
+#include <generated/csr.h>
+#include <generated/mem.h>
+#include <stdint.h>
+#include "loader.h"
+
+
+_Static_assert(CONFIG_LOADER_STACK_SIZE == kLOADER_CONF_STACK_SIZE, "LOADER_STACK_SIZE in the firmware Makefile must match kLOADER_CONF_STACK_SIZE");
+
+
+/*
+ * 	CRC-32 of every nibble value, for the reflected 0xedb88320 polynomial.
+ * 	A 16-entry table keeps the loader small.
+ */
+static const uint32_t loader_crc32_table[16] = {
+	0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+	0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+	0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+	0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+};
+
+void loader_main(void) __attribute__((noreturn));
+
+
+/*
+ * 	Updates crc with the four bytes of a little-endian word, lowest nibble first.
+ */
+static inline uint32_t
+loader_crc32_word(uint32_t crc, uint32_t word)
+{
+	crc ^= word;
+	for (int i = 0; i < 8; i++)
+	{
+		crc = (crc >> 4) ^ loader_crc32_table[crc & 0xf];
+	}
+
+	return crc;
+}
+
+static void
+loader_puts(const char *  str)
+{
+#ifdef CSR_UART_BASE
+	while (*str != '\0')
+	{
+		while (uart_txfull_read())
+		{
+			;
+		}
+		uart_rxtx_write(*str++);
+	}
+#else
+	(void)str;
+#endif
+}
+
+static void __attribute__((noreturn))
+loader_fail(const char *  message)
+{
+	loader_puts(message);
+
+#ifdef CSR_LEDS_OUT_ADDR
+	leds_out_write(1 << CSR_LEDS_OUT_RED_OFFSET);
+#endif
+
+	while (1)
+	{
+		;
+	}
+}
+
+/*
+ * 	The image was just written through the data bus, so drop any stale
+ * 	instruction cache lines before executing it. fence.i is emitted as a raw
+ * 	word, since not every toolchain -march enables Zifencei.
+ */
+static inline void
+loader_flush_icache(void)
+{
+	__asm__ volatile(
+		".word 0x0000100f\n"
+		"nop\n"
+		"nop\n"
+		"nop\n"
+		"nop\n"
+		::: "memory");
+}
+
+void
+loader_main(void)
+{
+	const LoaderHeader *header	 = (const LoaderHeader *)(ROM_BASE + CONFIG_LOADER_SIZE);
+	uint32_t	    sram_end	 = SRAM_BASE + SRAM_SIZE - kLOADER_CONF_STACK_SIZE;
+	uint32_t	    load_address = header->load_address;
+	uint32_t	    length	 = header->length;
+	uint32_t	    entry	 = header->entry;
+
+	if (header->magic != kLOADER_CONF_MAGIC)
+	{
+		loader_fail("loader: no application image\n");
+	}
+
+	if (length == 0 || (length & 0x3) != 0 || (load_address & 0x3) != 0 || load_address < SRAM_BASE
+	    || load_address >= sram_end || length > sram_end - load_address || entry < load_address
+	    || entry - load_address >= length)
+	{
+		loader_fail("loader: bad application image header\n");
+	}
+
+	/*
+	 * 	Copy the image, and compute its CRC in the same pass. The flash is read
+	 * 	at consecutive addresses, four words at a time, which the LiteSPI memory
+	 * 	mapped interface continues as a read burst, without sending a new read
+	 * 	command, as long as no instruction fetch from the flash comes in between,
+	 * 	i.e. when the loop executes from an instruction cache.
+	 */
+	const volatile uint32_t *src   = (const volatile uint32_t *)(header + 1);
+	uint32_t *		 dst   = (uint32_t *)(uintptr_t)load_address;
+	uint32_t		 words = length / sizeof(uint32_t);
+	uint32_t		 crc   = 0xffffffff;
+
+	for (; words >= 4; words -= 4)
+	{
+		uint32_t w0 = src[0];
+		uint32_t w1 = src[1];
+		uint32_t w2 = src[2];
+		uint32_t w3 = src[3];
+
+		dst[0] = w0;
+		dst[1] = w1;
+		dst[2] = w2;
+		dst[3] = w3;
+
+		crc = loader_crc32_word(crc, w0);
+		crc = loader_crc32_word(crc, w1);
+		crc = loader_crc32_word(crc, w2);
+		crc = loader_crc32_word(crc, w3);
+
+		src += 4;
+		dst += 4;
+	}
+
+	for (; words > 0; words--)
+	{
+		uint32_t w = *src++;
+
+		*dst++ = w;
+		crc    = loader_crc32_word(crc, w);
+	}
+
+	if ((crc ^ 0xffffffff) != header->crc32)
+	{
+		loader_fail("loader: application image CRC mismatch\n");
+	}
+
+	loader_flush_icache();
+
+	((void (*)(void))(uintptr_t)entry)();
+
+	/*
+	 * 	Not reached: the application never returns.
+	 */
+	while (1)
+	{
+		;
+	}
+}
@@ -0,0 +1,329 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <irq.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "alloc.h"
+#include "ramfunc.h"
+#include "stack.h"
+#include "uart.h"
+
+
+/**
+ * 	@brief A free pool block, linked into its pool's free list.
+ */
+typedef struct AllocBlock
+{
+	struct AllocBlock *	next;
+} AllocBlock;
+
+/**
+ * 	@brief A pool of equal blocks. Blocks below next_unused have been handed out at least once, and
+ * 	the free ones are on the free list, so that alloc_init() does not need to visit every block.
+ */
+typedef struct
+{
+	uint8_t *	start;
+	uint8_t *	end;
+	uint8_t *	next_unused;
+	AllocBlock *	free;
+	uint32_t	block_size;
+	uint32_t	blocks;
+	uint32_t	used;
+	uint32_t	high_water;
+	uint32_t	failures;
+} AllocPool;
+
+
+/*
+ * 	Pool storage, in .bss. The block sizes must be distinct, since they name the arrays.
+ */
+#define ALLOC_POOL_STORAGE(size, count)								\
+	_Static_assert((size) % kALLOC_CONF_ALIGN == 0, "pool block sizes must be multiples of kALLOC_CONF_ALIGN"); \
+	static uint8_t alloc_pool_storage_##size[(size) * (count)] __attribute__((aligned(16)));
+
+ALLOC_CONF_POOLS(ALLOC_POOL_STORAGE)
+
+#define ALLOC_POOL_INIT(size, count)					\
+	{										\
+		.start	    = alloc_pool_storage_##size,				\
+		.end	    = alloc_pool_storage_##size + (size) * (count),	\
+		.block_size = (size),						\
+		.blocks	    = (count),						\
+	},
+
+static AllocPool alloc_pools[kAllocPools] = {ALLOC_CONF_POOLS(ALLOC_POOL_INIT)};
+
+/*
+ * 	End of .bss, and top of the stack, from the linker script.
+ */
+extern uint8_t _end[];
+extern uint8_t _fstack[];
+
+static uintptr_t alloc_arena_start	= 0;
+static uintptr_t alloc_arena_end	= 0;
+static uintptr_t alloc_arena_top	= 0;
+static uintptr_t alloc_arena_high_water = 0;
+static uint32_t	 alloc_arena_failures	= 0;
+
+
+static inline uint32_t
+alloc_lock(void)
+{
+	uint32_t ie = irq_getie();
+
+	irq_setie(0);
+
+	return ie;
+}
+
+static inline void
+alloc_unlock(uint32_t ie)
+{
+	irq_setie(ie);
+}
+
+void
+alloc_init(void)
+{
+	uint32_t ie = alloc_lock();
+
+	for (AllocPool *pool = alloc_pools; pool < alloc_pools + kAllocPools; pool++)
+	{
+		pool->next_unused = pool->start;
+		pool->free	  = NULL;
+		pool->used	  = 0;
+		pool->high_water  = 0;
+		pool->failures	  = 0;
+	}
+
+	uintptr_t start = ((uintptr_t)_end + kALLOC_CONF_ALIGN - 1) & ~(uintptr_t)(kALLOC_CONF_ALIGN - 1);
+	uintptr_t end	= (uintptr_t)_fstack - kALLOC_CONF_STACK_RESERVE;
+
+	alloc_arena_start      = start;
+	alloc_arena_end	       = end > start ? end : start;
+	alloc_arena_top	       = start;
+	alloc_arena_high_water = start;
+	alloc_arena_failures   = 0;
+
+	/*
+	 * 	Arena allocations would look like stack use to stack_high_water().
+	 */
+	stack_set_bottom((void *)alloc_arena_end);
+
+	alloc_unlock(ie);
+}
+
+RAMFUNC void *
+alloc_pool_alloc(size_t size)
+{
+	void *	    block   = NULL;
+	AllocPool * fitting = NULL;
+	uint32_t    ie	    = alloc_lock();
+
+	for (AllocPool *pool = alloc_pools; pool < alloc_pools + kAllocPools; pool++)
+	{
+		if (pool->block_size < size)
+		{
+			continue;
+		}
+
+		if (fitting == NULL)
+		{
+			fitting = pool;
+		}
+
+		if (pool->free != NULL)
+		{
+			block	   = pool->free;
+			pool->free = pool->free->next;
+		}
+		else if (pool->next_unused < pool->end)
+		{
+			block = pool->next_unused;
+			pool->next_unused += pool->block_size;
+		}
+		else
+		{
+			continue;
+		}
+
+		pool->used++;
+		if (pool->used > pool->high_water)
+		{
+			pool->high_water = pool->used;
+		}
+		break;
+	}
+
+	/*
+	 * 	Failures are counted on the pool the request was meant for.
+	 */
+	if (block == NULL && fitting != NULL)
+	{
+		fitting->failures++;
+	}
+
+	alloc_unlock(ie);
+
+	return block;
+}
+
+RAMFUNC void
+alloc_free(void *  ptr)
+{
+	uint8_t *  bytes = ptr;
+	uint32_t   ie	 = alloc_lock();
+
+	for (AllocPool *pool = alloc_pools; pool < alloc_pools + kAllocPools; pool++)
+	{
+		if (bytes >= pool->start && bytes < pool->end)
+		{
+			AllocBlock *block = ptr;
+
+			block->next = pool->free;
+			pool->free  = block;
+			pool->used--;
+			break;
+		}
+	}
+
+	alloc_unlock(ie);
+}
+
+RAMFUNC void *
+alloc_arena_alloc_aligned(size_t size, size_t align)
+{
+	void *	 allocation = NULL;
+	uint32_t ie	    = alloc_lock();
+
+	uintptr_t start = (alloc_arena_top + align - 1) & ~(uintptr_t)(align - 1);
+
+	if (start >= alloc_arena_top && start <= alloc_arena_end && size <= alloc_arena_end - start)
+	{
+		allocation	= (void *)start;
+		alloc_arena_top = start + size;
+
+		if (alloc_arena_top > alloc_arena_high_water)
+		{
+			alloc_arena_high_water = alloc_arena_top;
+		}
+	}
+	else
+	{
+		alloc_arena_failures++;
+	}
+
+	alloc_unlock(ie);
+
+	return allocation;
+}
+
+void *
+alloc_arena_alloc(size_t size)
+{
+	return alloc_arena_alloc_aligned(size, kALLOC_CONF_ALIGN);
+}
+
+AllocArenaMark
+alloc_arena_mark(void)
+{
+	return alloc_arena_top;
+}
+
+void
+alloc_arena_reset(AllocArenaMark mark)
+{
+	uint32_t ie = alloc_lock();
+
+	if (mark >= alloc_arena_start && mark <= alloc_arena_top)
+	{
+		alloc_arena_top = mark;
+	}
+
+	alloc_unlock(ie);
+}
+
+void
+alloc_get_stats(AllocStats *  stats)
+{
+	uint32_t ie = alloc_lock();
+
+	for (int i = 0; i < kAllocPools; i++)
+	{
+		stats->pools[i] = (AllocPoolStats){
+			.block_size = alloc_pools[i].block_size,
+			.blocks	    = alloc_pools[i].blocks,
+			.used	    = alloc_pools[i].used,
+			.high_water = alloc_pools[i].high_water,
+			.failures   = alloc_pools[i].failures,
+		};
+	}
+
+	stats->arena_size	= alloc_arena_end - alloc_arena_start;
+	stats->arena_used	= alloc_arena_top - alloc_arena_start;
+	stats->arena_high_water = alloc_arena_high_water - alloc_arena_start;
+	stats->arena_failures	= alloc_arena_failures;
+
+	alloc_unlock(ie);
+}
+
+void
+alloc_dump(void)
+{
+	AllocStats stats;
+
+	alloc_get_stats(&stats);
+
+	uart_printf("%*s %*s %*s %*s %*s\n", 12, "pool", 10, "blocks", 10, "used", 10, "high-water", 10, "failures");
+
+	for (int i = 0; i < kAllocPools; i++)
+	{
+		uart_printf(
+			"%*u %*u %*u %*u %*u\n",
+			12,
+			stats.pools[i].block_size,
+			10,
+			stats.pools[i].blocks,
+			10,
+			stats.pools[i].used,
+			10,
+			stats.pools[i].high_water,
+			10,
+			stats.pools[i].failures);
+	}
+
+	uart_printf(
+		"%*s %*u %*u %*u %*u\n",
+		12,
+		"arena",
+		10,
+		stats.arena_size,
+		10,
+		stats.arena_used,
+		10,
+		stats.arena_high_water,
+		10,
+		stats.arena_failures);
+}
@@ -0,0 +1,125 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	C++ operator new and delete on the allocator (include/alloc.h), instead
+ * 	of newlib's malloc(). Objects are taken from the smallest fitting pool,
+ * 	or from the arena when the pools are full or the object is larger than
+ * 	their blocks. Arena objects are only freed by alloc_arena_reset(), so
+ * 	long-lived objects larger than the pool blocks should be created once, at
+ * 	startup. ALLOC_NEW=0 leaves operator new to the C++ runtime.
+ */
+
+#ifndef CONFIG_ALLOC_NEW_DISABLE
+
+#include <cstddef>
+#include <new>
+#include "alloc.h"
+#include "uart.h"
+
+
+static void *
+alloc_new_try(std::size_t size)
+{
+	void *ptr = alloc_pool_alloc(size);
+
+	if (ptr == nullptr)
+	{
+		ptr = alloc_arena_alloc_aligned(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+	}
+
+	return ptr;
+}
+
+/*
+ * 	Exceptions are disabled, so running out of memory is fatal.
+ */
+static void *
+alloc_new(std::size_t size)
+{
+	void *ptr = alloc_new_try(size);
+
+	if (ptr == nullptr)
+	{
+		uart_printf("alloc: out of memory, %u bytes requested\n", (uint32_t)size);
+		uart_flush();
+
+		while (1)
+		{
+			;
+		}
+	}
+
+	return ptr;
+}
+
+void *
+operator new(std::size_t size)
+{
+	return alloc_new(size);
+}
+
+void *
+operator new[](std::size_t size)
+{
+	return alloc_new(size);
+}
+
+void *
+operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	return alloc_new_try(size);
+}
+
+void *
+operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	return alloc_new_try(size);
+}
+
+void
+operator delete(void *  ptr) noexcept
+{
+	alloc_free(ptr);
+}
+
+void
+operator delete[](void *  ptr) noexcept
+{
+	alloc_free(ptr);
+}
+
+void
+operator delete(void *  ptr, std::size_t) noexcept
+{
+	alloc_free(ptr);
+}
+
+void
+operator delete[](void *  ptr, std::size_t) noexcept
+{
+	alloc_free(ptr);
+}
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdint.h>
+#include "cobs.h"
+#include "ramfunc.h"
+
+
+RAMFUNC uint32_t
+cobs_encode(uint8_t *  dst, const uint8_t *  src, uint32_t len)
+{
+	uint32_t code_index = 0;
+	uint32_t out	    = 1;
+	uint8_t	 code	    = 1;
+
+	for (uint32_t i = 0; i < len; i++)
+	{
+		if (src[i] != 0)
+		{
+			dst[out++] = src[i];
+			code++;
+		}
+
+		/*
+		 * 	A zero, or a full block of 254 non-zero bytes, ends the block:
+		 * 	its code is the offset to the next zero.
+		 */
+		if ((src[i] == 0) || (code == 0xff))
+		{
+			dst[code_index] = code;
+			code		= 1;
+			code_index	= out++;
+
+			/*
+			 * 	A full block at the very end needs no empty block after it.
+			 */
+			if ((src[i] != 0) && (i + 1 == len))
+			{
+				return code_index;
+			}
+		}
+	}
+
+	dst[code_index] = code;
+
+	return out;
+}
+
+RAMFUNC int32_t
+cobs_decode(uint8_t *  dst, uint32_t dst_max, const uint8_t *  src, uint32_t len)
+{
+	uint32_t in  = 0;
+	uint32_t out = 0;
+
+	while (in < len)
+	{
+		uint8_t code = src[in++];
+
+		if ((code == 0) || (in + code - 1 > len) || (out + code - 1 > dst_max))
+		{
+			return -1;
+		}
+
+		for (uint8_t i = 1; i < code; i++)
+		{
+			if (src[in] == 0)
+			{
+				return -1;
+			}
+
+			dst[out++] = src[in++];
+		}
+
+		/*
+		 * 	Every block but the last, and full blocks, ends with an implicit zero.
+		 */
+		if ((code != 0xff) && (in < len))
+		{
+			if (out == dst_max)
+			{
+				return -1;
+			}
+
+			dst[out++] = 0;
+		}
+	}
+
+	return (int32_t)out;
+}
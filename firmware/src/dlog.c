@@ -0,0 +1,380 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <generated/csr.h>
+#include <generated/soc.h>
+#include <irq.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "cobs.h"
+#include "crc16.h"
+#include "dlog.h"
+#include "ramfunc.h"
+#include "uart.h"
+
+
+_Static_assert(
+	(kDLOG_CONF_BUFFER_SIZE & (kDLOG_CONF_BUFFER_SIZE - 1)) == 0,
+	"kDLOG_CONF_BUFFER_SIZE must be a power of two");
+_Static_assert(kDLOG_CONF_RECORD_MAX <= 0xff, "record lengths are stored in one byte");
+_Static_assert(kDLOG_CONF_STRING_MAX < 0x80, "string lengths are encoded as one-byte varints");
+
+static DlogStats dlog_stats;
+
+#ifndef CONFIG_DLOG_DISABLE
+
+/*
+ * 	Ring buffer of records, each preceded by its length byte. The indices are
+ * 	free-running: dlog_head is advanced by dlog_end() and dlog_tail by
+ * 	dlog_drain(), both with interrupts disabled.
+ */
+static uint8_t		 dlog_buffer[kDLOG_CONF_BUFFER_SIZE];
+static volatile uint32_t dlog_head    = 0;
+static volatile uint32_t dlog_tail    = 0;
+static volatile uint32_t dlog_pending = 0;
+static volatile uint32_t dlog_lost    = 0;
+
+/*
+ * 	UART bytes sent when the last frame ended: if nothing else was sent since,
+ * 	its trailing zero also delimits the next frame.
+ */
+static uint32_t dlog_tx_bytes	 = 0;
+static bool	dlog_clock_sent = false;
+
+static const char dlog_format_clock[] __attribute__((section(".dlog"), used)) = "dlog: clock %u Hz\n";
+static const char dlog_format_lost[] __attribute__((section(".dlog"), used))  = "dlog: %u records lost\n";
+
+
+static RAMFUNC void
+dlog_put_varint(DlogRecord *  record, uint32_t value)
+{
+	if (record->len + 5 > kDLOG_CONF_RECORD_MAX)
+	{
+		record->overflow = true;
+		return;
+	}
+
+	while (value >= 0x80)
+	{
+		record->buf[record->len++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+
+	record->buf[record->len++] = (uint8_t)value;
+}
+
+RAMFUNC void
+dlog_begin(DlogRecord *  record, uint32_t format_offset)
+{
+	record->len	 = 0;
+	record->overflow = false;
+
+	dlog_put_varint(record, format_offset);
+
+	/*
+	 * 	Latch the uptime counter, and only read its low word, which is the
+	 * 	second 32-bit CSR of the 64-bit register.
+	 */
+	timer0_uptime_latch_write(1);
+	uint32_t timestamp = csr_read_simple(CSR_TIMER0_UPTIME_CYCLES_ADDR + 4);
+
+	record->buf[record->len++] = (uint8_t)timestamp;
+	record->buf[record->len++] = (uint8_t)(timestamp >> 8);
+	record->buf[record->len++] = (uint8_t)(timestamp >> 16);
+	record->buf[record->len++] = (uint8_t)(timestamp >> 24);
+}
+
+RAMFUNC void
+dlog_put_i32(DlogRecord *  record, int32_t value)
+{
+	dlog_put_varint(record, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+RAMFUNC void
+dlog_put_i64(DlogRecord *  record, int64_t value)
+{
+	uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+
+	if (record->len + 10 > kDLOG_CONF_RECORD_MAX)
+	{
+		record->overflow = true;
+		return;
+	}
+
+	while (zigzag >= 0x80)
+	{
+		record->buf[record->len++] = (uint8_t)(zigzag | 0x80);
+		zigzag >>= 7;
+	}
+
+	record->buf[record->len++] = (uint8_t)zigzag;
+}
+
+RAMFUNC void
+dlog_put_string(DlogRecord *  record, const char *  str)
+{
+	if (str == NULL)
+	{
+		str = "(null)";
+	}
+
+	if (record->len + 1 > kDLOG_CONF_RECORD_MAX)
+	{
+		record->overflow = true;
+		return;
+	}
+
+	/*
+	 * 	Truncate the string to kDLOG_CONF_STRING_MAX, and to the room left in the record
+	 */
+	uint32_t room = kDLOG_CONF_RECORD_MAX - record->len - 1;
+	uint32_t len  = 0;
+
+	while (len < kDLOG_CONF_STRING_MAX && len < room && str[len] != '\0')
+	{
+		len++;
+	}
+
+	record->buf[record->len++] = (uint8_t)len;
+	memcpy(&record->buf[record->len], str, len);
+	record->len += len;
+}
+
+/**
+ * 	@brief Returns the free bytes of the ring buffer. Call with interrupts disabled.
+ */
+static inline uint32_t
+dlog_room(void)
+{
+	return kDLOG_CONF_BUFFER_SIZE - (dlog_head - dlog_tail);
+}
+
+/**
+ * 	@brief Copies a record into the ring buffer, which must have room for it. Call with interrupts disabled.
+ */
+static RAMFUNC void
+dlog_push(const DlogRecord *  record)
+{
+	uint32_t head = dlog_head;
+
+	dlog_buffer[head++ & (kDLOG_CONF_BUFFER_SIZE - 1)] = (uint8_t)record->len;
+	for (uint32_t i = 0; i < record->len; i++)
+	{
+		dlog_buffer[head++ & (kDLOG_CONF_BUFFER_SIZE - 1)] = record->buf[i];
+	}
+
+	dlog_head = head;
+	dlog_pending++;
+}
+
+RAMFUNC void
+dlog_end(DlogRecord *  record)
+{
+	uint32_t ie = irq_getie();
+
+	irq_setie(0);
+
+	dlog_stats.records++;
+
+	if (record->overflow)
+	{
+		dlog_lost++;
+		dlog_stats.lost++;
+	}
+	else if (dlog_lost == 0)
+	{
+		if (dlog_room() >= record->len + 1)
+		{
+			dlog_push(record);
+		}
+		else
+		{
+			dlog_lost++;
+			dlog_stats.lost++;
+		}
+	}
+	else
+	{
+		/*
+		 * 	After records were lost, a record of how many goes first, so that
+		 * 	the decoder reports them where they were lost.
+		 */
+		DlogRecord lost;
+
+		dlog_begin(&lost, (uint32_t)(uintptr_t)dlog_format_lost);
+		dlog_put_i32(&lost, (int32_t)dlog_lost);
+
+		if (dlog_room() >= lost.len + 1 + record->len + 1)
+		{
+			dlog_push(&lost);
+			dlog_push(record);
+			dlog_lost = 0;
+		}
+		else
+		{
+			dlog_lost++;
+			dlog_stats.lost++;
+		}
+	}
+
+	irq_setie(ie);
+}
+
+/**
+ * 	@brief Sends a record as a frame: the record and its CRC-16, COBS-encoded, between zero bytes.
+ */
+static void
+dlog_send(DlogRecord *  record)
+{
+	uint8_t		frame[COBS_ENCODED_MAX(kDLOG_CONF_RECORD_MAX + kDLOG_CONF_CRC_SIZE) + 2];
+	uint32_t	len = 0;
+	UartStats	uart_stats;
+
+	uint16_t crc = crc16_update(kCRC16_CONF_INIT, record->buf, record->len);
+	record->buf[record->len++] = (uint8_t)crc;
+	record->buf[record->len++] = (uint8_t)(crc >> 8);
+
+	/*
+	 * 	Only start with a delimiter when something else was sent since the previous frame
+	 */
+	uart_get_stats(&uart_stats);
+	if (uart_stats.tx_bytes != dlog_tx_bytes)
+	{
+		frame[len++] = 0;
+	}
+
+	len += cobs_encode(&frame[len], record->buf, record->len);
+	frame[len++] = 0;
+
+	for (uint32_t i = 0; i < len; i++)
+	{
+		uart_putchar((char)frame[i]);
+	}
+
+	dlog_tx_bytes = uart_stats.tx_bytes + len;
+
+	dlog_stats.frames++;
+	dlog_stats.frame_bytes += len;
+}
+
+/**
+ * 	@brief Sends one of dlog.c's own messages, with a single integer argument, straight away.
+ */
+static void
+dlog_send_message(const char *  format, uint32_t value)
+{
+	DlogRecord record;
+
+	dlog_begin(&record, (uint32_t)(uintptr_t)format);
+	dlog_put_i32(&record, (int32_t)value);
+	dlog_send(&record);
+}
+
+uint32_t
+dlog_drain(uint32_t max_records)
+{
+	uint32_t   sent	   = 0;
+	uint32_t   pending = 0;
+	DlogRecord record;
+
+	if (!dlog_clock_sent)
+	{
+		dlog_send_message(dlog_format_clock, (uint32_t)CONFIG_CLOCK_FREQUENCY);
+		dlog_clock_sent = true;
+	}
+
+	while (1)
+	{
+		uint32_t ie = irq_getie();
+
+		irq_setie(0);
+
+		pending = dlog_pending;
+
+		if ((pending == 0) || (sent == max_records))
+		{
+			/*
+			 * 	Records lost after the last one in the ring buffer
+			 */
+			uint32_t lost = pending == 0 ? dlog_lost : 0;
+			if (lost != 0)
+			{
+				dlog_lost = 0;
+			}
+
+			irq_setie(ie);
+
+			if (lost != 0)
+			{
+				dlog_send_message(dlog_format_lost, lost);
+			}
+			break;
+		}
+
+		/*
+		 * 	Copy the record out with interrupts disabled, then send it with them enabled.
+		 */
+		uint32_t tail = dlog_tail;
+
+		record.len	= dlog_buffer[tail++ & (kDLOG_CONF_BUFFER_SIZE - 1)];
+		record.overflow = false;
+		for (uint32_t i = 0; i < record.len; i++)
+		{
+			record.buf[i] = dlog_buffer[tail++ & (kDLOG_CONF_BUFFER_SIZE - 1)];
+		}
+
+		dlog_tail = tail;
+		dlog_pending--;
+
+		irq_setie(ie);
+
+		dlog_send(&record);
+		sent++;
+	}
+
+	return pending;
+}
+
+#else
+
+uint32_t
+dlog_drain(uint32_t max_records)
+{
+	(void)max_records;
+
+	return 0;
+}
+
+#endif
+
+void
+dlog_get_stats(DlogStats *  stats)
+{
+	uint32_t ie = irq_getie();
+
+	irq_setie(0);
+
+	*stats = dlog_stats;
+
+	irq_setie(ie);
+}
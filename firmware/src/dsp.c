@@ -0,0 +1,518 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <stdint.h>
+#include "dsp.h"
+#include "ramfunc.h"
+
+
+/*
+ * 	Quarter of a sine wave of 1024 points (2^kDSP_CONF_FFT_MAX_LOG2), sin(2 pi i / 1024) in Q15, for the FFT
+ * 	twiddle factors.
+ */
+static const RAMDATA DspQ15 dsp_sine_table[257] = {
+	0, 201, 402, 603, 804, 1005, 1206, 1407,
+	1608, 1809, 2009, 2210, 2411, 2611, 2811, 3012,
+	3212, 3412, 3612, 3812, 4011, 4211, 4410, 4609,
+	4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195,
+	6393, 6590, 6787, 6983, 7180, 7376, 7571, 7767,
+	7962, 8157, 8351, 8546, 8740, 8933, 9127, 9319,
+	9512, 9704, 9896, 10088, 10279, 10469, 10660, 10850,
+	11039, 11228, 11417, 11605, 11793, 11980, 12167, 12354,
+	12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828,
+	14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269,
+	15447, 15624, 15800, 15976, 16151, 16326, 16500, 16673,
+	16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+	18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358,
+	19520, 19681, 19841, 20001, 20160, 20318, 20475, 20632,
+	20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856,
+	22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028,
+	23170, 23312, 23453, 23593, 23732, 23870, 24008, 24144,
+	24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+	25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199,
+	26320, 26439, 26557, 26674, 26791, 26906, 27020, 27133,
+	27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002,
+	28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803,
+	28899, 28993, 29086, 29178, 29269, 29359, 29448, 29535,
+	29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+	30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784,
+	30853, 30920, 30986, 31050, 31114, 31177, 31238, 31298,
+	31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737,
+	31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099,
+	32138, 32177, 32214, 32251, 32286, 32319, 32352, 32383,
+	32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+	32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718,
+	32729, 32738, 32746, 32753, 32758, 32762, 32766, 32767,
+	32767,
+};
+
+
+/**
+ * 	@brief High word of a 32x32-bit product, a single mulh instruction on RV32IM.
+ */
+static inline int32_t
+dsp_mulh(int32_t a, int32_t b)
+{
+	return (int32_t)(((int64_t)a * b) >> 32);
+}
+
+/**
+ * 	@brief sin(2 pi phase / 1024), in Q15, from the quarter wave table.
+ */
+static inline int32_t
+dsp_sin_1024(uint32_t phase)
+{
+	uint32_t index = phase & 255;
+
+	switch ((phase >> 8) & 3)
+	{
+		case 0:
+			return dsp_sine_table[index];
+		case 1:
+			return dsp_sine_table[256 - index];
+		case 2:
+			return -dsp_sine_table[index];
+		default:
+			return -dsp_sine_table[256 - index];
+	}
+}
+
+RAMFUNC int64_t
+dsp_dot_q15(const DspQ15 *  a, const DspQ15 *  b, uint32_t n)
+{
+	int64_t	 acc = 0;
+	uint32_t i   = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		acc += (int32_t)a[i] * b[i];
+		acc += (int32_t)a[i + 1] * b[i + 1];
+		acc += (int32_t)a[i + 2] * b[i + 2];
+		acc += (int32_t)a[i + 3] * b[i + 3];
+	}
+
+	for (; i < n; i++)
+	{
+		acc += (int32_t)a[i] * b[i];
+	}
+
+	return acc;
+}
+
+RAMFUNC int64_t
+dsp_dot_q31(const DspQ31 *  a, const DspQ31 *  b, uint32_t n)
+{
+	int64_t	 acc = 0;
+	uint32_t i   = 0;
+
+	/*
+	 * 	The high word of a Q31 product is in Q30.
+	 */
+	for (; i + 4 <= n; i += 4)
+	{
+		acc += dsp_mulh(a[i], b[i]);
+		acc += dsp_mulh(a[i + 1], b[i + 1]);
+		acc += dsp_mulh(a[i + 2], b[i + 2]);
+		acc += dsp_mulh(a[i + 3], b[i + 3]);
+	}
+
+	for (; i < n; i++)
+	{
+		acc += dsp_mulh(a[i], b[i]);
+	}
+
+	return acc;
+}
+
+void
+dsp_fir_q15_init(DspFirQ15 *  fir, const DspQ15 *  coeffs, DspQ15 *  state, uint32_t taps)
+{
+	fir->coeffs = coeffs;
+	fir->state  = state;
+	fir->taps   = taps;
+	fir->index  = 0;
+
+	for (uint32_t i = 0; i < 2 * taps; i++)
+	{
+		state[i] = 0;
+	}
+}
+
+RAMFUNC void
+dsp_fir_q15(DspFirQ15 *  fir, const DspQ15 *  in, DspQ15 *  out, uint32_t n)
+{
+	const DspQ15 *	coeffs = fir->coeffs;
+	DspQ15 *	state  = fir->state;
+	uint32_t	taps   = fir->taps;
+	uint32_t	index  = fir->index;
+
+	for (uint32_t s = 0; s < n; s++)
+	{
+		/*
+		 * 	Every sample is stored twice, taps apart, so that the last taps samples are
+		 * 	always contiguous, newest first, from state[index], and the convolution has
+		 * 	no wrap-around.
+		 */
+		index			= (index == 0 ? taps : index) - 1;
+		state[index]		= in[s];
+		state[index + taps]	= in[s];
+
+		const DspQ15 *	history = &state[index];
+		int32_t		acc	= 1 << 14;
+		uint32_t	k	= 0;
+
+		for (; k + 4 <= taps; k += 4)
+		{
+			acc += (int32_t)coeffs[k] * history[k];
+			acc += (int32_t)coeffs[k + 1] * history[k + 1];
+			acc += (int32_t)coeffs[k + 2] * history[k + 2];
+			acc += (int32_t)coeffs[k + 3] * history[k + 3];
+		}
+
+		for (; k < taps; k++)
+		{
+			acc += (int32_t)coeffs[k] * history[k];
+		}
+
+		out[s] = dsp_q15_saturate(acc >> 15);
+	}
+
+	fir->index = index;
+}
+
+void
+dsp_biquad_q15_init(DspBiquadQ15 *  biquad, const DspBiquadCoeffsQ15 *  coeffs, DspBiquadStateQ15 *  state, uint32_t stages)
+{
+	biquad->coeffs = coeffs;
+	biquad->state  = state;
+	biquad->stages = stages;
+
+	for (uint32_t i = 0; i < stages; i++)
+	{
+		state[i] = (DspBiquadStateQ15){0};
+	}
+}
+
+RAMFUNC void
+dsp_biquad_q15(DspBiquadQ15 *  biquad, const DspQ15 *  in, DspQ15 *  out, uint32_t n)
+{
+	for (uint32_t stage = 0; stage < biquad->stages; stage++)
+	{
+		const DspBiquadCoeffsQ15 *	coeffs = &biquad->coeffs[stage];
+		DspBiquadStateQ15 *		state  = &biquad->state[stage];
+		const DspQ15 *			src    = (stage == 0) ? in : out;
+
+		int32_t b0 = coeffs->b0;
+		int32_t b1 = coeffs->b1;
+		int32_t b2 = coeffs->b2;
+		int32_t a1 = coeffs->a1;
+		int32_t a2 = coeffs->a2;
+		int32_t x1 = state->x1;
+		int32_t x2 = state->x2;
+		int32_t y1 = state->y1;
+		int32_t y2 = state->y2;
+
+		for (uint32_t i = 0; i < n; i++)
+		{
+			int32_t x = src[i];
+
+			/*
+			 * 	Each Q14 x Q15 product fits in 32 bits, but their sum may not.
+			 */
+			int64_t acc = (1 << 13);
+
+			acc += b0 * x;
+			acc += b1 * x1;
+			acc += b2 * x2;
+			acc -= a1 * y1;
+			acc -= a2 * y2;
+
+			int32_t y = dsp_q15_saturate((int32_t)(acc >> 14));
+
+			x2     = x1;
+			x1     = x;
+			y2     = y1;
+			y1     = y;
+			out[i] = (DspQ15)y;
+		}
+
+		state->x1 = (DspQ15)x1;
+		state->x2 = (DspQ15)x2;
+		state->y1 = (DspQ15)y1;
+		state->y2 = (DspQ15)y2;
+	}
+}
+
+void
+dsp_biquad_q31_init(DspBiquadQ31 *  biquad, const DspBiquadCoeffsQ31 *  coeffs, DspBiquadStateQ31 *  state, uint32_t stages)
+{
+	biquad->coeffs = coeffs;
+	biquad->state  = state;
+	biquad->stages = stages;
+
+	for (uint32_t i = 0; i < stages; i++)
+	{
+		state[i] = (DspBiquadStateQ31){0};
+	}
+}
+
+RAMFUNC void
+dsp_biquad_q31(DspBiquadQ31 *  biquad, const DspQ31 *  in, DspQ31 *  out, uint32_t n)
+{
+	for (uint32_t stage = 0; stage < biquad->stages; stage++)
+	{
+		const DspBiquadCoeffsQ31 *	coeffs = &biquad->coeffs[stage];
+		DspBiquadStateQ31 *		state  = &biquad->state[stage];
+		const DspQ31 *			src    = (stage == 0) ? in : out;
+
+		DspQ31 b0 = coeffs->b0;
+		DspQ31 b1 = coeffs->b1;
+		DspQ31 b2 = coeffs->b2;
+		DspQ31 a1 = coeffs->a1;
+		DspQ31 a2 = coeffs->a2;
+		DspQ31 x1 = state->x1;
+		DspQ31 x2 = state->x2;
+		DspQ31 y1 = state->y1;
+		DspQ31 y2 = state->y2;
+
+		for (uint32_t i = 0; i < n; i++)
+		{
+			DspQ31 x = src[i];
+
+			/*
+			 * 	The high words of the Q30 x Q31 products are in Q29.
+			 */
+			int64_t acc = 0;
+
+			acc += dsp_mulh(b0, x);
+			acc += dsp_mulh(b1, x1);
+			acc += dsp_mulh(b2, x2);
+			acc -= dsp_mulh(a1, y1);
+			acc -= dsp_mulh(a2, y2);
+
+			DspQ31 y = dsp_q31_saturate(acc * 4);
+
+			x2     = x1;
+			x1     = x;
+			y2     = y1;
+			y1     = y;
+			out[i] = y;
+		}
+
+		state->x1 = x1;
+		state->x2 = x2;
+		state->y1 = y1;
+		state->y2 = y2;
+	}
+}
+
+void
+dsp_iir1_q15_init(DspIir1Q15 *  iir, DspQ15 alpha)
+{
+	iir->alpha = alpha;
+	iir->y	   = 0;
+}
+
+RAMFUNC void
+dsp_iir1_q15(DspIir1Q15 *  iir, const DspQ15 *  in, DspQ15 *  out, uint32_t n)
+{
+	int32_t alpha = iir->alpha;
+	int32_t y     = iir->y;
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		/*
+		 * 	y is in Q29, so the difference fits in 32 bits.
+		 */
+		int32_t diff = ((int32_t)in[i] * (1 << 14)) - y;
+
+		y += (int32_t)(((int64_t)diff * alpha) >> 15);
+		out[i] = dsp_q15_saturate((y + (1 << 13)) >> 14);
+	}
+
+	iir->y = y;
+}
+
+void
+dsp_moving_average_q15_init(DspMovingAverageQ15 *  average, DspQ15 *  window, uint32_t length)
+{
+	average->window	    = window;
+	average->length	    = length;
+	average->index	    = 0;
+	average->sum	    = 0;
+	average->reciprocal = (uint32_t)(((1ull << 31) + length / 2) / length);
+
+	for (uint32_t i = 0; i < length; i++)
+	{
+		window[i] = 0;
+	}
+}
+
+RAMFUNC void
+dsp_moving_average_q15(DspMovingAverageQ15 *  average, const DspQ15 *  in, DspQ15 *  out, uint32_t n)
+{
+	DspQ15 *	window	   = average->window;
+	uint32_t	length	   = average->length;
+	uint32_t	index	   = average->index;
+	int32_t		sum	   = average->sum;
+	int64_t		reciprocal = average->reciprocal;
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		DspQ15 x = in[i];
+
+		sum += x - window[index];
+		window[index] = x;
+		index	      = (index + 1 == length) ? 0 : index + 1;
+
+		/*
+		 * 	Divides by length with a multiply by its Q31 reciprocal.
+		 */
+		out[i] = dsp_q15_saturate((int32_t)((sum * reciprocal + (1ll << 30)) >> 31));
+	}
+
+	average->index = index;
+	average->sum   = sum;
+}
+
+void
+dsp_welford_q15_init(DspWelfordQ15 *  welford)
+{
+	welford->count = 0;
+	welford->mean  = 0;
+	welford->m2    = 0;
+}
+
+RAMFUNC void
+dsp_welford_q15_update(DspWelfordQ15 *  welford, const DspQ15 *  in, uint32_t n)
+{
+	uint32_t count = welford->count;
+	int32_t	 mean  = welford->mean;
+	int64_t	 m2    = welford->m2;
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		/*
+		 * 	The mean keeps 14 extra fractional bits, so that the difference of a sample
+		 * 	and the mean fits in 32 bits. m2 drops 14 of the 28 extra fractional bits
+		 * 	of the product, so that it fits in 64 bits.
+		 */
+		int32_t x     = (int32_t)in[i] * (1 << 14);
+		int32_t delta = x - mean;
+
+		count++;
+		mean += delta / (int32_t)count;
+		m2 += ((int64_t)delta * (x - mean)) >> 14;
+	}
+
+	welford->count = count;
+	welford->mean  = mean;
+	welford->m2    = m2;
+}
+
+DspQ31
+dsp_welford_q15_mean(const DspWelfordQ15 *  welford)
+{
+	/*
+	 * 	The mean is in Q29.
+	 */
+	return welford->mean * 4;
+}
+
+DspQ31
+dsp_welford_q15_variance(const DspWelfordQ15 *  welford)
+{
+	if (welford->count < 2 || welford->m2 <= 0)
+	{
+		return 0;
+	}
+
+	/*
+	 * 	m2 is in Q44 (the product of two Q29 differences, minus 14 bits).
+	 */
+	return dsp_q31_saturate((welford->m2 / (int64_t)(welford->count - 1)) >> 13);
+}
+
+RAMFUNC void
+dsp_fft_q15(DspComplexQ15 *  data, uint32_t log2n)
+{
+	if (log2n > kDSP_CONF_FFT_MAX_LOG2)
+	{
+		return;
+	}
+
+	uint32_t n = 1u << log2n;
+
+	/*
+	 * 	Bit-reversal permutation.
+	 */
+	for (uint32_t i = 1, j = 0; i < n; i++)
+	{
+		uint32_t bit = n >> 1;
+
+		for (; j & bit; bit >>= 1)
+		{
+			j ^= bit;
+		}
+		j ^= bit;
+
+		if (i < j)
+		{
+			DspComplexQ15 swap = data[i];
+
+			data[i] = data[j];
+			data[j] = swap;
+		}
+	}
+
+	/*
+	 * 	Butterflies of span 2 * half. Twiddle k of a span is exp(-2 pi i k / (2 * half)),
+	 * 	which is entry k << shift of a 1024-point sine wave.
+	 */
+	uint32_t shift = kDSP_CONF_FFT_MAX_LOG2 - 1;
+
+	for (uint32_t half = 1; half < n; half <<= 1, shift--)
+	{
+		for (uint32_t k = 0; k < half; k++)
+		{
+			uint32_t phase = k << shift;
+			int32_t	 wr    = dsp_sin_1024(phase + 256);
+			int32_t	 wi    = -dsp_sin_1024(phase);
+
+			for (uint32_t i = k; i < n; i += 2 * half)
+			{
+				DspComplexQ15 *	a = &data[i];
+				DspComplexQ15 *	b = &data[i + half];
+
+				int32_t tr = ((int32_t)b->re * wr - (int32_t)b->im * wi + (1 << 14)) >> 15;
+				int32_t ti = ((int32_t)b->re * wi + (int32_t)b->im * wr + (1 << 14)) >> 15;
+				int32_t ar = a->re;
+				int32_t ai = a->im;
+
+				a->re = dsp_q15_saturate((ar + tr + 1) >> 1);
+				a->im = dsp_q15_saturate((ai + ti + 1) >> 1);
+				b->re = dsp_q15_saturate((ar - tr + 1) >> 1);
+				b->im = dsp_q15_saturate((ai - ti + 1) >> 1);
+			}
+		}
+	}
+}
@@ -0,0 +1,45 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+/*
+ * 	C entry points for the formats listed in FMT_SHIMS (include/fmt_shims.h),
+ * 	each compiled by fmt.h into straight-line code.
+ */
+
+#include "fmt.h"
+#include "fmt_shims.h"
+
+
+#define FMT_SHIM_DEFINE(name, string, ...)                                                               \
+	int name(FMT_SHIM_PARAMETERS(__VA_ARGS__))                                                       \
+	{                                                                                                \
+		return fmt::print<string>(FMT_SHIM_ARGUMENTS(__VA_ARGS__));                              \
+	}                                                                                                \
+                                                                                                         \
+	int name##_format(char *  buf, size_t size, FMT_SHIM_PARAMETERS(__VA_ARGS__))                    \
+	{                                                                                                \
+		return fmt::format<string>(buf, size, FMT_SHIM_ARGUMENTS(__VA_ARGS__));                  \
+	}
+
+FMT_SHIMS(FMT_SHIM_DEFINE)
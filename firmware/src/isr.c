@@ -0,0 +1,65 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <generated/csr.h>
+#include <generated/soc.h>
+#include <irq.h>
+#include "pcsample.h"
+#include "timers.h"
+#include "uart.h"
+#include "ramfunc.h"
+
+#include <stdint.h>
+
+
+/**
+ * 	@brief Interrupt Service Routine
+ *
+ * 	Handles all interrupts. It is called by the trap handler in crt0.S, and
+ * 	dispatches every pending, unmasked interrupt line to its peripheral driver.
+ */
+RAMFUNC void
+isr(void)
+{
+	uint32_t pending = irq_pending() & irq_getmask();
+
+	if (pending & (1 << UART_INTERRUPT))
+	{
+		uart_isr();
+	}
+
+#ifdef UART_TX_DMA_INTERRUPT
+	if (pending & (1 << UART_TX_DMA_INTERRUPT))
+	{
+		uart_tx_dma_isr();
+	}
+#endif
+
+	if (pending & (1 << TIMER0_INTERRUPT))
+	{
+#ifndef CONFIG_PCSAMPLE_DISABLE
+		pcsample_tick();
+#endif
+		timers_isr();
+	}
+}
@@ -25,6 +25,7 @@
 #include "leds.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 
 /**
@@ -33,14 +34,20 @@
 bool leds_red_is_on = false;
 bool leds_green_is_on = false;
 
+/**
+ * 	@brief Writes the saved state to the LEDs. SoCs without the LEDs block, e.g.
+ * 	the simulator used for the CPU variant benchmarks, only keep the state.
+ */
 void
 leds_set(void)
 {
+#ifdef CSR_LEDS_OUT_ADDR
 	leds_out_write(
 		0
 		| (leds_red_is_on << CSR_LEDS_OUT_RED_OFFSET)
 		| (leds_green_is_on << CSR_LEDS_OUT_GREEN_OFFSET)
 	);
+#endif
 }
 
 void
@@ -88,6 +95,11 @@ leds_init(void)
 {
 	leds_red_off();
 	leds_green_off();
+
+	leds_set_mode(kLedsRed, kLedsModeStatic);
+	leds_set_mode(kLedsGreen, kLedsModeStatic);
+	leds_set_brightness(kLedsRed, 255);
+	leds_set_brightness(kLedsGreen, 255);
 }
 
 void
@@ -97,3 +109,152 @@ leds_toggle(void)
 	leds_green_is_on = !leds_red_is_on;
 	leds_set();
 }
+
+bool
+leds_pattern_supported(void)
+{
+#ifdef CSR_LEDS_RED_PERIOD_ADDR
+	return true;
+#else
+	return false;
+#endif
+}
+
+#ifdef CSR_LEDS_RED_PERIOD_ADDR
+/**
+ * 	@brief Converts milliseconds to pattern generator ticks, clamped to the 16-bit tick counters.
+ */
+static uint32_t
+leds_ms_to_ticks(uint32_t ms)
+{
+	return (ms < kLEDS_CONF_MAX_MS ? ms : kLEDS_CONF_MAX_MS) * kLEDS_CONF_TICKS_PER_MS;
+}
+#endif
+
+void
+leds_set_mode(LedsLed led, LedsMode mode)
+{
+#ifdef CSR_LEDS_RED_PERIOD_ADDR
+	/*
+	 * 	Both LEDs have the same pattern generator CSR layout, so the red LED's field offsets are used for both.
+	 */
+	uint32_t config = (uint32_t)mode << CSR_LEDS_RED_CONFIG_MODE_OFFSET;
+
+	if (led == kLedsRed)
+	{
+		leds_red_config_write(config);
+	}
+	else
+	{
+		leds_green_config_write(config);
+	}
+#else
+	(void)led;
+	(void)mode;
+#endif
+}
+
+void
+leds_set_pattern(LedsLed led, const LedsPattern *  pattern)
+{
+#ifdef CSR_LEDS_RED_PERIOD_ADDR
+	uint32_t period = leds_ms_to_ticks(pattern->period_ms);
+	uint32_t duty	= leds_ms_to_ticks(pattern->on_ms);
+	uint32_t phase	= leds_ms_to_ticks(pattern->phase_ms);
+	uint32_t burst	= 0
+			| ((uint32_t)pattern->burst_count << CSR_LEDS_RED_BURST_COUNT_OFFSET)
+			| ((uint32_t)pattern->burst_gap << CSR_LEDS_RED_BURST_GAP_OFFSET);
+
+	if (led == kLedsRed)
+	{
+		leds_red_period_write(period);
+		leds_red_duty_write(duty);
+		leds_red_phase_write(phase);
+		leds_red_burst_write(burst);
+	}
+	else
+	{
+		leds_green_period_write(period);
+		leds_green_duty_write(duty);
+		leds_green_phase_write(phase);
+		leds_green_burst_write(burst);
+	}
+
+	leds_set_mode(led, kLedsModePattern);
+#else
+	(void)led;
+	(void)pattern;
+#endif
+}
+
+void
+leds_set_brightness(LedsLed led, uint8_t brightness)
+{
+#ifdef CSR_LEDS_RED_PERIOD_ADDR
+	if (led == kLedsRed)
+	{
+		leds_red_brightness_write(brightness);
+	}
+	else
+	{
+		leds_green_brightness_write(brightness);
+	}
+#else
+	(void)led;
+	(void)brightness;
+#endif
+}
+
+void
+leds_restart_patterns(void)
+{
+#ifdef CSR_LEDS_RED_PERIOD_ADDR
+	leds_restart_write(1 << CSR_LEDS_RESTART_RESTART_OFFSET);
+#endif
+}
+
+void
+leds_alternate(uint32_t period_ms)
+{
+	LedsPattern pattern = {
+		.period_ms	= 2 * period_ms,
+		.on_ms		= period_ms,
+		.phase_ms	= 0,
+		.burst_count	= 0,
+		.burst_gap	= 0,
+	};
+
+	leds_set_pattern(kLedsRed, &pattern);
+	leds_set_mode(kLedsGreen, kLedsModeAlternate);
+	leds_restart_patterns();
+}
+
+void
+leds_heartbeat(LedsLed led)
+{
+	LedsPattern pattern = {
+		.period_ms	= 1000,
+		.on_ms		= 50,
+		.phase_ms	= 0,
+		.burst_count	= 0,
+		.burst_gap	= 0,
+	};
+
+	leds_set_pattern(led, &pattern);
+	leds_restart_patterns();
+}
+
+void
+leds_status_code(LedsLed led, uint8_t code)
+{
+	LedsPattern pattern = {
+		.period_ms	= 400,
+		.on_ms		= 200,
+		.phase_ms	= 0,
+		.burst_count	= code,
+		.burst_gap	= 4,
+	};
+
+	leds_set_pattern(led, &pattern);
+	leds_restart_patterns();
+}
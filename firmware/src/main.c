@@ -22,9 +22,15 @@
 
 
 #include <generated/csr.h>
-#include <time.h>
+#include <stddef.h>
+#include "dlog.h"
 #include "uart.h"
 #include "leds.h"
+#include "profile.h"
+#include "sched.h"
+#include "spiflash.h"
+#include "stack.h"
+#include "timers.h"
 
 
 /*
@@ -33,75 +39,146 @@
 typedef enum
 {
 	kAppConfigLedTogglePeriodMs = 250,
+
+	/*
+	 * 	Deferred log records sent per run of the log task, so that it yields to
+	 * 	higher priority tasks in between.
+	 */
+	kAppConfigLogRecordsPerRun = 8,
 } AppConfig;
 
+/*
+ * 	Task priorities, 0 being the highest.
+ */
+typedef enum
+{
+	kAppTaskUartEcho = 0,
+	kAppTaskLed	 = 1,
+	kAppTaskLog	 = 2,
+} AppTask;
+
+
+static SchedTask       app_uart_echo_task;
+static SchedTask       app_led_task;
+static SchedTask       app_log_task;
+static TimerWheelTimer app_led_timer;
+
 
 /**
- * 	@brief Interrupt Service Routine
- *
- * 	Handles all interrupts
- *
- * 	* Currently does nothing, because we do not implement interrupts.
+ * 	@brief Echoes every byte received so far. Posted by the UART RX interrupt.
  */
-void
-isr(void)
+static void
+app_uart_echo(void *  ctx)
 {
-	;
+	(void)ctx;
+	uart_echo();
 }
 
+static void
+app_uart_rx_callback(void)
+{
+	sched_post(&app_uart_echo_task);
+}
 
 /**
- * 	@brief The setup function
- * 	This is called once, before the main loop, and is responsible for
- * 	configuring peripherals.
+ * 	@brief Sends the deferred log records (see dlog.h), when no other task is ready.
  */
 static void
-setup(void)
+app_log(void *  ctx)
 {
-	timer0_init();
-	leds_init();
+	(void)ctx;
+
+	if (dlog_drain(kAppConfigLogRecordsPerRun) != 0)
+	{
+		sched_post(&app_log_task);
+	}
 }
 
 /**
- * 	@brief The main loop.
- * 	This is called infinitely, and is only interrupted by interrupts handled by
- * 	the Interrupt Service Routine (ISR).
+ * 	@brief Toggles the LEDs. Posted by the LED timer every kAppConfigLedTogglePeriodMs, on gateware
+ * 	without the LED pattern generators.
  */
 static void
-loop(void)
+app_led(void *  ctx)
 {
-	uart_echo();
+	(void)ctx;
 
-	/*
-	 * 	Toggle LEDs every 500ms
-	 */
-	if (timer0_is_expired())
+	leds_toggle();
+	if (leds_red_get())
+	{
+		DLOG("LED: Red\n");
+	}
+	else
 	{
-		leds_toggle();
-		if (leds_red_get())
-		{
-			uart_printf("LED: Red\n");
-		}
-		else
-		{
-			uart_printf("LED: Green\n");
-		}
-		timer0_set_one_shot_mode_ms(kAppConfigLedTogglePeriodMs);
+		DLOG("LED: Green\n");
+	}
+
+	sched_post(&app_log_task);
+}
+
+static void
+app_led_timer_callback(void *  ctx)
+{
+	(void)ctx;
+	sched_post(&app_led_task);
+}
+
+/**
+ * 	@brief The setup function
+ * 	This is called once, before the scheduler starts, and is responsible for
+ * 	configuring peripherals, and the tasks and the interrupts posting them.
+ */
+static void
+setup(void)
+{
+	spiflash_init();
+	timers_init();
+	leds_init();
+	uart_init();
+	profile_init();
+
+	sched_task_init(&app_uart_echo_task, kAppTaskUartEcho, "uart_echo", app_uart_echo, NULL);
+	sched_task_init(&app_led_task, kAppTaskLed, "led", app_led, NULL);
+	sched_task_init(&app_log_task, kAppTaskLog, "log", app_log, NULL);
+
+	uart_set_rx_callback(app_uart_rx_callback);
+
+	if (leds_pattern_supported())
+	{
+		/*
+		 * 	The gateware's pattern generators blink the LEDs, with no timer, task, or interrupt.
+		 */
+		leds_alternate(kAppConfigLedTogglePeriodMs);
+		DLOG("LED: Red and Green alternating in hardware\n");
+		sched_post(&app_log_task);
+	}
+	else
+	{
+		timers_start_ms(
+			&app_led_timer,
+			kAppConfigLedTogglePeriodMs,
+			kAppConfigLedTogglePeriodMs,
+			app_led_timer_callback,
+			NULL);
 	}
 }
 
 /**
  * 	@brief The main entry point
+ * 	After setup, the scheduler runs the tasks as the interrupts handled by the
+ * 	Interrupt Service Routine (ISR), in isr.c, post them, and sleeps in between.
  */
 int
 main(void)
 {
+	/*
+	 * 	First, so that stack_high_water() sees all the stack used afterwards.
+	 */
+	stack_paint();
+
 	setup();
 
-	while (1)
-	{
-		loop();
-	}
+	sched_run();
 
 	return 0;
 }
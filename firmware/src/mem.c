@@ -0,0 +1,365 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+/*
+ * 	Word-oriented memcpy(), memmove(), memset(), memcmp() and strlen().
+ *
+ * 	They replace the C library's byte-oriented versions at link time, since
+ * 	the firmware objects are linked before the library, and are RAMFUNC, so
+ * 	that they do not fetch every loop iteration from the flash. Word accesses
+ * 	are always aligned, since the CPU traps on misaligned ones: the head is
+ * 	copied byte by byte until the destination is aligned, and a source of a
+ * 	different alignment is read in aligned words, which are shifted together.
+ *
+ * 	Each function is compiled without -ftree-loop-distribute-patterns, which
+ * 	would turn its own byte loops into calls to itself. The static helpers are
+ * 	always inlined, so that they are never emitted out of line, in flash, and
+ * 	without that option. tools/ramtext_check.py checks mem.o for both, after
+ * 	every link, and host/Makefile on a host build of mem.c.
+ *
+ * 	The host build (host/mem_bench.c) defines CONFIG_MEM_HOST, which prefixes
+ * 	the names with mem_, so that they do not replace the host's C library.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ramfunc.h"
+
+
+#ifdef CONFIG_MEM_HOST
+	#define MEM_FUNCTION(name)	mem_##name
+#else
+	#define MEM_FUNCTION(name)	name
+#endif
+
+/*
+ * 	used, so that LTO keeps the definitions of functions which are only
+ * 	called by code the compiler generates, e.g. for structure copies.
+ */
+#define MEM_ATTRIBUTES		RAMFUNC __attribute__((used, optimize("no-tree-loop-distribute-patterns")))
+#define MEM_HELPER_ATTRIBUTES	__attribute__((always_inline, optimize("no-tree-loop-distribute-patterns")))
+
+typedef enum MEM_CONF_enum
+{
+	/*
+	 * 	Shorter operations are done byte by byte, since aligning would cost more than it saves.
+	 */
+	kMEM_CONF_WORD_THRESHOLD	= 8,
+} MEM_CONF;
+
+/*
+ * 	A word which may alias any other type.
+ */
+typedef uint32_t __attribute__((may_alias)) MemWord;
+
+static const uint32_t kMemOnes	= 0x01010101;
+static const uint32_t kMemHighs = 0x80808080;
+
+
+/*
+ * 	Non-zero if any byte of word is zero: subtracting 1 from each byte only
+ * 	borrows into its high bit, which was clear, when the byte was zero.
+ */
+static inline MEM_HELPER_ATTRIBUTES uint32_t
+mem_has_zero(uint32_t word)
+{
+	return (word - kMemOnes) & ~word & kMemHighs;
+}
+
+/*
+ * 	Copies forwards, which is also correct for overlapping buffers when dst is below src, since every
+ * 	word is loaded before the stores of its group, and stores never reach the source words not loaded yet.
+ */
+static inline MEM_HELPER_ATTRIBUTES void
+mem_copy_forward(uint8_t *  dst, const uint8_t *  src, size_t n)
+{
+	if (n >= kMEM_CONF_WORD_THRESHOLD)
+	{
+		while ((uintptr_t)dst & 3)
+		{
+			*dst++ = *src++;
+			n--;
+		}
+
+		MemWord *  dst_words = (MemWord *)dst;
+		uint32_t   offset    = (uintptr_t)src & 3;
+
+		if (offset == 0)
+		{
+			const MemWord *	 src_words = (const MemWord *)src;
+
+			while (n >= 16)
+			{
+				uint32_t word0 = src_words[0];
+				uint32_t word1 = src_words[1];
+				uint32_t word2 = src_words[2];
+				uint32_t word3 = src_words[3];
+
+				dst_words[0] = word0;
+				dst_words[1] = word1;
+				dst_words[2] = word2;
+				dst_words[3] = word3;
+				dst_words += 4;
+				src_words += 4;
+				n -= 16;
+			}
+
+			while (n >= 4)
+			{
+				*dst_words++ = *src_words++;
+				n -= 4;
+			}
+
+			src = (const uint8_t *)src_words;
+		}
+		else
+		{
+			/*
+			 * 	Little-endian: each destination word is the top bytes of a source word, and the bottom
+			 * 	bytes of the next one. The aligned loads never go beyond the word holding the last
+			 * 	source byte.
+			 */
+			const MemWord *	 src_words = (const MemWord *)(src - offset);
+			uint32_t	 low_shift = offset * 8;
+			uint32_t	 high_shift = 32 - low_shift;
+			uint32_t	 previous  = *src_words++;
+
+			while (n >= 4)
+			{
+				uint32_t next = *src_words++;
+
+				*dst_words++ = (previous >> low_shift) | (next << high_shift);
+				previous     = next;
+				n -= 4;
+			}
+
+			src = (const uint8_t *)src_words - 4 + offset;
+		}
+
+		dst = (uint8_t *)dst_words;
+	}
+
+	while (n--)
+	{
+		*dst++ = *src++;
+	}
+}
+
+MEM_ATTRIBUTES void *
+MEM_FUNCTION(memcpy)(void * restrict dst, const void * restrict src, size_t n)
+{
+	mem_copy_forward(dst, src, n);
+
+	return dst;
+}
+
+MEM_ATTRIBUTES void *
+MEM_FUNCTION(memmove)(void *  dst, const void *  src, size_t n)
+{
+	uint8_t *	 d = dst;
+	const uint8_t *	 s = src;
+
+	if ((uintptr_t)d - (uintptr_t)s >= n)
+	{
+		/*
+		 * 	dst is below src, or the buffers do not overlap.
+		 */
+		mem_copy_forward(d, s, n);
+
+		return dst;
+	}
+
+	d += n;
+	s += n;
+
+	/*
+	 * 	Backwards. Only buffers of the same alignment are copied in words.
+	 */
+	if ((n >= kMEM_CONF_WORD_THRESHOLD) && ((((uintptr_t)d ^ (uintptr_t)s) & 3) == 0))
+	{
+		while ((uintptr_t)d & 3)
+		{
+			*--d = *--s;
+			n--;
+		}
+
+		MemWord *	 dst_words = (MemWord *)d;
+		const MemWord *	 src_words = (const MemWord *)s;
+
+		while (n >= 16)
+		{
+			uint32_t word3 = src_words[-1];
+			uint32_t word2 = src_words[-2];
+			uint32_t word1 = src_words[-3];
+			uint32_t word0 = src_words[-4];
+
+			dst_words[-1] = word3;
+			dst_words[-2] = word2;
+			dst_words[-3] = word1;
+			dst_words[-4] = word0;
+			dst_words -= 4;
+			src_words -= 4;
+			n -= 16;
+		}
+
+		while (n >= 4)
+		{
+			*--dst_words = *--src_words;
+			n -= 4;
+		}
+
+		d = (uint8_t *)dst_words;
+		s = (const uint8_t *)src_words;
+	}
+
+	while (n--)
+	{
+		*--d = *--s;
+	}
+
+	return dst;
+}
+
+MEM_ATTRIBUTES void *
+MEM_FUNCTION(memset)(void *  dst, int c, size_t n)
+{
+	uint8_t * d = dst;
+
+	if (n >= kMEM_CONF_WORD_THRESHOLD)
+	{
+		while ((uintptr_t)d & 3)
+		{
+			*d++ = c;
+			n--;
+		}
+
+		MemWord *  words = (MemWord *)d;
+		uint32_t   word	 = (uint8_t)c * kMemOnes;
+
+		while (n >= 16)
+		{
+			words[0] = word;
+			words[1] = word;
+			words[2] = word;
+			words[3] = word;
+			words += 4;
+			n -= 16;
+		}
+
+		while (n >= 4)
+		{
+			*words++ = word;
+			n -= 4;
+		}
+
+		d = (uint8_t *)words;
+	}
+
+	while (n--)
+	{
+		*d++ = c;
+	}
+
+	return dst;
+}
+
+MEM_ATTRIBUTES int
+MEM_FUNCTION(memcmp)(const void *  a, const void *  b, size_t n)
+{
+	const uint8_t *	 x = a;
+	const uint8_t *	 y = b;
+
+	/*
+	 * 	Equal words are skipped, and the first differing one is compared byte by byte below.
+	 */
+	if ((n >= kMEM_CONF_WORD_THRESHOLD) && ((((uintptr_t)x ^ (uintptr_t)y) & 3) == 0))
+	{
+		while ((uintptr_t)x & 3)
+		{
+			if (*x != *y)
+			{
+				return *x - *y;
+			}
+			x++;
+			y++;
+			n--;
+		}
+
+		while ((n >= 4) && (*(const MemWord *)x == *(const MemWord *)y))
+		{
+			x += 4;
+			y += 4;
+			n -= 4;
+		}
+	}
+
+	while (n--)
+	{
+		if (*x != *y)
+		{
+			return *x - *y;
+		}
+		x++;
+		y++;
+	}
+
+	return 0;
+}
+
+/*
+ * 	Reads the whole aligned word holding the terminator, which may extend past the string, but never
+ * 	into another word.
+ */
+MEM_ATTRIBUTES size_t
+MEM_FUNCTION(strlen)(const char *  s)
+{
+	const char *  p = s;
+
+	while ((uintptr_t)p & 3)
+	{
+		if (*p == '\0')
+		{
+			return p - s;
+		}
+		p++;
+	}
+
+	const MemWord *	 words = (const MemWord *)p;
+
+	while (!mem_has_zero(words[0]))
+	{
+		if (mem_has_zero(words[1]))
+		{
+			words += 1;
+			break;
+		}
+		words += 2;
+	}
+
+	p = (const char *)words;
+	while (*p != '\0')
+	{
+		p++;
+	}
+
+	return p - s;
+}
@@ -0,0 +1,126 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <irq.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "pcsample.h"
+#include "ramfunc.h"
+#include "uart.h"
+
+
+/*
+ * 	Start and end of the code in flash, from the linker script.
+ */
+extern uint8_t _ftext[];
+extern uint8_t _etext[];
+
+static uint32_t		 pcsample_buckets[kPCSAMPLE_CONF_BUCKETS];
+static uint32_t		 pcsample_shift	  = kPCSAMPLE_CONF_MIN_SHIFT;
+static uint32_t		 pcsample_samples = 0;
+static uint32_t		 pcsample_other	  = 0;
+static volatile bool	 pcsample_enabled = false;
+
+
+void
+pcsample_start(void)
+{
+	uint32_t ie    = irq_getie();
+	uint32_t range = (uintptr_t)_etext - (uintptr_t)_ftext;
+
+	irq_setie(0);
+
+	pcsample_shift = kPCSAMPLE_CONF_MIN_SHIFT;
+	while ((range >> pcsample_shift) >= kPCSAMPLE_CONF_BUCKETS)
+	{
+		pcsample_shift++;
+	}
+
+	for (uint32_t i = 0; i < kPCSAMPLE_CONF_BUCKETS; i++)
+	{
+		pcsample_buckets[i] = 0;
+	}
+
+	pcsample_samples = 0;
+	pcsample_other	 = 0;
+	pcsample_enabled = true;
+
+	irq_setie(ie);
+}
+
+void
+pcsample_stop(void)
+{
+	pcsample_enabled = false;
+}
+
+/*
+ * 	Called from the interrupt handler, so mepc still holds the address of the
+ * 	instruction the interrupt was taken at.
+ */
+RAMFUNC void
+pcsample_tick(void)
+{
+	uint32_t pc;
+
+	if (!pcsample_enabled)
+	{
+		return;
+	}
+
+	__asm__ volatile("csrr %0, mepc" : "=r"(pc));
+
+	uint32_t offset = pc - (uintptr_t)_ftext;
+
+	if (offset < (uintptr_t)_etext - (uintptr_t)_ftext)
+	{
+		pcsample_buckets[offset >> pcsample_shift]++;
+	}
+	else
+	{
+		pcsample_other++;
+	}
+
+	pcsample_samples++;
+}
+
+uint32_t
+pcsample_count(void)
+{
+	return pcsample_samples;
+}
+
+void
+pcsample_dump(void)
+{
+	uart_printf("pcsample: base 0x%x shift %u samples %u\n", (uint32_t)(uintptr_t)_ftext, pcsample_shift, pcsample_samples);
+
+	for (uint32_t i = 0; i < kPCSAMPLE_CONF_BUCKETS; i++)
+	{
+		if (pcsample_buckets[i] != 0)
+		{
+			uart_printf("pcsample: 0x%x %u\n", i << pcsample_shift, pcsample_buckets[i]);
+		}
+	}
+
+	uart_printf("pcsample: other %u\n", pcsample_other);
+}
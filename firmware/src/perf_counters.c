@@ -0,0 +1,205 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <generated/csr.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "perf_counters.h"
+#include "ramfunc.h"
+#include "uart.h"
+
+
+typedef enum PERF_COUNTERS_CONF_enum
+{
+	/*
+	 * 	Snapshot pairs taken by perf_counters_init() to measure the counts of taking a snapshot.
+	 */
+	kPERF_COUNTERS_CONF_CALIBRATION_SAMPLES = 8,
+} PERF_COUNTERS_CONF;
+
+/*
+ * 	Counts of taking a snapshot, subtracted by perf_counters_diff().
+ */
+static PerfCounters perf_counters_overhead;
+
+static bool perf_counters_enabled = true;
+
+
+bool
+perf_counters_supported(void)
+{
+#ifdef CSR_PERF_CYCLES_ADDR
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * 	@brief Writes the control register, keeping the enable bit, with the pulse bits in flags.
+ */
+static RAMFUNC void
+perf_counters_control(uint32_t flags)
+{
+#ifdef CSR_PERF_CYCLES_ADDR
+	perf_control_write(((uint32_t)perf_counters_enabled << CSR_PERF_CONTROL_ENABLE_OFFSET) | flags);
+#else
+	(void)flags;
+#endif
+}
+
+static uint32_t
+perf_counters_sub(uint32_t end, uint32_t start, uint32_t overhead)
+{
+	uint32_t delta = end - start;
+
+	return delta > overhead ? delta - overhead : 0;
+}
+
+static uint32_t
+perf_counters_min(uint32_t a, uint32_t b)
+{
+	return a < b ? a : b;
+}
+
+void
+perf_counters_init(void)
+{
+	PerfCounters start;
+	PerfCounters end;
+
+	perf_counters_overhead = (PerfCounters){0};
+	perf_counters_enable(true);
+	perf_counters_reset();
+
+	/*
+	 * 	Take back-to-back snapshots the way callers do, and keep the smallest counts,
+	 * 	which are not inflated by interrupts.
+	 */
+	PerfCounters overhead = {
+		.cycles = UINT32_MAX,
+		.flash	= {UINT32_MAX, UINT32_MAX},
+		.sram	= {UINT32_MAX, UINT32_MAX},
+		.csr	= {UINT32_MAX, UINT32_MAX},
+	};
+
+	for (int i = 0; i < kPERF_COUNTERS_CONF_CALIBRATION_SAMPLES; i++)
+	{
+		perf_counters_snapshot(&start);
+		perf_counters_snapshot(&end);
+		perf_counters_diff(&start, &end, &end);
+
+		overhead.cycles		= perf_counters_min(overhead.cycles, end.cycles);
+		overhead.flash.accesses	= perf_counters_min(overhead.flash.accesses, end.flash.accesses);
+		overhead.flash.waits	= perf_counters_min(overhead.flash.waits, end.flash.waits);
+		overhead.sram.accesses	= perf_counters_min(overhead.sram.accesses, end.sram.accesses);
+		overhead.sram.waits	= perf_counters_min(overhead.sram.waits, end.sram.waits);
+		overhead.csr.accesses	= perf_counters_min(overhead.csr.accesses, end.csr.accesses);
+		overhead.csr.waits	= perf_counters_min(overhead.csr.waits, end.csr.waits);
+	}
+
+	perf_counters_overhead = overhead;
+}
+
+void
+perf_counters_reset(void)
+{
+#ifdef CSR_PERF_CYCLES_ADDR
+	perf_counters_control(1 << CSR_PERF_CONTROL_RESET_OFFSET);
+#endif
+}
+
+void
+perf_counters_enable(bool enable)
+{
+	perf_counters_enabled = enable;
+	perf_counters_control(0);
+}
+
+RAMFUNC void
+perf_counters_snapshot(PerfCounters *  snapshot)
+{
+#ifdef CSR_PERF_CYCLES_ADDR
+	perf_counters_control(1 << CSR_PERF_CONTROL_LATCH_OFFSET);
+
+	snapshot->cycles	 = perf_cycles_read();
+	snapshot->flash.accesses = perf_flash_accesses_read();
+	snapshot->flash.waits	 = perf_flash_waits_read();
+	snapshot->sram.accesses	 = perf_sram_accesses_read();
+	snapshot->sram.waits	 = perf_sram_waits_read();
+	snapshot->csr.accesses	 = perf_csr_accesses_read();
+	snapshot->csr.waits	 = perf_csr_waits_read();
+#else
+	*snapshot = (PerfCounters){0};
+#endif
+}
+
+void
+perf_counters_diff(const PerfCounters *  start, const PerfCounters *  end, PerfCounters *  diff)
+{
+	const PerfCounters *  overhead = &perf_counters_overhead;
+
+	*diff = (PerfCounters){
+		.cycles = perf_counters_sub(end->cycles, start->cycles, overhead->cycles),
+		.flash	= {
+			perf_counters_sub(end->flash.accesses, start->flash.accesses, overhead->flash.accesses),
+			perf_counters_sub(end->flash.waits, start->flash.waits, overhead->flash.waits),
+		},
+		.sram	= {
+			perf_counters_sub(end->sram.accesses, start->sram.accesses, overhead->sram.accesses),
+			perf_counters_sub(end->sram.waits, start->sram.waits, overhead->sram.waits),
+		},
+		.csr	= {
+			perf_counters_sub(end->csr.accesses, start->csr.accesses, overhead->csr.accesses),
+			perf_counters_sub(end->csr.waits, start->csr.waits, overhead->csr.waits),
+		},
+	};
+}
+
+/**
+ * 	@brief Prints one region's counters, with its wait states as a percentage of cycles.
+ */
+static void
+perf_counters_print_region(const char *  region, const PerfCountersRegion *  counters, uint32_t cycles)
+{
+	uint32_t permille = cycles == 0 ? 0 : (uint32_t)(((uint64_t)counters->waits * 1000) / cycles);
+
+	uart_printf(
+		"  %*s %*u accesses %*u waits (%u.%u%%)\n",
+		6,
+		region,
+		10,
+		counters->accesses,
+		10,
+		counters->waits,
+		permille / 10,
+		permille % 10);
+}
+
+void
+perf_counters_print(const char *  name, const PerfCounters *  counters)
+{
+	uart_printf("perf: %s: %u cycles\n", name, counters->cycles);
+	perf_counters_print_region("flash", &counters->flash, counters->cycles);
+	perf_counters_print_region("sram", &counters->sram, counters->cycles);
+	perf_counters_print_region("csr", &counters->csr, counters->cycles);
+}
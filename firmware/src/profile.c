@@ -0,0 +1,185 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <generated/soc.h>
+#include <irq.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "profile.h"
+#include "ramfunc.h"
+#include "uart.h"
+
+
+typedef enum PROFILE_CONF_enum
+{
+	/*
+	 * 	Samples taken by profile_init() to measure the cost of taking a sample.
+	 */
+	kPROFILE_CONF_CALIBRATION_SAMPLES = 16,
+} PROFILE_CONF;
+
+/*
+ * 	Registered regions, most recently registered first.
+ */
+static ProfileRegion *profile_regions = NULL;
+
+/*
+ * 	Cycles of an empty region, subtracted from every sample.
+ */
+static uint32_t profile_overhead = 0;
+
+
+void
+profile_init(void)
+{
+	uint32_t overhead = UINT32_MAX;
+
+	/*
+	 * 	Time an empty region the way callers do, and keep the fastest sample,
+	 * 	which is not inflated by interrupts.
+	 */
+	for (int i = 0; i < kPROFILE_CONF_CALIBRATION_SAMPLES; i++)
+	{
+		uint64_t start	= profile_now();
+		uint32_t cycles = (uint32_t)(profile_now() - start);
+
+		if (cycles < overhead)
+		{
+			overhead = cycles;
+		}
+	}
+
+	profile_overhead = overhead;
+}
+
+RAMFUNC void
+profile_stop(ProfileRegion *  region, uint64_t start)
+{
+	uint64_t elapsed = profile_now() - start;
+	uint32_t cycles	 = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+	uint32_t ie	 = irq_getie();
+
+	cycles = cycles > profile_overhead ? cycles - profile_overhead : 0;
+
+	irq_setie(0);
+
+	if (!region->registered)
+	{
+		region->registered = true;
+		region->next	   = profile_regions;
+		profile_regions	   = region;
+	}
+
+	region->count++;
+	region->total += cycles;
+	if (cycles < region->min)
+	{
+		region->min = cycles;
+	}
+	if (cycles > region->max)
+	{
+		region->max = cycles;
+	}
+
+	irq_setie(ie);
+}
+
+RAMFUNC void
+profile_scope_exit(ProfileScope *  scope)
+{
+	profile_stop(scope->region, scope->start);
+}
+
+void
+profile_reset(void)
+{
+	uint32_t ie = irq_getie();
+
+	irq_setie(0);
+
+	for (ProfileRegion *region = profile_regions; region != NULL; region = region->next)
+	{
+		region->count = 0;
+		region->min   = UINT32_MAX;
+		region->max   = 0;
+		region->total = 0;
+	}
+
+	irq_setie(ie);
+}
+
+void
+profile_dump(void)
+{
+	uart_printf(
+		"%*s %*s %*s %*s %*s %*s\n",
+		20,
+		"region",
+		10,
+		"count",
+		10,
+		"min",
+		10,
+		"mean",
+		10,
+		"max",
+		14,
+		"total");
+
+	for (ProfileRegion *region = profile_regions; region != NULL; region = region->next)
+	{
+		ProfileRegion snapshot;
+		uint32_t      ie = irq_getie();
+
+		irq_setie(0);
+		snapshot = *region;
+		irq_setie(ie);
+
+		if (snapshot.count == 0)
+		{
+			continue;
+		}
+
+		uart_printf(
+			"%*s %*u %*u %*u %*u %*llu\n",
+			20,
+			snapshot.name,
+			10,
+			snapshot.count,
+			10,
+			snapshot.min,
+			10,
+			(uint32_t)(snapshot.total / snapshot.count),
+			10,
+			snapshot.max,
+			14,
+			snapshot.total);
+	}
+
+	uart_printf(
+		"cycles at %u Hz, %u cycles of overhead subtracted per sample\n",
+		(uint32_t)CONFIG_CLOCK_FREQUENCY,
+		profile_overhead);
+}
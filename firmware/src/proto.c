@@ -0,0 +1,285 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "cobs.h"
+#include "crc16.h"
+#include "proto.h"
+#include "ramfunc.h"
+#include "uart.h"
+
+
+typedef enum PROTO_BUFFER_CONF_enum
+{
+	/*
+	 * 	Encoded frame, without its zero delimiter.
+	 */
+	kPROTO_BUFFER_CONF_ENCODED_MAX	= COBS_ENCODED_MAX(kPROTO_CONF_FRAME_MAX),
+
+	/*
+	 * 	Bytes read from the UART at once.
+	 */
+	kPROTO_BUFFER_CONF_READ_CHUNK	= 32,
+} PROTO_BUFFER_CONF;
+
+/*
+ * 	Response to a request which may be resent.
+ */
+typedef struct
+{
+	bool		valid;
+	uint8_t		seq;
+	uint32_t	len;
+	uint8_t		frame[kPROTO_CONF_FRAME_MAX];
+} ProtoCachedResponse;
+
+
+static const ProtoCommand *	proto_commands	    = NULL;
+static uint32_t			proto_command_count = 0;
+
+/*
+ * 	Encoded frame being received. After an overflow, bytes are dropped until the next delimiter.
+ */
+static uint8_t	proto_rx[kPROTO_BUFFER_CONF_ENCODED_MAX];
+static uint32_t proto_rx_len	  = 0;
+static bool	proto_rx_overflow = false;
+
+static uint8_t		   proto_request[kPROTO_CONF_FRAME_MAX];
+static uint8_t		   proto_tx[kPROTO_BUFFER_CONF_ENCODED_MAX + 1];
+static ProtoCachedResponse proto_responses[kPROTO_CONF_WINDOW];
+static uint8_t		   proto_expected_seq = 0;
+static ProtoStats	   proto_stats;
+
+
+static void
+proto_send(const ProtoCachedResponse *  response)
+{
+	uint32_t len = cobs_encode(proto_tx, response->frame, response->len);
+
+	proto_tx[len++] = 0;
+
+	for (uint32_t i = 0; i < len; i++)
+	{
+		uart_putchar((char)proto_tx[i]);
+	}
+
+	proto_stats.frames_tx++;
+}
+
+static int32_t
+proto_dispatch(uint8_t id, const uint8_t *  request, uint32_t request_len, uint8_t *  response)
+{
+	switch (id)
+	{
+	case kProtoCommandSync:
+		return 0;
+
+	case kProtoCommandInfo:
+		response[0] = kPROTO_CONF_VERSION;
+		response[1] = kPROTO_CONF_WINDOW;
+		response[2] = kPROTO_CONF_MAX_PAYLOAD & 0xff;
+		response[3] = kPROTO_CONF_MAX_PAYLOAD >> 8;
+		return 4;
+
+	case kProtoCommandEcho:
+		memcpy(response, request, request_len);
+		return (int32_t)request_len;
+
+	default:
+		break;
+	}
+
+	for (uint32_t i = 0; i < proto_command_count; i++)
+	{
+		if (proto_commands[i].id == id)
+		{
+			return proto_commands[i].handler(request, request_len, response, kPROTO_CONF_MAX_PAYLOAD);
+		}
+	}
+
+	return -kProtoStatusUnknownCommand;
+}
+
+static void
+proto_handle_frame(uint32_t len)
+{
+	if (len < kPROTO_CONF_OVERHEAD)
+	{
+		proto_stats.framing_errors++;
+		return;
+	}
+
+	uint16_t crc = proto_request[len - 2] | (proto_request[len - 1] << 8);
+
+	if (crc16_update(kCRC16_CONF_INIT, proto_request, len - 2) != crc)
+	{
+		proto_stats.crc_errors++;
+		return;
+	}
+
+	proto_stats.frames_rx++;
+
+	uint8_t		      seq      = proto_request[0];
+	uint8_t		      id       = proto_request[1];
+	ProtoCachedResponse * response = &proto_responses[seq % kPROTO_CONF_WINDOW];
+
+	if (id == kProtoCommandSync)
+	{
+		for (uint32_t i = 0; i < kPROTO_CONF_WINDOW; i++)
+		{
+			proto_responses[i].valid = false;
+		}
+
+		proto_expected_seq = seq;
+	}
+
+	if (seq != proto_expected_seq)
+	{
+		/*
+		 * 	Resend the response to one of the last kPROTO_CONF_WINDOW
+		 * 	requests, whose response the host did not receive.
+		 */
+		uint8_t behind = proto_expected_seq - seq;
+
+		if ((behind <= kPROTO_CONF_WINDOW) && response->valid && (response->seq == seq))
+		{
+			proto_stats.duplicates++;
+			proto_send(response);
+		}
+		else
+		{
+			proto_stats.out_of_order++;
+		}
+
+		return;
+	}
+
+	int32_t result = proto_dispatch(id, &proto_request[2], len - kPROTO_CONF_OVERHEAD, &response->frame[2]);
+
+	if (result < 0)
+	{
+		response->frame[1] = (uint8_t)-result;
+		result		   = 0;
+	}
+	else
+	{
+		response->frame[1] = kProtoStatusOk;
+	}
+
+	response->frame[0] = seq;
+	response->len	   = (uint32_t)result + kPROTO_CONF_OVERHEAD;
+	response->seq	   = seq;
+	response->valid	   = true;
+
+	crc = crc16_update(kCRC16_CONF_INIT, response->frame, response->len - 2);
+	response->frame[response->len - 2] = crc & 0xff;
+	response->frame[response->len - 1] = crc >> 8;
+
+	proto_expected_seq++;
+	proto_send(response);
+}
+
+void
+proto_init(const ProtoCommand *  commands, uint32_t count)
+{
+	proto_commands	    = commands;
+	proto_command_count = count;
+	proto_rx_len	    = 0;
+	proto_rx_overflow   = false;
+	proto_expected_seq  = 0;
+
+	for (uint32_t i = 0; i < kPROTO_CONF_WINDOW; i++)
+	{
+		proto_responses[i].valid = false;
+	}
+
+	memset(&proto_stats, 0, sizeof(proto_stats));
+}
+
+RAMFUNC uint32_t
+proto_poll(void)
+{
+	uint8_t	 chunk[kPROTO_BUFFER_CONF_READ_CHUNK];
+	uint32_t frames = 0;
+	uint32_t n	= 0;
+
+	while ((n = uart_read((char *)chunk, sizeof(chunk))) > 0)
+	{
+		for (uint32_t i = 0; i < n; i++)
+		{
+			uint8_t byte = chunk[i];
+
+			if (byte != 0)
+			{
+				if (proto_rx_len < sizeof(proto_rx))
+				{
+					proto_rx[proto_rx_len++] = byte;
+				}
+				else
+				{
+					proto_rx_overflow = true;
+				}
+
+				continue;
+			}
+
+			/*
+			 * 	End of frame. Empty frames are ignored, so that the host
+			 * 	can send a delimiter to flush a partial frame.
+			 */
+			if (proto_rx_overflow)
+			{
+				proto_stats.framing_errors++;
+			}
+			else if (proto_rx_len > 0)
+			{
+				int32_t len = cobs_decode(proto_request, sizeof(proto_request), proto_rx, proto_rx_len);
+
+				if (len < 0)
+				{
+					proto_stats.framing_errors++;
+				}
+				else
+				{
+					proto_handle_frame((uint32_t)len);
+				}
+
+				frames++;
+			}
+
+			proto_rx_len	  = 0;
+			proto_rx_overflow = false;
+		}
+	}
+
+	return frames;
+}
+
+void
+proto_get_stats(ProtoStats *  stats)
+{
+	*stats = proto_stats;
+}
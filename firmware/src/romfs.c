@@ -0,0 +1,183 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "crc16.h"
+#include "romfs.h"
+
+
+_Static_assert(sizeof(RomfsHeader) == 20, "RomfsHeader must match tools/mkromfs.py");
+_Static_assert(sizeof(RomfsEntry) == 20, "RomfsEntry must match tools/mkromfs.py");
+
+
+/*
+ * 	FNV-1a hash of a NUL-terminated name, as tools/mkromfs.py. Sets *length to the length of the name.
+ */
+static uint32_t
+romfs_hash(const char *  name, uint32_t *  length)
+{
+	uint32_t	hash = kROMFS_CONF_HASH_BASIS;
+	uint32_t	i    = 0;
+
+	for (; name[i] != '\0'; i++)
+	{
+		hash = (hash ^ (uint8_t)name[i]) * kROMFS_CONF_HASH_PRIME;
+	}
+
+	*length = i;
+
+	return hash;
+}
+
+static inline const RomfsEntry *
+romfs_entries(const RomfsHeader *  image)
+{
+	return (const RomfsEntry *)(image + 1);
+}
+
+static void
+romfs_fill(const RomfsHeader *  image, const RomfsEntry *  entry, RomfsFile *  file)
+{
+	const uint8_t *	 base = (const uint8_t *)image;
+
+	file->name  = (const char *)(base + entry->name);
+	file->data  = base + entry->offset;
+	file->size  = entry->size;
+	file->crc16 = entry->crc16;
+}
+
+const RomfsHeader *
+romfs_mount(const void *  address, uint32_t max_size)
+{
+	const RomfsHeader *  image = address;
+
+	if ((((uintptr_t)address % sizeof(uint32_t)) != 0) || (max_size < sizeof(RomfsHeader)))
+	{
+		return NULL;
+	}
+
+	if ((image->magic != kROMFS_CONF_MAGIC) || (image->version != kROMFS_CONF_VERSION))
+	{
+		return NULL;
+	}
+
+	/*
+	 * 	Bound the image by max_size, and the directory by the image, before reading the directory, and
+	 * 	every entry before trusting it, so that a corrupt image is rejected here rather than read out of
+	 * 	bounds later. The subtractions cannot wrap, and the sums cannot either once they are bounded.
+	 */
+	if ((image->size < sizeof(RomfsHeader)) || (image->size > max_size) ||
+		(image->directory_size > image->size - sizeof(RomfsHeader)) ||
+		(image->count > image->directory_size / sizeof(RomfsEntry)))
+	{
+		return NULL;
+	}
+
+	uint32_t	directory_end = sizeof(RomfsHeader) + image->directory_size;
+
+	if (crc16_update(kCRC16_CONF_INIT, (const uint8_t *)(image + 1), image->directory_size) != image->crc16)
+	{
+		return NULL;
+	}
+
+	const RomfsEntry *  entries = romfs_entries(image);
+	const char *	    base    = (const char *)image;
+
+	for (uint32_t i = 0; i < image->count; i++)
+	{
+		const RomfsEntry *  entry = &entries[i];
+
+		if ((entry->name >= directory_end) || (entry->name_length >= directory_end - entry->name) ||
+			(base[entry->name + entry->name_length] != '\0') || (entry->offset < directory_end) ||
+			(entry->offset > image->size) || (entry->size > image->size - entry->offset) ||
+			((i > 0) && (entries[i - 1].hash > entry->hash)))
+		{
+			return NULL;
+		}
+	}
+
+	return image;
+}
+
+bool
+romfs_open(const RomfsHeader *  image, const char *  name, RomfsFile *  file)
+{
+	const RomfsEntry *  entries = romfs_entries(image);
+	const char *	    base    = (const char *)image;
+	uint32_t	    length;
+	uint32_t	    hash = romfs_hash(name, &length);
+	uint32_t	    low	 = 0;
+	uint32_t	    high = image->count;
+
+	/*
+	 * 	Finds the first entry whose hash is not below the name's.
+	 */
+	while (low < high)
+	{
+		uint32_t	middle = low + (high - low) / 2;
+
+		if (entries[middle].hash < hash)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	for (; (low < image->count) && (entries[low].hash == hash); low++)
+	{
+		const RomfsEntry *  entry = &entries[low];
+
+		if ((entry->name_length == length) && (memcmp(base + entry->name, name, length) == 0))
+		{
+			romfs_fill(image, entry, file);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool
+romfs_file_at(const RomfsHeader *  image, uint32_t index, RomfsFile *  file)
+{
+	if (index >= image->count)
+	{
+		return false;
+	}
+
+	romfs_fill(image, &romfs_entries(image)[index], file);
+
+	return true;
+}
+
+bool
+romfs_verify(const RomfsFile *  file)
+{
+	return crc16_update(kCRC16_CONF_INIT, file->data, file->size) == file->crc16;
+}
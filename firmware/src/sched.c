@@ -0,0 +1,172 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <irq.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sched.h"
+#include "profile.h"
+#include "ramfunc.h"
+#include "trace.h"
+#include "uart.h"
+
+
+static SchedTask *	  sched_tasks[kSCHED_CONF_PRIORITIES];
+static volatile uint32_t  sched_ready = 0;
+static volatile SchedStats sched_stats;
+static uint64_t		  sched_start = 0;
+
+
+void
+sched_task_init(SchedTask *  task, uint32_t priority, const char *  name, SchedTaskFn fn, void *  ctx)
+{
+	task->fn	     = fn;
+	task->ctx	     = ctx;
+	task->priority	     = priority;
+	task->posted_at	     = 0;
+	task->latency	     = (ProfileRegion){.name = name, .min = UINT32_MAX};
+
+	if (priority < kSCHED_CONF_PRIORITIES)
+	{
+		sched_tasks[priority] = task;
+	}
+}
+
+RAMFUNC void
+sched_post(SchedTask *  task)
+{
+	uint32_t bit = 1U << task->priority;
+	uint32_t ie  = irq_getie();
+
+	irq_setie(0);
+
+	if ((sched_ready & bit) == 0)
+	{
+		task->posted_at = profile_now();
+		sched_ready |= bit;
+	}
+
+	irq_setie(ie);
+}
+
+/*
+ * 	Waits for an interrupt, with interrupts disabled, so that an interrupt
+ * 	posting a task between the ready check and wfi still wakes the core up:
+ * 	wfi returns on a pending interrupt even when interrupts are disabled, and
+ * 	the interrupt is then taken once they are enabled again.
+ */
+static RAMFUNC void
+sched_idle(void)
+{
+	uint64_t start = profile_now();
+
+	__asm__ volatile("wfi");
+
+	sched_stats.idle_cycles += profile_now() - start;
+}
+
+RAMFUNC void
+sched_run(void)
+{
+	sched_start = profile_now();
+
+	while (1)
+	{
+		irq_setie(0);
+
+		uint32_t ready = sched_ready;
+
+		if (ready == 0)
+		{
+#ifndef CONFIG_TRACE_DISABLE
+			/*
+			 * 	Sending events records none, so this stops once the
+			 * 	events recorded by the tasks which ran are sent.
+			 */
+			if (trace_pending())
+			{
+				irq_setie(1);
+				trace_drain(kSCHED_CONF_TRACE_BATCH);
+				continue;
+			}
+#endif
+			sched_idle();
+			irq_setie(1);
+			continue;
+		}
+
+		/*
+		 * 	Lowest bit first, i.e. highest priority first.
+		 */
+		uint32_t   priority = __builtin_ctz(ready);
+		SchedTask *task	    = sched_tasks[priority];
+
+		sched_ready = ready & ~(1U << priority);
+		sched_stats.runs++;
+
+		irq_setie(1);
+
+		if (task != NULL)
+		{
+			profile_stop(&task->latency, task->posted_at);
+			TRACE_BEGIN("sched_task", priority);
+			task->fn(task->ctx);
+			TRACE_END("sched_task", priority);
+		}
+	}
+}
+
+void
+sched_get_stats(SchedStats *  stats)
+{
+	uint32_t ie = irq_getie();
+
+	irq_setie(0);
+	stats->idle_cycles  = sched_stats.idle_cycles;
+	stats->runs	    = sched_stats.runs;
+	stats->total_cycles = sched_start == 0 ? 0 : profile_now() - sched_start;
+	irq_setie(ie);
+}
+
+void
+sched_dump(void)
+{
+	SchedStats stats;
+
+	sched_get_stats(&stats);
+
+	/*
+	 * 	Idle percentage with one decimal, without floating point.
+	 */
+	uint32_t idle_permille = stats.total_cycles == 0 ? 0 : (uint32_t)((stats.idle_cycles * 1000) / stats.total_cycles);
+
+	uart_printf(
+		"sched: %u tasks run, idle %u.%u%% of %llu cycles\n",
+		stats.runs,
+		idle_permille / 10,
+		idle_permille % 10,
+		stats.total_cycles);
+	uart_printf("sched: post-to-run latency per task\n");
+	profile_dump();
+}
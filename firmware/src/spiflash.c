@@ -0,0 +1,192 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <generated/csr.h>
+#include <irq.h>
+#include <stddef.h>
+#include "spiflash.h"
+#include "ramfunc.h"
+
+/*
+ * 	Commands are sent through the LiteSPI master interface. While a command is
+ * 	in progress the flash cannot serve memory mapped reads, so everything that
+ * 	runs between asserting and releasing chip select, including waiting for the
+ * 	flash to finish a write, executes from SRAM with interrupts disabled.
+ */
+
+#ifdef CSR_SPIFLASH_CORE_MASTER_CS_ADDR
+
+/*
+ * 	The RAMFUNC_REQUIRED functions access the master's CSRs directly, instead of
+ * 	through the generated spiflash_core_master_*() and csr_*_simple() helpers:
+ * 	those are static inline, and GCC may emit an out-of-line copy of them in
+ * 	flash .text, e.g. at -Os or with LTO=1, which would be fetched from flash
+ * 	while chip select is asserted. Functions called from these must be marked
+ * 	RAMFUNC_REQUIRED too. Check with objdump -d that their only calls are to
+ * 	.ramtext functions. irq_getie() and irq_setie() are only called while chip
+ * 	select is released, and the flash is idle.
+ */
+#define SPIFLASH_MASTER_CSR(name) (*(volatile uint32_t *)(CSR_SPIFLASH_CORE_MASTER_##name##_ADDR))
+
+/**
+ * 	@brief Configures the master for single bit, 8-bit transfers.
+ */
+static RAMFUNC_REQUIRED void
+spiflash_master_config(void)
+{
+	SPIFLASH_MASTER_CSR(PHYCONFIG) =
+		0
+		| (8 << CSR_SPIFLASH_CORE_MASTER_PHYCONFIG_LEN_OFFSET)
+		| (1 << CSR_SPIFLASH_CORE_MASTER_PHYCONFIG_WIDTH_OFFSET)
+		| (1 << CSR_SPIFLASH_CORE_MASTER_PHYCONFIG_MASK_OFFSET);
+}
+
+static RAMFUNC_REQUIRED uint8_t
+spiflash_master_transfer(uint8_t byte)
+{
+	while (!((SPIFLASH_MASTER_CSR(STATUS) >> CSR_SPIFLASH_CORE_MASTER_STATUS_TX_READY_OFFSET) & 1))
+	{
+		;
+	}
+	SPIFLASH_MASTER_CSR(RXTX) = byte;
+
+	while (!((SPIFLASH_MASTER_CSR(STATUS) >> CSR_SPIFLASH_CORE_MASTER_STATUS_RX_READY_OFFSET) & 1))
+	{
+		;
+	}
+	return SPIFLASH_MASTER_CSR(RXTX);
+}
+
+/**
+ * 	@brief Sends a command, with an optional data byte, and returns the last byte received.
+ */
+static RAMFUNC_REQUIRED uint8_t
+spiflash_master_command(uint8_t cmd, const uint8_t *  data, size_t len)
+{
+	uint8_t rx;
+
+	SPIFLASH_MASTER_CSR(CS) = 1;
+	rx = spiflash_master_transfer(cmd);
+	for (size_t i = 0; i < len; i++)
+	{
+		rx = spiflash_master_transfer(data[i]);
+	}
+	SPIFLASH_MASTER_CSR(CS) = 0;
+
+	return rx;
+}
+
+static RAMFUNC_REQUIRED uint8_t
+spiflash_master_read_status(uint8_t cmd)
+{
+	const uint8_t dummy = 0;
+	return spiflash_master_command(cmd, &dummy, 1);
+}
+
+static RAMFUNC_REQUIRED uint8_t
+spiflash_read_status_locked(uint8_t cmd)
+{
+	uint32_t ie = irq_getie();
+	irq_setie(0);
+
+	spiflash_master_config();
+	uint8_t status = spiflash_master_read_status(cmd);
+
+	irq_setie(ie);
+
+	return status;
+}
+
+static RAMFUNC_REQUIRED bool
+spiflash_quad_enable_locked(void)
+{
+	uint32_t ie = irq_getie();
+	irq_setie(0);
+
+	spiflash_master_config();
+
+	uint8_t status2 = spiflash_master_read_status(kSpiFlashCmdReadStatus2);
+	if (!(status2 & kSpiFlashStatus2QuadEnable))
+	{
+		status2 |= kSpiFlashStatus2QuadEnable;
+
+		spiflash_master_command(kSpiFlashCmdWriteEnable, NULL, 0);
+		spiflash_master_command(kSpiFlashCmdWriteStatus2, &status2, 1);
+
+		/*
+		 * 	Wait for the non-volatile write to complete, before fetching from flash again
+		 */
+		while (spiflash_master_read_status(kSpiFlashCmdReadStatus1) & kSpiFlashStatus1Busy)
+		{
+			;
+		}
+
+		status2 = spiflash_master_read_status(kSpiFlashCmdReadStatus2);
+	}
+
+	irq_setie(ie);
+
+	return (status2 & kSpiFlashStatus2QuadEnable) != 0;
+}
+
+#endif
+
+bool
+spiflash_has_master(void)
+{
+#ifdef CSR_SPIFLASH_CORE_MASTER_CS_ADDR
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint8_t
+spiflash_read_status(SpiFlashCmd cmd)
+{
+#ifdef CSR_SPIFLASH_CORE_MASTER_CS_ADDR
+	return spiflash_read_status_locked(cmd);
+#else
+	(void)cmd;
+	return 0;
+#endif
+}
+
+bool
+spiflash_quad_enable(void)
+{
+#ifdef CSR_SPIFLASH_CORE_MASTER_CS_ADDR
+	return spiflash_quad_enable_locked();
+#else
+	return false;
+#endif
+}
+
+void
+spiflash_init(void)
+{
+	if (spiflash_has_master())
+	{
+		spiflash_quad_enable();
+	}
+}
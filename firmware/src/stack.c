@@ -0,0 +1,92 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "stack.h"
+
+
+/*
+ * 	End of .bss, and top of the stack, from the linker script.
+ */
+extern uint32_t _ebss[];
+extern uint32_t _fstack[];
+
+static uint32_t *  stack_bottom = _ebss;
+
+
+/*
+ * 	Not inlined, so that the frame address is the caller's stack pointer, or below it.
+ */
+__attribute__((noinline)) void
+stack_paint(void)
+{
+	uint32_t * word = stack_bottom;
+	uint32_t * end	= (uint32_t *)((uintptr_t)__builtin_frame_address(0) - kSTACK_CONF_PAINT_MARGIN);
+
+	while (word < end)
+	{
+		*word++ = kSTACK_CONF_PAINT;
+	}
+}
+
+void
+stack_set_bottom(void *  bottom)
+{
+	uint32_t * aligned = (uint32_t *)(((uintptr_t)bottom + 3) & ~(uintptr_t)3);
+
+	if (aligned >= _ebss && aligned <= _fstack)
+	{
+		stack_bottom = aligned;
+	}
+}
+
+uint32_t
+stack_size(void)
+{
+	return (uintptr_t)_fstack - (uintptr_t)stack_bottom;
+}
+
+__attribute__((noinline)) uint32_t
+stack_used(void)
+{
+	return (uintptr_t)_fstack - (uintptr_t)__builtin_frame_address(0);
+}
+
+uint32_t
+stack_high_water(void)
+{
+	uint32_t * word = stack_bottom;
+
+	while (word < _fstack && *word == kSTACK_CONF_PAINT)
+	{
+		word++;
+	}
+
+	return (uintptr_t)_fstack - (uintptr_t)word;
+}
+
+bool
+stack_overflowed(void)
+{
+	return stack_bottom < _fstack && *stack_bottom != kSTACK_CONF_PAINT;
+}
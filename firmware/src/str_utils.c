@@ -22,21 +22,298 @@
 
 
 #include "str_utils.h"
+#include "ramfunc.h"
 
-#include <stdlib.h>
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
-int
-str_utils_format_args(char *  res_buf, const char *  format, va_list args)
+/**
+ * 	@brief Source of padding characters, emitted in chunks.
+ */
+static const RAMDATA char str_utils_spaces[] = "                ";
+
+/**
+ * 	@brief Two-digit decimal strings of 00 to 99, used to convert two digits per step.
+ */
+static const RAMDATA char str_utils_digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/**
+ * 	@brief Hexadecimal digit of each nibble value.
+ */
+static const RAMDATA char str_utils_hex_digits[] = "0123456789abcdef";
+
+/**
+ * 	@brief Powers of ten, used to count the decimal digits of a 32-bit value.
+ */
+static const RAMDATA uint32_t str_utils_powers_of_10[] = {
+	10U,
+	100U,
+	1000U,
+	10000U,
+	100000U,
+	1000000U,
+	10000000U,
+	100000000U,
+	1000000000U,
+};
+
+/**
+ * 	@brief Returns value / 100, for any 32-bit value, using a multiply-high instead of a divide.
+ * 	0x51eb851f is ceil(2^37 / 100).
+ */
+static inline uint32_t
+str_utils_div100(uint32_t value)
 {
-	if (format == NULL)
+	return (uint32_t)(((uint64_t)value * 0x51eb851fU) >> 37);
+}
+
+/**
+ * 	@brief Returns value / 10^8, for any 64-bit value, using a multiply-high instead of a divide.
+ * 	0xabcc77118461cefd is ceil(2^90 / 10^8). The high half of the 128-bit product is assembled from
+ * 	32-bit partial products, which are single mul/mulhu instructions on RV32IM.
+ */
+static inline uint64_t
+str_utils_div1e8(uint64_t value)
+{
+	const uint64_t magic = 0xabcc77118461cefdULL;
+
+	uint64_t value_lo = (uint32_t)value;
+	uint64_t value_hi = value >> 32;
+	uint64_t magic_lo = (uint32_t)magic;
+	uint64_t magic_hi = magic >> 32;
+
+	uint64_t lo_lo = value_lo * magic_lo;
+	uint64_t lo_hi = value_lo * magic_hi;
+	uint64_t hi_lo = value_hi * magic_lo;
+	uint64_t hi_hi = value_hi * magic_hi;
+
+	uint64_t middle = (lo_lo >> 32) + (uint32_t)lo_hi + (uint32_t)hi_lo;
+	uint64_t high	= hi_hi + (lo_hi >> 32) + (hi_lo >> 32) + (middle >> 32);
+
+	return high >> 26;
+}
+
+/**
+ * 	@brief Writes the last digits of value backwards, ending just before end, two digits per step.
+ * 	Writes exactly digits characters, so it also produces leading zeros.
+ */
+static inline void
+str_utils_write_dec_backwards(char *  end, uint32_t value, size_t digits)
+{
+	while (digits >= 2)
+	{
+		uint32_t quotient = str_utils_div100(value);
+		uint32_t pair	  = value - quotient * 100;
+
+		end -= 2;
+		end[0] = str_utils_digit_pairs[2 * pair];
+		end[1] = str_utils_digit_pairs[2 * pair + 1];
+
+		value = quotient;
+		digits -= 2;
+	}
+
+	if (digits != 0)
+	{
+		*--end = '0' + value;
+	}
+}
+
+RAMFUNC size_t
+str_utils_u32_to_dec(char *  dst, uint32_t value)
+{
+	size_t digits = 1;
+
+	while (digits < 10 && value >= str_utils_powers_of_10[digits - 1])
+	{
+		digits++;
+	}
+
+	str_utils_write_dec_backwards(dst + digits, value, digits);
+
+	return digits;
+}
+
+RAMFUNC size_t
+str_utils_u64_to_dec(char *  dst, uint64_t value)
+{
+	if ((value >> 32) == 0)
+	{
+		return str_utils_u32_to_dec(dst, (uint32_t)value);
+	}
+
+	/*
+	 * 	Split into base 10^8 limbs: value = (top * 10^8 + middle) * 10^8 + low.
+	 * 	UINT64_MAX has 20 digits, so top is at most 4 digits long.
+	 */
+	uint64_t upper = str_utils_div1e8(value);
+	uint32_t low   = (uint32_t)(value - upper * 100000000U);
+	size_t	 len;
+
+	if ((upper >> 32) == 0 && (uint32_t)upper < 100000000U)
+	{
+		len = str_utils_u32_to_dec(dst, (uint32_t)upper);
+	}
+	else
+	{
+		uint64_t top	= str_utils_div1e8(upper);
+		uint32_t middle = (uint32_t)(upper - top * 100000000U);
+
+		len = str_utils_u32_to_dec(dst, (uint32_t)top);
+		str_utils_write_dec_backwards(dst + len + 8, middle, 8);
+		len += 8;
+	}
+
+	str_utils_write_dec_backwards(dst + len + 8, low, 8);
+
+	return len + 8;
+}
+
+RAMFUNC size_t
+str_utils_u32_to_hex(char *  dst, uint32_t value)
+{
+	size_t digits = 1;
+
+	while (digits < 8 && (value >> (4 * digits)) != 0)
+	{
+		digits++;
+	}
+
+	for (size_t i = digits; i > 0; i--)
+	{
+		dst[i - 1] = str_utils_hex_digits[value & 0xf];
+		value >>= 4;
+	}
+
+	return digits;
+}
+
+RAMFUNC size_t
+str_utils_u64_to_hex(char *  dst, uint64_t value)
+{
+	uint32_t high = (uint32_t)(value >> 32);
+
+	if (high == 0)
+	{
+		return str_utils_u32_to_hex(dst, (uint32_t)value);
+	}
+
+	size_t	 len = str_utils_u32_to_hex(dst, high);
+	uint32_t low = (uint32_t)value;
+
+	for (size_t i = len + 8; i > len; i--)
+	{
+		dst[i - 1] = str_utils_hex_digits[low & 0xf];
+		low >>= 4;
+	}
+
+	return len + 8;
+}
+
+/**
+ * 	@brief State of the bounded buffer sink, used by str_utils_format_args.
+ */
+typedef struct
+{
+	char *	buf;
+	size_t	size;
+	size_t	pos;
+} StrUtilsBufferSink;
+
+/**
+ * 	@brief Converts an integer in place, for the d, u and x format specifiers.
+ * 	Values that fit in 32 bits never touch 64-bit arithmetic.
+ *
+ * 	@return size_t the number of characters written
+ */
+static RAMFUNC size_t
+str_utils_convert_integer(char *  dst, char spec, bool negative, uint64_t value)
+{
+	size_t len = 0;
+
+	if (negative)
+	{
+		dst[len++] = '-';
+	}
+
+	if (spec == 'x')
+	{
+		len += str_utils_u64_to_hex(dst + len, value);
+	}
+	else
+	{
+		len += str_utils_u64_to_dec(dst + len, value);
+	}
+
+	return len;
+}
+
+/**
+ * 	@brief Emits width - len spaces, if width is larger than len.
+ *
+ * 	@return int the number of spaces emitted
+ */
+static RAMFUNC int
+str_utils_pad(StrUtilsPutFn put, void *  ctx, int width, size_t len)
+{
+	if (width <= 0 || (size_t)width <= len)
+	{
+		return 0;
+	}
+
+	size_t	padding = (size_t)width - len;
+	size_t	remaining = padding;
+
+	while (remaining > 0)
+	{
+		size_t chunk = remaining < sizeof(str_utils_spaces) - 1 ? remaining : sizeof(str_utils_spaces) - 1;
+		put(ctx, str_utils_spaces, chunk);
+		remaining -= chunk;
+	}
+
+	return (int)padding;
+}
+
+/**
+ * 	@brief Emits a string, left padded with spaces up to width.
+ *
+ * 	@return int the number of characters emitted
+ */
+static RAMFUNC int
+str_utils_put_padded(StrUtilsPutFn put, void *  ctx, int width, const char *  str, size_t len)
+{
+	int count = str_utils_pad(put, ctx, width, len);
+
+	if (len > 0)
+	{
+		put(ctx, str, len);
+	}
+
+	return count + (int)len;
+}
+
+RAMFUNC int
+str_utils_format_sink(StrUtilsPutFn put, void *  ctx, const char *  format, va_list args)
+{
+	if (put == NULL || format == NULL)
 	{
 		return -1;
 	}
 
-	uint8_t len = 0;
+	int	len = 0;
 	char	buf[kSTR_UTILS_CONF_BUFFER_SIZE];
 
 	/*
@@ -45,13 +322,18 @@ str_utils_format_args(char *  res_buf, const char *  format, va_list args)
 	while (*format != '\0')
 	{
 		/*
-		 * 	If we don't find a % character, we just copy the character
+		 * 	Emit everything up to the next % character in one go
 		 */
 		if (*format != '%')
 		{
-			res_buf[len] = *format;
-			len++;
-			format++;
+			const char *  literal = format;
+			while (*format != '\0' && *format != '%')
+			{
+				format++;
+			}
+
+			put(ctx, literal, format - literal);
+			len += format - literal;
 			continue;
 		}
 
@@ -73,6 +355,16 @@ str_utils_format_args(char *  res_buf, const char *  format, va_list args)
 			format++;
 		}
 
+		/*
+		 * 	Check for a length modifier: l or ll
+		 */
+		int length = 0;
+		while (*format == 'l' && length < 2)
+		{
+			length++;
+			format++;
+		}
+
 		/*
 		 * 	Check the format specifier
 		 */
@@ -82,52 +374,17 @@ str_utils_format_args(char *  res_buf, const char *  format, va_list args)
 			 * 	Print a single %
 			 */
 			case '%':
-				/*
-				 * 	check if we have a left padding
-				 */
-				if (space > 1)
-				{
-					for (int i = 0; i < space - 1; i++)
-					{
-						res_buf[len] = ' ';
-						len++;
-					}
-				}
-
-				/*
-				 * 	print the %
-				 */
-				res_buf[len] = '%';
-
-				len++;
 				format++;
+				len += str_utils_put_padded(put, ctx, space, "%", 1);
 				break;
 
 			/*
 			 * 	Print a character
 			 */
 			case 'c':
-				/*
-				 * 	check if we have a left padding
-				 */
-				if (space > 1)
-				{
-					for (int i = 0; i < space - 1; i++)
-					{
-						res_buf[len] = ' ';
-						len++;
-					}
-				}
-
 				format++;
-
-				/*
-				 * 	print the character
-				 */
-				char c	     = (char)va_arg(args, int);
-				res_buf[len] = c;
-
-				len++;
+				char c = (char)va_arg(args, int);
+				len += str_utils_put_padded(put, ctx, space, &c, 1);
 				break;
 
 			/*
@@ -135,111 +392,60 @@ str_utils_format_args(char *  res_buf, const char *  format, va_list args)
 			 */
 			case 's':
 				format++;
-				char *	s     = (char *)va_arg(args, int);
-				uint8_t s_len = strlen(s);
-
-				/*
-				 * 	check if we have a left padding
-				 */
-				if (space > s_len)
-				{
-					for (int i = 0; i < space - s_len; i++)
-					{
-						res_buf[len] = ' ';
-						len++;
-					}
-				}
-
-				/*
-				 * 	print the string
-				 */
-				while (*s != '\0')
+				const char *  s = va_arg(args, const char *);
+				if (s == NULL)
 				{
-					res_buf[len] = *s;
-					len++;
-					s++;
+					s = "(null)";
 				}
+				len += str_utils_put_padded(put, ctx, space, s, strlen(s));
 				break;
 
 			/*
-			 * 	Print a decimal
+			 * 	Print a signed decimal, unsigned decimal or hexadecimal
 			 */
 			case 'd':
-				format++;
-				int    d     = va_arg(args, int);
-
-				/*
-				 * 	convert the decimal to a string
-				 */
-				char *  str_d = itoa(d, buf, 10);
-
-				uint8_t str_d_len = strlen(str_d);
+			case 'u':
+			case 'x':
+			{
+				uint64_t value;
+				bool	 negative = false;
 
-				/*
-				 * 	check if we have a left padding
-				 */
-				if (space > str_d_len)
+				if (*format == 'd')
 				{
-					for (int i = 0; i < space - str_d_len; i++)
-					{
-						res_buf[len] = ' ';
-						len++;
-					}
+					int64_t d = length == 0 ? va_arg(args, int)
+						  : length == 1 ? va_arg(args, long)
+								: va_arg(args, long long);
+					negative = d < 0;
+					value	 = negative ? -(uint64_t)d : (uint64_t)d;
 				}
-
-				/*
-				 * 	print the decimal string
-				 */
-				while (*str_d != '\0')
+				else
 				{
-					res_buf[len] = *str_d;
-					len++;
-					str_d++;
+					value = length == 0 ? va_arg(args, unsigned int)
+					      : length == 1 ? va_arg(args, unsigned long)
+							    : va_arg(args, unsigned long long);
 				}
+
+				len += str_utils_put_padded(
+					put,
+					ctx,
+					space,
+					buf,
+					str_utils_convert_integer(buf, *format, negative, value));
+				format++;
 				break;
+			}
 
 			/*
-			 * 	Print a hexadecimal
+			 * 	A lone % at the end of the format string, stop here
 			 */
-			case 'x':
-				format++;
-				int    x     = va_arg(args, int);
-
-				/*
-				 * 	convert the hexadecimal to a string
-				 */
-				char *  str_x = itoa(x, buf, 16);
-
-				uint8_t str_x_len = strlen(str_x);
-
-				/*
-				 * 	check if we have a left padding
-				 */
-				if (space > str_x_len)
-				{
-					for (int i = 0; i < space - str_x_len; i++)
-					{
-						res_buf[len] = ' ';
-						len++;
-					}
-				}
-
-				/*
-				 * 	print the hexdecimal string
-				 */
-				while (*str_x != '\0')
-				{
-					res_buf[len] = *str_x;
-					len++;
-					str_x++;
-				}
+			case '\0':
 				break;
 
 			/*
 			 * 	Should never happen, but just in case, copy the character
 			 */
 			default:
-				res_buf[len] = *format;
+				put(ctx, format, 1);
 				len++;
 				format++;
 				break;
@@ -247,13 +453,61 @@ str_utils_format_args(char *  res_buf, const char *  format, va_list args)
 	}
 
 	/*
-	 * 	Return the number of characters written
+	 * 	Return the number of characters emitted
+	 */
+	return len;
+}
+
+/**
+ * 	@brief Sink that copies into a bounded buffer, always leaving room for the terminating null character.
+ * 	Characters that do not fit are discarded.
+ */
+static RAMFUNC void
+str_utils_buffer_put(void *  ctx, const char *  str, size_t len)
+{
+	StrUtilsBufferSink *  sink = (StrUtilsBufferSink *)ctx;
+
+	if (sink->pos + 1 < sink->size)
+	{
+		size_t room = sink->size - 1 - sink->pos;
+		size_t n    = len < room ? len : room;
+		memcpy(sink->buf + sink->pos, str, n);
+		sink->pos += n;
+	}
+}
+
+int
+str_utils_format_args(char *  res_buf, size_t size, const char *  format, va_list args)
+{
+	if (format == NULL || (res_buf == NULL && size != 0))
+	{
+		return -1;
+	}
+
+	StrUtilsBufferSink sink = {
+		.buf  = res_buf,
+		.size = size,
+		.pos  = 0,
+	};
+
+	int len = str_utils_format_sink(str_utils_buffer_put, &sink, format, args);
+
+	/*
+	 * 	Terminate the string, even if it was truncated
+	 */
+	if (size != 0)
+	{
+		res_buf[sink.pos] = '\0';
+	}
+
+	/*
+	 * 	Return the length of the untruncated string
 	 */
 	return len;
 }
 
 int
-str_utils_format(char *  res_buf, const char *  format, ...)
+str_utils_format(char *  res_buf, size_t size, const char *  format, ...)
 {
 	if (format == NULL)
 	{
@@ -269,7 +523,7 @@ str_utils_format(char *  res_buf, const char *  format, ...)
 	/*
 	 * 	Format the string
 	 */
-	int len = str_utils_format_args(res_buf, format, args);
+	int len = str_utils_format_args(res_buf, size, format, args);
 
 	/*
 	 * 	End variable argument list
@@ -24,6 +24,7 @@
 #include <generated/csr.h>
 #include <stdbool.h>
 #include "time.h"
+#include "ramfunc.h"
 
 void
 timer0_enable(void)
@@ -45,14 +46,14 @@ timer0_init(void)
 	timer0_load_write(0);
 }
 
-timer0_t
+RAMFUNC timer0_t
 timer0_get_current_value(void)
 {
 	timer0_update_value_write(1);
 	return timer0_value_read();
 }
 
-timer0_t
+RAMFUNC timer0_t
 timer0_get_time_passed_since_last_load(void)
 {
 	timer0_t start_value = timer0_reload_read();
@@ -109,7 +110,7 @@ timer0_set_periodic_mode_ms(timer0_t duration_ms)
 	timer0_set_periodic_mode_ticks(duration_ticks);
 }
 
-bool
+RAMFUNC bool
 timer0_is_expired(void)
 {
 	if (timer0_reload_read() == 0 && timer0_load_read() == 0)
@@ -168,3 +169,13 @@ timer0_t
 timer0_get_duration_ms(timer0_t start_time, timer0_t end_time) {
 	return timer0_ticks_to_ms(timer0_get_duration(start_time, end_time));
 }
+
+RAMFUNC uint64_t
+timer0_get_uptime_cycles(void)
+{
+	/*
+	 * 	Latch the counter, so that both of its 32-bit halves are read from the same cycle
+	 */
+	timer0_uptime_latch_write(1);
+	return timer0_uptime_cycles_read();
+}
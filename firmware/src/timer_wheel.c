@@ -0,0 +1,169 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <stddef.h>
+#include "timer_wheel.h"
+#include "ramfunc.h"
+
+_Static_assert(
+	(kTIMER_WHEEL_CONF_SLOTS & (kTIMER_WHEEL_CONF_SLOTS - 1)) == 0,
+	"kTIMER_WHEEL_CONF_SLOTS must be a power of two");
+
+
+static inline void
+timer_wheel_link_init(TimerWheelLink *  head)
+{
+	head->next = head;
+	head->prev = head;
+}
+
+static inline void
+timer_wheel_link_append(TimerWheelLink *  head, TimerWheelLink *  link)
+{
+	link->prev	 = head->prev;
+	link->next	 = head;
+	head->prev->next = link;
+	head->prev	 = link;
+}
+
+static inline void
+timer_wheel_link_remove(TimerWheelLink *  link)
+{
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+	link->next	 = NULL;
+	link->prev	 = NULL;
+}
+
+static inline void
+timer_wheel_insert(TimerWheel *  wheel, TimerWheelTimer *  timer)
+{
+	timer_wheel_link_append(&wheel->slots[timer->expires & (kTIMER_WHEEL_CONF_SLOTS - 1)], &timer->link);
+	wheel->pending++;
+}
+
+void
+timer_wheel_init(TimerWheel *  wheel)
+{
+	for (int i = 0; i < kTIMER_WHEEL_CONF_SLOTS; i++)
+	{
+		timer_wheel_link_init(&wheel->slots[i]);
+	}
+
+	wheel->now     = 0;
+	wheel->pending = 0;
+}
+
+void
+timer_wheel_timer_init(TimerWheelTimer *  timer)
+{
+	timer->link.next = NULL;
+	timer->link.prev = NULL;
+	timer->expires	 = 0;
+	timer->period	 = 0;
+	timer->callback	 = NULL;
+	timer->ctx	 = NULL;
+}
+
+RAMFUNC void
+timer_wheel_start(
+	TimerWheel *  wheel,
+	TimerWheelTimer *  timer,
+	uint32_t delay,
+	uint32_t period,
+	TimerWheelCallback callback,
+	void *  ctx)
+{
+	timer_wheel_cancel(wheel, timer);
+
+	timer->expires	= wheel->now + (delay == 0 ? 1 : delay);
+	timer->period	= period;
+	timer->callback = callback;
+	timer->ctx	= ctx;
+
+	timer_wheel_insert(wheel, timer);
+}
+
+RAMFUNC void
+timer_wheel_cancel(TimerWheel *  wheel, TimerWheelTimer *  timer)
+{
+	if (timer->link.next != NULL)
+	{
+		timer_wheel_link_remove(&timer->link);
+		wheel->pending--;
+	}
+}
+
+bool
+timer_wheel_is_pending(const TimerWheelTimer *  timer)
+{
+	return timer->link.next != NULL;
+}
+
+RAMFUNC uint32_t
+timer_wheel_tick(TimerWheel *  wheel)
+{
+	TimerWheelLink	expired;
+	TimerWheelLink *slot = &wheel->slots[++wheel->now & (kTIMER_WHEEL_CONF_SLOTS - 1)];
+	uint32_t	fired = 0;
+
+	/*
+	 * 	Move the expiring timers to a local list first, so that the callbacks
+	 * 	can start and cancel timers in the slot being walked. A timer cancelled
+	 * 	by an earlier callback is removed from the local list, and not called.
+	 */
+	timer_wheel_link_init(&expired);
+
+	for (TimerWheelLink *link = slot->next; link != slot;)
+	{
+		TimerWheelLink *next = link->next;
+
+		if (((TimerWheelTimer *)link)->expires == wheel->now)
+		{
+			timer_wheel_link_remove(link);
+			timer_wheel_link_append(&expired, link);
+		}
+
+		link = next;
+	}
+
+	while (expired.next != &expired)
+	{
+		TimerWheelTimer *timer = (TimerWheelTimer *)expired.next;
+
+		timer_wheel_link_remove(&timer->link);
+		wheel->pending--;
+
+		if (timer->period != 0)
+		{
+			timer->expires += timer->period;
+			timer_wheel_insert(wheel, timer);
+		}
+
+		timer->callback(timer->ctx);
+		fired++;
+	}
+
+	return fired;
+}
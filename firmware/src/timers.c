@@ -0,0 +1,134 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+
+#include <generated/csr.h>
+#include <generated/soc.h>
+#include <irq.h>
+#include <time.h>
+#include "timers.h"
+#include "ramfunc.h"
+
+
+static TimerWheel timers_wheel;
+
+
+/**
+ * 	@brief Masks the timer0 interrupt, so that the wheel can be updated.
+ *
+ * 	@return uint32_t the interrupt mask to pass to timers_unlock()
+ */
+static inline uint32_t
+timers_lock(void)
+{
+	uint32_t mask = irq_getmask();
+	irq_setmask(mask & ~(1 << TIMER0_INTERRUPT));
+	return mask;
+}
+
+/**
+ * 	@brief Restores the interrupt mask returned by timers_lock().
+ */
+static inline void
+timers_unlock(uint32_t mask)
+{
+	irq_setmask(mask);
+}
+
+static inline uint32_t
+timers_ms_to_ticks(uint32_t duration_ms)
+{
+	return (duration_ms + kTIMERS_CONF_TICK_MS - 1) / kTIMERS_CONF_TICK_MS;
+}
+
+void
+timers_init(void)
+{
+	uint32_t mask = timers_lock();
+
+	timer_wheel_init(&timers_wheel);
+
+	/*
+	 * 	The zero event fires every time the countdown reloads.
+	 */
+	timer0_ev_enable_write(0);
+	timer0_set_periodic_mode_ms(kTIMERS_CONF_TICK_MS);
+	timer0_ev_pending_write(timer0_ev_pending_read());
+	timer0_ev_enable_write(1);
+
+	timers_unlock(mask | (1 << TIMER0_INTERRUPT));
+}
+
+RAMFUNC void
+timers_isr(void)
+{
+	timer0_ev_pending_write(timer0_ev_pending_read());
+	timer_wheel_tick(&timers_wheel);
+}
+
+RAMFUNC void
+timers_start_ms(
+	TimerWheelTimer *  timer,
+	uint32_t delay_ms,
+	uint32_t period_ms,
+	TimerWheelCallback callback,
+	void *  ctx)
+{
+	uint32_t mask = timers_lock();
+	timer_wheel_start(
+		&timers_wheel,
+		timer,
+		timers_ms_to_ticks(delay_ms),
+		timers_ms_to_ticks(period_ms),
+		callback,
+		ctx);
+	timers_unlock(mask);
+}
+
+RAMFUNC void
+timers_cancel(TimerWheelTimer *  timer)
+{
+	uint32_t mask = timers_lock();
+	timer_wheel_cancel(&timers_wheel, timer);
+	timers_unlock(mask);
+}
+
+RAMFUNC uint32_t
+timers_get_ticks(void)
+{
+	return *(volatile uint32_t *)&timers_wheel.now;
+}
+
+void
+timers_delay_ms(uint32_t duration_ms)
+{
+	uint32_t start = timers_get_ticks();
+
+	/*
+	 * 	One more tick, since start may be at the end of its tick.
+	 */
+	while (timers_get_ticks() - start <= timers_ms_to_ticks(duration_ms))
+	{
+		;
+	}
+}
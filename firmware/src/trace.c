@@ -0,0 +1,109 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <generated/soc.h>
+#include <irq.h>
+#include <stdint.h>
+#include "fmt_shims.h"
+#include "trace.h"
+#include "uart.h"
+
+
+TraceEvent	  trace_buffer[kTRACE_CONF_EVENTS];
+volatile uint32_t trace_head = 0;
+uint32_t	  trace_tail = 0;
+
+
+uint32_t
+trace_drain(uint32_t max_events)
+{
+	uint32_t   printed = 0;
+	uint32_t   lost	   = 0;
+	uint32_t   pending = 0;
+	TraceEvent event;
+
+	while (1)
+	{
+		uint32_t ie = irq_getie();
+
+		irq_setie(0);
+
+		/*
+		 * 	Skip the events which have been overwritten since the last call.
+		 */
+		pending = trace_head - trace_tail;
+
+		if (pending > kTRACE_CONF_EVENTS)
+		{
+			lost += pending - kTRACE_CONF_EVENTS;
+			trace_tail += pending - kTRACE_CONF_EVENTS;
+			pending = kTRACE_CONF_EVENTS;
+		}
+
+		if ((pending == 0) || (printed == max_events))
+		{
+			irq_setie(ie);
+			break;
+		}
+
+		/*
+		 * 	Copy the event with interrupts disabled, so that it cannot be
+		 * 	overwritten while it is being printed.
+		 */
+		event = trace_buffer[trace_tail & (kTRACE_CONF_EVENTS - 1)];
+		trace_tail++;
+
+		irq_setie(ie);
+
+		if (printed == 0)
+		{
+			uart_printf("trace: clock %u\n", (uint32_t)CONFIG_CLOCK_FREQUENCY);
+		}
+
+		if (lost != 0)
+		{
+			uart_printf("trace: lost %u\n", lost);
+			lost = 0;
+		}
+
+		fmt_trace_event(event.id, event.timestamp, event.arg);
+		printed++;
+	}
+
+	if (lost != 0)
+	{
+		uart_printf("trace: lost %u\n", lost);
+	}
+
+	return pending;
+}
+
+void
+trace_dump(void)
+{
+	/*
+	 * 	Bounded, so that events recorded while printing, e.g. by interrupt
+	 * 	handlers, cannot keep the dump going forever.
+	 */
+	trace_drain(kTRACE_CONF_EVENTS);
+}
@@ -22,76 +22,464 @@
 
 
 #include <generated/csr.h>
+#include <generated/soc.h>
+#include <irq.h>
 #include "uart.h"
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include "str_utils.h"
+#include "ramfunc.h"
+
+/*
+ * 	SRAM-backed ring buffers.
+ * 	The produce/consume indices are free running, and are masked when accessing the buffers, so that
+ * 	(produce - consume) is always the number of bytes in the buffer.
+ * 	The RX buffer is produced by uart_isr() and consumed by uart_read().
+ * 	The TX buffer is produced by uart_putchar() and consumed by uart_isr().
+ */
+static char		 uart_rx_buf[kUART_CONF_RX_BUFFER_SIZE];
+static volatile uint32_t uart_rx_produce = 0;
+static volatile uint32_t uart_rx_consume = 0;
+
+static char		 uart_tx_buf[kUART_CONF_TX_BUFFER_SIZE];
+static volatile uint32_t uart_tx_produce = 0;
+static volatile uint32_t uart_tx_consume = 0;
+
+static volatile UartStats uart_stats;
+
+static bool uart_irq_mode = false;
+
+static UartRxCallback uart_rx_callback = NULL;
+
+/*
+ * 	uart_write_async() state. uart_dma_next and uart_dma_remaining are the part of the buffer not handed to the
+ * 	TX DMA yet, and uart_dma_mark is the TX ring buffer index the buffer goes after: until the whole buffer has
+ * 	been sent, the ring buffer is only drained up to uart_dma_mark. The TX DMA is optional in the gateware
+ * 	(UART_TX_DMA in config.mk), and present if its CSRs are.
+ */
+static const uint8_t * volatile uart_dma_next	   = NULL;
+static volatile uint32_t	uart_dma_remaining = 0;
+static volatile uint32_t	uart_dma_mark	   = 0;
+static volatile bool		uart_dma_running   = false;
+
+_Static_assert(
+	(kUART_CONF_RX_BUFFER_SIZE & (kUART_CONF_RX_BUFFER_SIZE - 1)) == 0,
+	"kUART_CONF_RX_BUFFER_SIZE must be a power of two");
+_Static_assert(
+	(kUART_CONF_TX_BUFFER_SIZE & (kUART_CONF_TX_BUFFER_SIZE - 1)) == 0,
+	"kUART_CONF_TX_BUFFER_SIZE must be a power of two");
+
+/**
+ * 	@brief Masks the UART (and UART TX DMA) interrupt lines, and returns the previous mask.
+ */
+static inline uint32_t
+uart_irq_lock(void)
+{
+	uint32_t mask = irq_getmask();
+#ifdef CSR_UART_TX_DMA_BASE_ADDR
+	irq_setmask(mask & ~((1 << UART_INTERRUPT) | (1 << UART_TX_DMA_INTERRUPT)));
+#else
+	irq_setmask(mask & ~(1 << UART_INTERRUPT));
+#endif
+	return mask;
+}
+
+/**
+ * 	@brief Restores the interrupt mask returned by uart_irq_lock().
+ */
+static inline void
+uart_irq_unlock(uint32_t mask)
+{
+	irq_setmask(mask);
+}
+
+/**
+ * 	@brief Returns true while a uart_write_async() buffer has not been completely sent.
+ */
+static inline bool
+uart_dma_pending(void)
+{
+	return uart_dma_running || (uart_dma_remaining != 0);
+}
+
+#ifdef CSR_UART_TX_DMA_BASE_ADDR
+/**
+ * 	@brief Starts a TX DMA transfer of the next part of the uart_write_async() buffer.
+ */
+static RAMFUNC void
+uart_dma_start(void)
+{
+	uint32_t len = uart_dma_remaining < kUART_CONF_DMA_MAX_LENGTH ? uart_dma_remaining : kUART_CONF_DMA_MAX_LENGTH;
+
+	uart_tx_dma_base_write((uint32_t)(uintptr_t)uart_dma_next);
+	uart_tx_dma_length_write(len);
+	uart_tx_dma_start_write(1);
+
+	uart_dma_next += len;
+	uart_dma_remaining -= len;
+	uart_dma_running = true;
+	uart_stats.tx_dma_bytes += len;
+}
+#endif
+
+/**
+ * 	@brief Moves bytes from the TX ring buffer into the hardware TX FIFO, until either is exhausted, and starts
+ * 	the TX DMA once the bytes enqueued before a uart_write_async() buffer are in the hardware TX FIFO.
+ * 	Nothing is written to the hardware TX FIFO while the TX DMA runs, since it has priority over the TX DMA.
+ */
+static RAMFUNC void
+uart_tx_drain(void)
+{
+	if (uart_dma_running)
+	{
+		return;
+	}
+
+	uint32_t end = (uart_dma_remaining != 0) ? uart_dma_mark : uart_tx_produce;
+
+	while ((uart_tx_consume != end) && !uart_txfull_read())
+	{
+		uart_rxtx_write(uart_tx_buf[uart_tx_consume & (kUART_CONF_TX_BUFFER_SIZE - 1)]);
+		uart_tx_consume++;
+	}
+
+#ifdef CSR_UART_TX_DMA_BASE_ADDR
+	if ((uart_dma_remaining != 0) && (uart_tx_consume == uart_dma_mark))
+	{
+		uart_dma_start();
+	}
+#endif
+}
+
+/**
+ * 	@brief Services the TX side by polling, for when interrupts are disabled, e.g. when called from an ISR.
+ */
+static RAMFUNC void
+uart_tx_poll(void)
+{
+#ifdef CSR_UART_TX_DMA_BASE_ADDR
+	if (uart_tx_dma_ev_pending_read())
+	{
+		uart_tx_dma_isr();
+	}
+#endif
+
+	uart_tx_drain();
+}
+
+void
+uart_init(void)
+{
+	uart_irq_mode = false;
+
+	uart_rx_produce = 0;
+	uart_rx_consume = 0;
+	uart_tx_produce = 0;
+	uart_tx_consume = 0;
+
+	uart_dma_next	   = NULL;
+	uart_dma_remaining = 0;
+	uart_dma_running   = false;
+
+	/*
+	 * 	Clear stale events, then enable both RX and TX events.
+	 */
+	uart_ev_pending_write(uart_ev_pending_read());
+	uart_ev_enable_write(kUartEvTX | kUartEvRX);
+
+	irq_setmask(irq_getmask() | (1 << UART_INTERRUPT));
+
+#ifdef CSR_UART_TX_DMA_BASE_ADDR
+	uart_tx_dma_ev_pending_write(uart_tx_dma_ev_pending_read());
+	uart_tx_dma_ev_enable_write(1);
+	irq_setmask(irq_getmask() | (1 << UART_TX_DMA_INTERRUPT));
+#endif
+
+	uart_irq_mode = true;
+}
+
+RAMFUNC void
+uart_isr(void)
+{
+	uint32_t pending = uart_ev_pending_read();
+
+	if (pending & kUartEvRX)
+	{
+		while (!uart_rxempty_read())
+		{
+			char c = uart_rxtx_read();
+
+			if ((uart_rx_produce - uart_rx_consume) < kUART_CONF_RX_BUFFER_SIZE)
+			{
+				uart_rx_buf[uart_rx_produce & (kUART_CONF_RX_BUFFER_SIZE - 1)] = c;
+				uart_rx_produce++;
+				uart_stats.rx_bytes++;
+			}
+			else
+			{
+				uart_stats.rx_dropped++;
+			}
+
+			/*
+			 * 	Tell the UART that we read a byte out of the FIFO
+			 * 	and that it can give us another.
+			 */
+			uart_ev_pending_write(kUartEvRX);
+		}
+
+		if (uart_rx_callback != NULL)
+		{
+			uart_rx_callback();
+		}
+	}
+
+	if (pending & kUartEvTX)
+	{
+		uart_ev_pending_write(kUartEvTX);
+		uart_tx_drain();
+	}
+}
+
+RAMFUNC void
+uart_tx_dma_isr(void)
+{
+#ifdef CSR_UART_TX_DMA_BASE_ADDR
+	uart_tx_dma_ev_pending_write(uart_tx_dma_ev_pending_read());
+	uart_dma_running = false;
+
+	/*
+	 * 	Starts the next part of the buffer, or resumes the ring buffer.
+	 */
+	uart_tx_drain();
+#endif
+}
+
+void
+uart_set_rx_callback(UartRxCallback callback)
+{
+	uint32_t mask	 = uart_irq_lock();
+	uart_rx_callback = callback;
+	uart_irq_unlock(mask);
+}
 
 void
 uart_echo(void)
 {
-	uint32_t buf = 0;
+	char c;
+	bool echoed = false;
 
 	/*
-	 *	Check for incoming bytes
+	 *	Mirror back all the bytes received so far
 	 */
-	if (uart_rxempty_read())
+	while (uart_read(&c, 1) != 0)
 	{
-		return;
+		uart_putchar(c);
+		echoed = true;
+	}
+
+	if (echoed)
+	{
+		uart_putchar('\n');
+	}
+}
+
+RAMFUNC uint32_t
+uart_read(char *  buf, uint32_t len)
+{
+	uint32_t count = 0;
+
+	if (!uart_irq_mode)
+	{
+		while ((count < len) && !uart_rxempty_read())
+		{
+			buf[count++] = uart_rxtx_read();
+			uart_ev_pending_write(kUartEvRX);
+		}
+
+		return count;
 	}
 
 	/*
-	 *	Loop until we read all bytes
+	 * 	Only uart_isr() moves uart_rx_produce, and only we move uart_rx_consume,
+	 * 	so no locking is needed.
 	 */
-	do
+	while ((count < len) && (uart_rx_consume != uart_rx_produce))
+	{
+		buf[count++] = uart_rx_buf[uart_rx_consume & (kUART_CONF_RX_BUFFER_SIZE - 1)];
+		uart_rx_consume++;
+	}
+
+	return count;
+}
+
+int
+uart_getchar_nonblock(void)
+{
+	char c;
+
+	if (uart_read(&c, 1) == 0)
+	{
+		return -1;
+	}
+
+	return (unsigned char)c;
+}
+
+uint32_t
+uart_rx_available(void)
+{
+	if (!uart_irq_mode)
+	{
+		return !uart_rxempty_read();
+	}
+
+	return uart_rx_produce - uart_rx_consume;
+}
+
+void
+uart_flush(void)
+{
+	while (uart_tx_busy())
 	{
 		/*
-		 *	Read an incoming byte
+		 * 	Interrupts are disabled (e.g. we are called from an ISR), so drain by polling.
 		 */
-		buf = uart_rxtx_read();
+		if (!irq_getie())
+		{
+			uart_tx_poll();
+		}
+	}
+}
 
+bool
+uart_tx_busy(void)
+{
+	return (uart_tx_consume != uart_tx_produce) || uart_dma_pending();
+}
+
+void
+uart_get_stats(UartStats *  stats)
+{
+	uint32_t mask = uart_irq_lock();
+	*stats	      = uart_stats;
+	uart_irq_unlock(mask);
+}
+
+RAMFUNC void
+uart_putchar(char c)
+{
+	if (!uart_irq_mode)
+	{
 		/*
-		 * 	Tell the UART that we read a byte out of the FIFO
-		 * 	and that it can give us another.
+		 * 	Wait until the UART is ready to send a byte
 		 */
-		uart_ev_pending_write(kUartEvRX);
+		while (uart_txfull_read());
+		uart_rxtx_write(c);
+		uart_stats.tx_bytes++;
+		return;
+	}
+
+	/*
+	 * 	Wait for space in the TX ring buffer. If interrupts are disabled, nobody else
+	 * 	will make space for us, so drain the ring buffer by polling.
+	 */
+	if ((uart_tx_produce - uart_tx_consume) >= kUART_CONF_TX_BUFFER_SIZE)
+	{
+		uart_stats.tx_stalls++;
+		while ((uart_tx_produce - uart_tx_consume) >= kUART_CONF_TX_BUFFER_SIZE)
+		{
+			if (!irq_getie())
+			{
+				uart_tx_poll();
+			}
+		}
+	}
+
+	uint32_t mask = uart_irq_lock();
 
+	if ((uart_tx_consume == uart_tx_produce) && !uart_dma_pending() && !uart_txfull_read())
+	{
 		/*
-		 * 	Mirror the bytes back
+		 * 	Nothing is queued and the hardware FIFO has space, so skip the ring buffer.
 		 */
-		uart_rxtx_write(buf);
+		uart_rxtx_write(c);
 	}
-	while (!uart_rxempty_read());
+	else
+	{
+		/*
+		 * 	The TX event fires when the hardware FIFO stops being full, and uart_isr()
+		 * 	will pick the byte up from there.
+		 */
+		uart_tx_buf[uart_tx_produce & (kUART_CONF_TX_BUFFER_SIZE - 1)] = c;
+		uart_tx_produce++;
+	}
+
+	uart_stats.tx_bytes++;
 
-	uart_rxtx_write('\n');
+	uart_irq_unlock(mask);
 }
 
 void
-uart_putchar(char c)
+uart_write_async(const void *  buf, uint32_t len)
 {
-	/*
-	 * 	Wait until the UART is ready to send a byte
-	 */
-	while (uart_txfull_read());
-	uart_rxtx_write(c);
+#ifdef CSR_UART_TX_DMA_BASE_ADDR
+	if (uart_irq_mode && (len != 0))
+	{
+		while (uart_dma_pending())
+		{
+			if (!irq_getie())
+			{
+				uart_tx_poll();
+			}
+		}
+
+		uint32_t mask = uart_irq_lock();
+
+		uart_dma_next	   = buf;
+		uart_dma_remaining = len;
+		uart_dma_mark	   = uart_tx_produce;
+		uart_stats.tx_bytes += len;
+
+		/*
+		 * 	Starts the TX DMA right away if the ring buffer is empty.
+		 */
+		uart_tx_drain();
+
+		uart_irq_unlock(mask);
+		return;
+	}
+#endif
+
+	const char *  bytes = buf;
+
+	for (uint32_t i = 0; i < len; i++)
+	{
+		uart_putchar(bytes[i]);
+	}
+}
+
+bool
+uart_write_async_busy(void)
+{
+	return uart_dma_pending();
 }
 
 /**
- * 	@brief Writes a buffer on UART.
- *
- * 	@param buf
- * 	@param len
+ * 	@brief str_utils sink that writes the formatted output straight to the UART.
  */
-void
-uart_print_buf(char *  buf, uint8_t len)
+static RAMFUNC void
+uart_put_sink(void *  ctx, const char *  str, size_t len)
 {
-	for (uint8_t i = 0; i < len; i++)
+	(void)ctx;
+
+	for (size_t i = 0; i < len; i++)
 	{
-		uart_putchar(buf[i]);
+		uart_putchar(str[i]);
 	}
 }
 
-int
+RAMFUNC int
 uart_printf(const char *  format, ...)
 {
 	if (format == NULL)
@@ -99,11 +487,6 @@ uart_printf(const char *  format, ...)
 		return -1;
 	}
 
-	/*
-	 * 	Buffer for the formatted string
-	 */
-	char buf[kUART_PRINTF_CONF_BUFFER_SIZE];
-
 	/*
 	 * 	Variable argument list
 	 */
@@ -111,28 +494,15 @@ uart_printf(const char *  format, ...)
 	va_start(args, format);
 
 	/*
-	 * 	Format the string
+	 * 	Format the string, writing it on UART as it is produced
 	 */
-	int len = str_utils_format_args(buf, format, args);
+	int len = str_utils_format_sink(uart_put_sink, NULL, format, args);
 
 	/*
 	 * 	End variable argument list
 	 */
 	va_end(args);
 
-	/*
-	 * 	Check if the format was successful
-	 */
-	if (len < 0)
-	{
-		return -1;
-	}
-
-	/*
-	 * 	Write the formatted string on UART
-	 */
-	uart_print_buf(buf, len);
-
 	/*
 	 * 	Return the number of characters written
 	 */
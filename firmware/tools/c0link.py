@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+
+# 	Copyright (c) 2024, Signaloid.
+#
+# 	Permission is hereby granted, free of charge, to any person obtaining a copy
+# 	of this software and associated documentation files (the "Software"), to
+# 	deal in the Software without restriction, including without limitation the
+# 	rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# 	sell copies of the Software, and to permit persons to whom the Software is
+# 	furnished to do so, subject to the following conditions:
+#
+# 	The above copyright notice and this permission notice shall be included in
+# 	all copies or substantial portions of the Software.
+#
+# 	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# 	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# 	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# 	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# 	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# 	DEALINGS IN THE SOFTWARE.
+
+"""Host side of the framed binary UART protocol (firmware/include/proto.h).
+
+Frames are COBS-encoded and zero-terminated. Before encoding, a request is
+a sequence number, a command id, the payload and the CRC-16/CCITT-FALSE of
+the preceding bytes, little-endian; a response has a status instead of the
+command id. Up to the device's window of requests are sent before waiting
+for responses, and on a timeout every request without a response is resent
+(go-back-N): the device executes each request once, and resends the cached
+response to a request it already executed.
+
+The port is a serial device, a PTY, or any pyserial URL, e.g. the LiteX
+simulator's serial2tcp port, socket://localhost:2000. pyserial is only
+needed for URLs: serial devices and PTYs are also opened without it.
+
+Usage:
+    c0link.py --port /dev/ttyACM0 info
+    c0link.py --port /dev/ttyACM0 echo hello
+    c0link.py --port /dev/ttyACM0 request 0x10 [hex payload]
+    c0link.py --port /dev/ttyACM0 test
+"""
+
+import argparse
+import binascii
+import os
+import random
+import select
+import sys
+import termios
+import time
+import tty
+
+COMMAND_SYNC = 0x00
+COMMAND_INFO = 0x01
+COMMAND_ECHO = 0x02
+COMMAND_USER = 0x10
+
+STATUS_OK = 0
+STATUS_NAMES = {0: "ok", 1: "unknown command", 2: "bad request", 3: "error"}
+
+
+class LinkError(Exception):
+    pass
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as crc16_update() in firmware/src/crc16.c."""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def cobs_encode(data):
+    output = bytearray(b"\x00")
+    code_index = 0
+    code = 1
+
+    for (index, byte) in enumerate(data):
+        if byte != 0:
+            output.append(byte)
+            code += 1
+
+        if byte == 0 or code == 0xFF:
+            output[code_index] = code
+            code = 1
+            # 	A full block at the very end needs no empty block after it.
+            if byte != 0 and index + 1 == len(data):
+                return bytes(output)
+            code_index = len(output)
+            output.append(0)
+
+    output[code_index] = code
+    return bytes(output)
+
+
+def cobs_decode(data):
+    output = bytearray()
+    index = 0
+
+    while index < len(data):
+        code = data[index]
+        index += 1
+        block = data[index : index + code - 1]
+        if code == 0 or len(block) != code - 1 or 0 in block:
+            raise ValueError("invalid COBS data")
+        output += block
+        index += code - 1
+        if code != 0xFF and index < len(data):
+            output.append(0)
+
+    return bytes(output)
+
+
+class PosixPort:
+    """Minimal raw serial port, for serial devices and PTYs without pyserial."""
+
+    def __init__(self, path, baudrate):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        attributes = termios.tcgetattr(self.fd)
+        speed = getattr(termios, f"B{baudrate}", None)
+        if speed is not None:
+            attributes[4] = attributes[5] = speed
+        termios.tcsetattr(self.fd, termios.TCSANOW, attributes)
+        self.timeout = None
+
+    def read(self, size):
+        (readable, _, _) = select.select([self.fd], [], [], self.timeout)
+        if not readable:
+            return b""
+        return os.read(self.fd, size)
+
+    def write(self, data):
+        view = memoryview(data)
+        while view:
+            view = view[os.write(self.fd, view) :]
+
+    def close(self):
+        os.close(self.fd)
+
+
+def open_port(port, baudrate):
+    if os.path.exists(port):
+        return PosixPort(port, baudrate)
+
+    import serial
+
+    return serial.serial_for_url(port, baudrate=baudrate)
+
+
+class C0Link:
+    def __init__(self, port, timeout=0.2, retries=20):
+        self.port = port
+        self.retries = retries
+        self.port.timeout = timeout
+        self.timeout = timeout
+        self.seq = 0
+        self.window = 1
+        self.max_payload = 0
+        self.rx = bytearray()
+        self.retransmits = 0
+
+    def _send(self, seq, command, payload):
+        frame = bytes([seq, command]) + payload
+        frame += crc16(frame).to_bytes(2, "little")
+        self.port.write(cobs_encode(frame) + b"\x00")
+
+    def _receive(self, deadline):
+        """Returns the next valid (seq, status, payload) response, or None on timeout."""
+        while True:
+            if b"\x00" in self.rx:
+                (encoded, _, rest) = self.rx.partition(b"\x00")
+                self.rx = bytearray(rest)
+                try:
+                    frame = cobs_decode(encoded)
+                except ValueError:
+                    continue
+                if len(frame) < 4 or crc16(frame[:-2]) != int.from_bytes(frame[-2:], "little"):
+                    continue
+                return frame[0], frame[1], frame[2:-2]
+
+            if time.monotonic() > deadline:
+                return None
+            self.rx += self.port.read(4096)
+
+    def transact(self, requests):
+        """Sends (command, payload) requests, pipelined, and returns their (status, payload) responses."""
+        responses = [None] * len(requests)
+        base = 0
+        sent = 0
+        timeouts = 0
+
+        while base < len(requests):
+            while sent < len(requests) and sent - base < self.window:
+                (command, payload) = requests[sent]
+                self._send((self.seq + sent) & 0xFF, command, payload)
+                sent += 1
+
+            response = self._receive(time.monotonic() + self.timeout)
+
+            if response is None:
+                timeouts += 1
+                if timeouts > self.retries:
+                    raise LinkError(f"no response after {self.retries} retries")
+                # 	Go back to the first request without a response.
+                self.retransmits += sent - base
+                sent = base
+                continue
+
+            (seq, status, payload) = response
+            if seq == (self.seq + base) & 0xFF:
+                responses[base] = (status, bytes(payload))
+                base += 1
+                timeouts = 0
+
+        self.seq = (self.seq + len(requests)) & 0xFF
+        return responses
+
+    def request(self, command, payload=b""):
+        (status, payload) = self.transact([(command, payload)])[0]
+        if status != STATUS_OK:
+            raise LinkError(f"command 0x{command:02x}: {STATUS_NAMES.get(status, status)}")
+        return payload
+
+    def sync(self):
+        """Resynchronizes sequence numbers, then reads the device's window and maximum payload."""
+        # 	A delimiter ends any partial frame, then stale responses are dropped.
+        self.port.write(b"\x00")
+        while self._receive(time.monotonic() + self.timeout) is not None:
+            pass
+        self.rx = bytearray()
+        self.seq = random.randrange(256)
+        self.window = 1
+        self.request(COMMAND_SYNC)
+        info = self.request(COMMAND_INFO)
+        (version, self.window) = (info[0], info[1])
+        self.max_payload = int.from_bytes(info[2:4], "little")
+        return version
+
+    def echo(self, payloads):
+        responses = self.transact([(COMMAND_ECHO, payload) for payload in payloads])
+        return [payload for (_, payload) in responses]
+
+
+def run_test(link, count, seed):
+    """Echoes random payloads, pipelined, and checks every response. Returns the number of failures."""
+    rng = random.Random(seed)
+    payloads = [
+        bytes(rng.choice((0, rng.randrange(256))) for _ in range(rng.randrange(link.max_payload + 1)))
+        for _ in range(count)
+    ]
+
+    start = time.monotonic()
+    responses = link.echo(payloads)
+    elapsed = time.monotonic() - start
+
+    failures = sum(1 for (payload, response) in zip(payloads, responses) if payload != response)
+    total = sum(len(payload) for payload in payloads)
+
+    (status, _) = link.transact([(COMMAND_USER - 1, b"")])[0]
+    if status != 1:
+        failures += 1
+
+    print(
+        f"c0link: {count} echoes, {total} bytes each way in {elapsed:.2f} s "
+        f"({total / elapsed / 1024:.1f} KiB/s), window {link.window}, "
+        f"{link.retransmits} retransmitted, {failures} failures"
+    )
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Host side of the framed binary UART protocol.",
+    )
+    parser.add_argument("--port", required=True, help="Serial device, PTY, or pyserial URL.")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=0.2, help="Response timeout, in seconds.")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+    subparsers.add_parser("info", help="Prints the protocol parameters.")
+    echo_parser = subparsers.add_parser("echo", help="Echoes a string.")
+    echo_parser.add_argument("text")
+    request_parser = subparsers.add_parser(
+        "request", help="Sends a command, and prints the response payload in hexadecimal."
+    )
+    request_parser.add_argument("id", type=lambda value: int(value, 0), help="Command id.")
+    request_parser.add_argument("payload", nargs="?", default="", help="Payload, in hexadecimal.")
+    test_parser = subparsers.add_parser("test", help="Echoes random payloads, and checks them.")
+    test_parser.add_argument("--count", type=int, default=256)
+    test_parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    link = C0Link(open_port(args.port, args.baudrate), args.timeout)
+    version = link.sync()
+
+    if args.command == "info":
+        print(f"c0link: version {version}, window {link.window}, max payload {link.max_payload}")
+    elif args.command == "echo":
+        print(link.echo([args.text.encode()])[0].decode(errors="replace"))
+    elif args.command == "request":
+        print(link.request(args.id, bytes.fromhex(args.payload)).hex())
+    elif args.command == "test":
+        sys.exit(1 if run_test(link, args.count, args.seed) else 0)
+
+
+if __name__ == "__main__":
+    main()
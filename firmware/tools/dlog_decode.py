@@ -0,0 +1,246 @@
+#!/usr/bin/env python3
+
+# 	Copyright (c) 2024, Signaloid.
+#
+# 	Permission is hereby granted, free of charge, to any person obtaining a copy
+# 	of this software and associated documentation files (the "Software"), to
+# 	deal in the Software without restriction, including without limitation the
+# 	rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# 	sell copies of the Software, and to permit persons to whom the Software is
+# 	furnished to do so, subject to the following conditions:
+#
+# 	The above copyright notice and this permission notice shall be included in
+# 	all copies or substantial portions of the Software.
+#
+# 	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# 	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# 	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# 	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# 	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# 	DEALINGS IN THE SOFTWARE.
+
+"""Prints the deferred log of the firmware (firmware/include/dlog.h) as text.
+
+The input is the raw UART output: frames sent by dlog_drain(), possibly mixed
+with text output, which is printed as it is. A frame is COBS-encoded and
+delimited by zero bytes. Before encoding, it is:
+
+    <format string offset in .dlog, varint>
+    <low 32 bits of the uptime counter, in cycles, 32-bit little-endian>
+    <arguments: integers as zigzag varints, strings as a varint length and bytes>
+    <CRC-16/CCITT-FALSE of the preceding bytes, little-endian>
+
+The format strings are read from the .dlog section of the firmware ELF, and
+formatted as uart_printf() would, after the time since the first frame:
+
+    dlog_decode.py --elf build/firmware/firmware.elf --port /dev/ttyACM0
+    dlog_decode.py --elf build/firmware/firmware.elf capture.bin
+"""
+
+import argparse
+import re
+import sys
+
+from c0link import cobs_decode, crc16, open_port
+from trace_decode import read_section
+
+CLOCK_FORMAT = "dlog: clock %u Hz\n"
+CONVERSION = re.compile(r"%(\*)?(l{0,2})(.)", re.DOTALL)
+
+
+class Frame:
+    """Reads the fields of a decoded frame, without its CRC."""
+
+    def __init__(self, data):
+        self.data = data
+        self.index = 0
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            if self.index >= len(self.data):
+                raise ValueError("truncated varint")
+            byte = self.data[self.index]
+            self.index += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    def integer(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def u32(self):
+        if self.index + 4 > len(self.data):
+            raise ValueError("truncated timestamp")
+        value = int.from_bytes(self.data[self.index : self.index + 4], "little")
+        self.index += 4
+        return value
+
+    def string(self):
+        length = self.varint()
+        value = self.data[self.index : self.index + length]
+        self.index += length
+        return value.decode(errors="replace")
+
+
+def format_record(format_string, frame):
+    """Formats the arguments of a frame, as str_utils_format_sink() does."""
+    output = []
+    position = 0
+
+    for match in CONVERSION.finditer(format_string):
+        output.append(format_string[position : match.start()])
+        position = match.end()
+
+        width = frame.integer() if match.group(1) else 0
+        bits = 64 if len(match.group(2)) == 2 else 32
+        mask = (1 << bits) - 1
+        spec = match.group(3)
+
+        if spec == "%":
+            text = "%"
+        elif spec == "c":
+            text = chr(frame.integer() & 0xFF)
+        elif spec == "s":
+            text = frame.string()
+        elif spec in "dux":
+            value = frame.integer() & mask
+            if spec == "d" and value >> (bits - 1):
+                value -= 1 << bits
+            text = f"{value:x}" if spec == "x" else str(value)
+        else:
+            text = spec
+
+        output.append(text.rjust(width))
+
+    output.append(format_string[position:])
+
+    if frame.index != len(frame.data):
+        raise ValueError("unexpected bytes after the arguments")
+
+    return "".join(output)
+
+
+class Decoder:
+    def __init__(self, formats, clock, output):
+        self.formats = formats
+        self.clock = clock
+        self.output = output
+        self.pending = bytearray()
+        self.cycles = None
+        self.previous = 0
+        self.frames = 0
+        self.errors = 0
+
+    def format_string(self, offset):
+        if offset >= len(self.formats) or (offset > 0 and self.formats[offset - 1] != 0):
+            raise ValueError(f"no format string at 0x{offset:x}")
+        end = self.formats.index(b"\x00", offset)
+        return self.formats[offset:end].decode(errors="replace")
+
+    def frame(self, encoded):
+        """Returns the text of a frame, or None if encoded is not a valid frame."""
+        try:
+            data = cobs_decode(bytes(encoded))
+        except ValueError:
+            return None
+        if len(data) < 7 or crc16(data[:-2]) != int.from_bytes(data[-2:], "little"):
+            return None
+
+        frame = Frame(data[:-2])
+        try:
+            format_string = self.format_string(frame.varint())
+            timestamp = frame.u32()
+            text = format_record(format_string, frame)
+        except ValueError as error:
+            self.errors += 1
+            return f"dlog_decode: bad frame, {error}\n"
+
+        # 	dlog_drain() sends the clock record itself, timestamped after the
+        # 	records logged before, so it does not move the time.
+        if format_string == CLOCK_FORMAT:
+            self.clock = int(text.split()[2])
+        elif self.cycles is None:
+            self.cycles = 0
+            self.previous = timestamp
+        else:
+            # 	Timestamps are the low 32 bits of the uptime counter: extend
+            # 	them, assuming that consecutive frames are less than 2^31 cycles
+            # 	apart. The difference is signed, since the lost records that
+            # 	dlog_drain() sends itself may also be out of order.
+            delta = (timestamp - self.previous) & 0xFFFFFFFF
+            self.cycles += delta - (1 << 32) if delta >> 31 else delta
+            self.previous = timestamp
+
+        self.frames += 1
+        return f"[{(self.cycles or 0) / self.clock:12.6f}] {text}"
+
+    def feed(self, data):
+        """Decodes received bytes, and prints the frames and text they complete."""
+        self.pending += data
+
+        while b"\x00" in self.pending:
+            (piece, _, rest) = self.pending.partition(b"\x00")
+            self.pending = bytearray(rest)
+            if not piece:
+                continue
+
+            text = self.frame(piece)
+            if text is None:
+                # 	Not a frame: text output, or a corrupted frame
+                text = piece.decode(errors="replace")
+            self.output.write(text)
+
+        self.output.flush()
+
+    def flush(self):
+        if self.pending:
+            self.output.write(self.pending.decode(errors="replace"))
+            self.pending = bytearray()
+        self.output.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Prints the deferred log of the firmware as text.",
+    )
+    parser.add_argument("--elf", required=True, help="Firmware ELF.")
+    parser.add_argument("--port", help="Serial device, PTY, or pyserial URL to read from.")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument(
+        "--clock",
+        type=int,
+        default=12000000,
+        help="System clock frequency in Hz, until the log's 'dlog: clock' record.",
+    )
+    parser.add_argument(
+        "capture", nargs="?", default="-", help="Raw UART capture, if no --port (default: stdin)."
+    )
+    args = parser.parse_args()
+
+    formats = read_section(args.elf, ".dlog")
+    decoder = Decoder(formats, args.clock, sys.stdout)
+
+    try:
+        if args.port is not None:
+            port = open_port(args.port, args.baudrate)
+            while True:
+                decoder.feed(port.read(256))
+        elif args.capture == "-":
+            decoder.feed(sys.stdin.buffer.read())
+        else:
+            with open(args.capture, "rb") as capture:
+                decoder.feed(capture.read())
+    except KeyboardInterrupt:
+        pass
+
+    decoder.flush()
+    print(f"dlog_decode: {decoder.frames} frames, {decoder.errors} bad frames", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
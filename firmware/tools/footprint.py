@@ -0,0 +1,380 @@
+#!/usr/bin/env python3
+
+# 	Copyright (c) 2024, Signaloid.
+#
+# 	Permission is hereby granted, free of charge, to any person obtaining a copy
+# 	of this software and associated documentation files (the "Software"), to
+# 	deal in the Software without restriction, including without limitation the
+# 	rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# 	sell copies of the Software, and to permit persons to whom the Software is
+# 	furnished to do so, subject to the following conditions:
+#
+# 	The above copyright notice and this permission notice shall be included in
+# 	all copies or substantial portions of the Software.
+#
+# 	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# 	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# 	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# 	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# 	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# 	DEALINGS IN THE SOFTWARE.
+
+"""Reports the flash, SRAM and stack footprint of the firmware, and checks budgets.
+
+Reads the firmware ELF, its linker map (-Wl,-Map), the -fstack-usage files of
+its objects (.su), and the LiteX generated regions.ld, which gives the origin
+and length of the flash (rom) and SRAM regions:
+
+    flash    loaded sections: .text, .rodata, and the initial .data image
+    SRAM     sections whose address is in the SRAM: .data, .bss, and with
+             BOOT_MODE=sram, everything
+    stack    the largest single stack frame, from -fstack-usage
+
+The report lists the sections, the flash and SRAM used by each object file
+(from the map), the largest functions and variables (from the ELF symbols),
+and the largest stack frames. With --check, only the summary is printed. The
+exit status is 1 when a budget is exceeded, so that the build fails.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+ELF_MAGIC = b"\x7fELF"
+ELF_CLASS_32 = 1
+ELF_DATA_LSB = 1
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+STT_OBJECT = 1
+STT_FUNC = 2
+
+REGION_LINE = re.compile(
+    r"(\w+)\s*:\s*ORIGIN\s*=\s*(0x[0-9a-fA-F]+|\d+)\s*,\s*LENGTH\s*=\s*(0x[0-9a-fA-F]+|\d+)"
+)
+MAP_SECTION_LINE = re.compile(r"^ ?(\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(\S.*))?$")
+ARCHIVE_MEMBER = re.compile(r"^(.*?)([^/]+\.a)\((.*)\)$")
+
+
+class Section:
+    def __init__(self, name, kind, flags, address, size):
+        self.name = name
+        self.loaded = kind != SHT_NOBITS
+        self.alloc = bool(flags & SHF_ALLOC)
+        self.address = address
+        self.size = size
+
+
+class Region:
+    def __init__(self, name, origin, length):
+        self.name = name
+        self.origin = origin
+        self.length = length
+
+    def contains(self, address):
+        return self.origin <= address < self.origin + self.length
+
+
+def read_elf(path):
+    """Returns (sections, symbols) of a little-endian 32-bit ELF, where symbols
+    are (name, address, size, is_function) tuples of its functions and variables."""
+    with open(path, "rb") as elf:
+        data = elf.read()
+
+    if data[:4] != ELF_MAGIC or data[4] != ELF_CLASS_32 or data[5] != ELF_DATA_LSB:
+        raise ValueError(f"{path}: not a little-endian 32-bit ELF file")
+
+    shoff = struct.unpack_from("<I", data, 32)[0]
+    (shentsize, shnum, shstrndx) = struct.unpack_from("<HHH", data, 46)
+
+    headers = [
+        struct.unpack_from("<IIIIIIIIII", data, shoff + index * shentsize)
+        for index in range(shnum)
+    ]
+
+    def string(table, offset):
+        start = headers[table][4] + offset
+        return data[start : data.index(b"\x00", start)].decode(errors="replace")
+
+    sections = []
+    symbols = []
+
+    for header in headers:
+        (sh_name, sh_type, sh_flags, sh_addr, sh_offset, sh_size, sh_link) = header[:7]
+        sections.append(Section(string(shstrndx, sh_name), sh_type, sh_flags, sh_addr, sh_size))
+
+        if sh_type != SHT_SYMTAB:
+            continue
+
+        for offset in range(sh_offset, sh_offset + sh_size, 16):
+            (st_name, st_value, st_size, st_info, _, st_shndx) = struct.unpack_from(
+                "<IIIBBH", data, offset
+            )
+            kind = st_info & 0xF
+            if kind in (STT_OBJECT, STT_FUNC) and st_size > 0 and 0 < st_shndx < shnum:
+                symbols.append((string(sh_link, st_name), st_value, st_size, kind == STT_FUNC))
+
+    return [section for section in sections if section.alloc and section.size > 0], symbols
+
+
+def read_regions(path):
+    """Returns the memory regions of a linker script MEMORY command, by name."""
+    with open(path) as regions:
+        return {
+            match.group(1): Region(match.group(1), int(match.group(2), 0), int(match.group(3), 0))
+            for match in REGION_LINE.finditer(regions.read())
+        }
+
+
+def object_name(path):
+    """Shortens an input file of the map to its file name, or archive(member)."""
+    match = ARCHIVE_MEMBER.match(path)
+    if match is not None:
+        return f"{match.group(2)}({os.path.basename(match.group(3))})"
+    return os.path.basename(path)
+
+
+def read_map(path, sections, sram):
+    """Returns {object file: [flash bytes, SRAM bytes]} from a GNU ld map file."""
+    by_name = {section.name: section for section in sections}
+    objects = {}
+    output = None
+    pending = None
+
+    with open(path, errors="replace") as map_file:
+        lines = iter(map_file)
+        for line in lines:
+            if line.startswith("Linker script and memory map"):
+                break
+
+        for line in lines:
+            line = line.rstrip("\n")
+
+            # 	An output section starts in the first column.
+            if line[:1] not in ("", " "):
+                output = by_name.get(line.split()[0])
+                pending = None
+                continue
+
+            # 	Long input section names are on a line of their own.
+            if re.match(r"^ \S+$", line):
+                pending = line.strip()
+                continue
+
+            match = MAP_SECTION_LINE.match(line)
+            if match is None or output is None:
+                pending = None
+                continue
+
+            (name, address, size, source) = match.groups()
+            name = name or pending
+            pending = None
+            size = int(size, 16)
+
+            if name is None or source is None or size == 0 or name == "*fill*":
+                continue
+
+            usage = objects.setdefault(object_name(source.strip()), [0, 0])
+            if output.loaded:
+                usage[0] += size
+            if sram.contains(int(address, 16)):
+                usage[1] += size
+
+    return objects
+
+
+def read_stack_usage(paths):
+    """Returns (function, source, bytes, qualifiers) tuples from -fstack-usage files, and the missing files."""
+    frames = []
+    missing = []
+
+    for path in paths:
+        if not os.path.exists(path):
+            missing.append(path)
+            continue
+        with open(path) as su:
+            for line in su:
+                fields = line.rstrip("\n").split("\t")
+                if len(fields) != 3:
+                    continue
+                location = fields[0].split(":", 3)
+                function = location[-1]
+                source = os.path.basename(location[0])
+                frames.append((function, source, int(fields[1]), fields[2]))
+
+    return (frames, missing)
+
+
+def percent(used, total):
+    return f"{100.0 * used / total:5.1f}%" if total else "    -"
+
+
+def print_table(title, header, rows):
+    print(f"\n{title}")
+    print(header)
+    for row in rows:
+        print(row.rstrip())
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Reports the flash, SRAM and stack footprint of the firmware, and checks budgets.",
+    )
+    parser.add_argument("--elf", required=True, help="Firmware ELF.")
+    parser.add_argument("--map", help="Linker map of the firmware ELF.")
+    parser.add_argument("--regions", required=True, help="LiteX generated regions.ld.")
+    parser.add_argument(
+        "--su", nargs="*", default=[], help="-fstack-usage files of the firmware objects."
+    )
+    parser.add_argument("--flash-region", default="rom", help="Flash region name (default: rom).")
+    parser.add_argument("--sram-region", default="sram", help="SRAM region name (default: sram).")
+    parser.add_argument(
+        "--flash-overhead",
+        type=lambda value: int(value, 0),
+        default=0,
+        help="Flash bytes used besides the ELF, e.g. by the BOOT_MODE=sram loader.",
+    )
+    parser.add_argument(
+        "--flash-budget",
+        type=lambda value: int(value, 0),
+        help="Flash budget in bytes (default: the flash region length).",
+    )
+    parser.add_argument(
+        "--sram-budget",
+        type=lambda value: int(value, 0),
+        help="Budget of statically allocated SRAM in bytes (default: the SRAM region length, minus --stack-reserve).",
+    )
+    parser.add_argument(
+        "--stack-reserve",
+        type=lambda value: int(value, 0),
+        default=0,
+        help="SRAM bytes to leave free for the stack.",
+    )
+    parser.add_argument(
+        "--frame-budget",
+        type=lambda value: int(value, 0),
+        help="Budget of a single function's stack frame in bytes.",
+    )
+    parser.add_argument(
+        "--top", type=int, default=16, help="Number of functions, variables and frames listed."
+    )
+    parser.add_argument(
+        "--check", action="store_true", help="Only print the summary, and the exceeded budgets."
+    )
+    args = parser.parse_args()
+
+    regions = read_regions(args.regions)
+    for name in (args.flash_region, args.sram_region):
+        if name not in regions:
+            sys.exit(f"footprint: no {name} region in {args.regions}")
+    flash = regions[args.flash_region]
+    sram = regions[args.sram_region]
+
+    (sections, symbols) = read_elf(args.elf)
+    (frames, missing_su) = read_stack_usage(args.su)
+
+    flash_used = args.flash_overhead + sum(section.size for section in sections if section.loaded)
+    sram_used = sum(section.size for section in sections if sram.contains(section.address))
+    largest_frame = max(frames, key=lambda frame: frame[2], default=None)
+
+    flash_budget = args.flash_budget if args.flash_budget is not None else flash.length
+    sram_budget = args.sram_budget if args.sram_budget is not None else sram.length - args.stack_reserve
+
+    if not args.check:
+        print_table(
+            "Sections",
+            f"{'section':<24} {'address':>10} {'size':>8}  flash  SRAM",
+            (
+                f"{section.name:<24} 0x{section.address:08x} {section.size:>8}  "
+                f"{'x' if section.loaded else ' ':^5}  {'x' if sram.contains(section.address) else ' ':^4}"
+                for section in sorted(sections, key=lambda section: section.address)
+            ),
+        )
+
+        if args.map is not None:
+            objects = read_map(args.map, sections, sram)
+            print_table(
+                "Object files",
+                f"{'object':<40} {'flash':>8} {'SRAM':>8}",
+                (
+                    f"{name:<40} {usage[0]:>8} {usage[1]:>8}"
+                    for (name, usage) in sorted(objects.items(), key=lambda item: -sum(item[1]))
+                ),
+            )
+
+        for (title, functions) in (("Functions", True), ("Variables", False)):
+            print_table(
+                f"Largest {title.lower()}",
+                f"{title[:-1].lower():<40} {'address':>10} {'size':>8}  region",
+                (
+                    f"{name:<40} 0x{address:08x} {size:>8}  "
+                    f"{sram.name if sram.contains(address) else flash.name}"
+                    for (name, address, size, _) in sorted(
+                        (symbol for symbol in symbols if symbol[3] == functions),
+                        key=lambda symbol: -symbol[2],
+                    )[: args.top]
+                ),
+            )
+
+        print_table(
+            "Largest stack frames",
+            f"{'function':<40} {'source':<20} {'bytes':>6}  qualifiers",
+            (
+                f"{function:<40} {source:<20} {size:>6}  {qualifiers}"
+                for (function, source, size, qualifiers) in sorted(frames, key=lambda frame: -frame[2])[
+                    : args.top
+                ]
+            ),
+        )
+
+        unbounded = [frame for frame in frames if frame[3] == "dynamic"]
+        if unbounded:
+            print_table(
+                "Unbounded stack frames (alloca or variable length arrays)",
+                f"{'function':<40} {'source':<20}",
+                (f"{function:<40} {source:<20}" for (function, source, _, _) in unbounded),
+            )
+        print()
+
+    summary = (
+        f"footprint: flash {flash_used} of {flash_budget} bytes ({percent(flash_used, flash_budget).strip()}), "
+        f"SRAM {sram_used} of {sram_budget} bytes ({percent(sram_used, sram_budget).strip()})"
+    )
+    if largest_frame is not None:
+        summary += f", largest stack frame {largest_frame[2]} bytes ({largest_frame[0]})"
+    print(summary)
+
+    errors = []
+    if flash_used > flash_budget:
+        errors.append(f"flash use {flash_used} exceeds the budget of {flash_budget} bytes")
+    if sram_used > sram_budget:
+        errors.append(
+            f"SRAM use {sram_used} exceeds the budget of {sram_budget} bytes"
+            + (f", which leaves {args.stack_reserve} bytes for the stack" if args.sram_budget is None else "")
+        )
+    #   A missing file would hide the frames of its functions from the budget,
+    #   e.g. with LTO, when the compiler only generates code at the link.
+    for path in missing_su:
+        if args.frame_budget is not None:
+            errors.append(f"no stack usage file {path}, so its frames cannot be checked")
+        else:
+            print(f"footprint: warning: no stack usage file {path}", file=sys.stderr)
+    if args.frame_budget is not None:
+        for (function, source, size, _) in frames:
+            if size > args.frame_budget:
+                errors.append(
+                    f"stack frame of {function} ({source}) is {size} bytes, over the budget of {args.frame_budget} bytes"
+                )
+
+    for error in errors:
+        print(f"footprint: error: {error}", file=sys.stderr)
+
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
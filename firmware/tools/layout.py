@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+
+# 	Copyright (c) 2024, Signaloid.
+#
+# 	Permission is hereby granted, free of charge, to any person obtaining a copy
+# 	of this software and associated documentation files (the "Software"), to
+# 	deal in the Software without restriction, including without limitation the
+# 	rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# 	sell copies of the Software, and to permit persons to whom the Software is
+# 	furnished to do so, subject to the following conditions:
+#
+# 	The above copyright notice and this permission notice shall be included in
+# 	all copies or substantial portions of the Software.
+#
+# 	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# 	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# 	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# 	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# 	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# 	DEALINGS IN THE SOFTWARE.
+
+"""Generates a section-ordering file from a PC-sample profile of the firmware.
+
+The input is a serial console log which contains the output of
+pcsample_dump() (see firmware/include/pcsample.h), possibly mixed with other
+output:
+
+    pcsample: base <address of _ftext> shift <log2 bucket size> samples <total>
+    pcsample: <bucket offset> <samples>
+    pcsample: other <samples outside the code in flash>
+
+The samples of each bucket are shared among the functions of the firmware ELF
+it overlaps, in proportion to the overlap. The output lists the hot functions,
+i.e. the fewest that hold --coverage of the samples in flash, by decreasing
+samples per byte, as linker script input section statements: the linker
+scripts include it at the start of .text, as the firmware Makefile's LAYOUT.
+
+Function sections are named after the functions, with -ffunction-sections,
+and the statements also match the suffixed clones GCC makes of them, e.g.
+.text.foo.part.0 or, with LTO, .text.foo.lto_priv.0.
+
+With --ram-budget, the hottest functions whose total size fits in the budget
+are also printed as a RAMTEXT_FUNCTIONS value.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+ELF_MAGIC = b"\x7fELF"
+ELF_CLASS_32 = 1
+ELF_DATA_LSB = 1
+
+SHT_SYMTAB = 2
+STT_FUNC = 2
+
+PCSAMPLE_LINE = re.compile(r"pcsample: (\S+) (\S+)(?: shift (\S+))?")
+
+
+def read_functions(path):
+    """Returns the (name, address, size) of the functions of a little-endian 32-bit ELF."""
+    with open(path, "rb") as elf:
+        data = elf.read()
+
+    if data[:4] != ELF_MAGIC or data[4] != ELF_CLASS_32 or data[5] != ELF_DATA_LSB:
+        raise ValueError(f"{path}: not a little-endian 32-bit ELF file")
+
+    shoff = struct.unpack_from("<I", data, 32)[0]
+    (shentsize, shnum) = struct.unpack_from("<HH", data, 46)
+
+    headers = [
+        struct.unpack_from("<IIIIIIII", data, shoff + index * shentsize) for index in range(shnum)
+    ]
+    functions = {}
+
+    for (_, sh_type, _, _, sh_offset, sh_size, sh_link, _) in headers:
+        if sh_type != SHT_SYMTAB:
+            continue
+
+        strtab = headers[sh_link][4]
+        for offset in range(sh_offset, sh_offset + sh_size, 16):
+            (st_name, st_value, st_size, st_info, _, _) = struct.unpack_from("<IIIBBH", data, offset)
+            if st_info & 0xF == STT_FUNC and st_size > 0:
+                start = strtab + st_name
+                name = data[start : data.index(b"\x00", start)].decode(errors="replace")
+                functions[st_value] = (name, st_value, st_size)
+
+    return sorted(functions.values(), key=lambda function: function[1])
+
+
+def read_profile(lines):
+    """Returns (base, shift, {bucket offset: samples}, samples outside the code in flash)."""
+    base = None
+    shift = None
+    buckets = {}
+    other = 0
+
+    for line in lines:
+        match = PCSAMPLE_LINE.search(line)
+        if match is None:
+            continue
+
+        if match.group(1) == "base":
+            # 	A new dump replaces the previous one.
+            base = int(match.group(2), 16)
+            shift = int(match.group(3))
+            buckets = {}
+            other = 0
+        elif match.group(1) == "other":
+            other = int(match.group(2))
+        elif base is not None:
+            buckets[int(match.group(1), 16)] = int(match.group(2))
+
+    if base is None:
+        raise ValueError("no pcsample_dump() output in the log")
+
+    return base, shift, buckets, other
+
+
+def attribute(functions, base, shift, buckets):
+    """Shares the samples of each bucket among the functions it overlaps."""
+    samples = {}
+    bucket_size = 1 << shift
+
+    for (offset, count) in buckets.items():
+        start = base + offset
+        end = start + bucket_size
+        overlaps = []
+
+        for (name, address, size) in functions:
+            overlap = min(end, address + size) - max(start, address)
+            if overlap > 0:
+                overlaps.append((name, overlap))
+
+        total = sum(overlap for (_, overlap) in overlaps)
+        for (name, overlap) in overlaps:
+            samples[name] = samples.get(name, 0.0) + count * overlap / total
+
+    return samples
+
+
+def section_name(function):
+    """Returns the name of the function GCC made a clone of, e.g. foo for foo.part.0."""
+    return function.split(".")[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Generates a section-ordering file from a PC-sample profile of the firmware.",
+    )
+    parser.add_argument("--elf", required=True, help="Firmware ELF the profile was taken with.")
+    parser.add_argument(
+        "--coverage",
+        type=float,
+        default=0.99,
+        help="Fraction of the samples in flash the hot functions must hold (default: 0.99).",
+    )
+    parser.add_argument(
+        "--ram-budget",
+        type=lambda value: int(value, 0),
+        help="Also print the hottest functions that fit in this many bytes of SRAM, as RAMTEXT_FUNCTIONS.",
+    )
+    parser.add_argument("-o", "--output", default="layout.ld", help="Section-ordering file.")
+    parser.add_argument(
+        "log", nargs="?", default="-", help="Serial console log (default: stdin)."
+    )
+    args = parser.parse_args()
+
+    functions = read_functions(args.elf)
+
+    if args.log == "-":
+        (base, shift, buckets, other) = read_profile(sys.stdin)
+    else:
+        with open(args.log, errors="replace") as log:
+            (base, shift, buckets, other) = read_profile(log)
+
+    samples = attribute(functions, base, shift, buckets)
+    sizes = {name: size for (name, _, size) in functions}
+    total = sum(samples.values())
+
+    hot = []
+    covered = 0.0
+    for name in sorted(samples, key=lambda name: -samples[name]):
+        if covered >= args.coverage * total:
+            break
+        hot.append(name)
+        covered += samples[name]
+
+    # 	Densest first, so that the hottest code shares the fewest flash reads.
+    hot.sort(key=lambda name: -samples[name] / sizes[name])
+
+    with open(args.output, "w") as output:
+        output.write(
+            "/*\n"
+            f" * \tGenerated by tools/layout.py from {sum(buckets.values())} PC samples in flash:\n"
+            " * \tthe hot functions, by decreasing samples per byte.\n"
+            " */\n"
+        )
+        listed = set()
+        for name in hot:
+            section = section_name(name)
+            if section in listed:
+                continue
+            listed.add(section)
+            output.write(
+                f"*(.text.{section} .text.{section}.*)\t/* {samples[name]:.0f} samples, {sizes[name]} bytes */\n"
+            )
+
+    print(
+        f"layout: {len(listed)} hot functions, {sum(sizes[name] for name in hot)} bytes, "
+        f"hold {100.0 * covered / total if total else 0.0:.1f}% of {total:.0f} samples in flash "
+        f"({other} samples elsewhere), written to {args.output}"
+    )
+
+    if args.ram_budget is not None:
+        ram = []
+        used = 0
+        for name in sorted(hot, key=lambda name: -samples[name]):
+            if used + sizes[name] <= args.ram_budget and section_name(name) == name:
+                ram.append(name)
+                used += sizes[name]
+        print(f'RAMTEXT_FUNCTIONS="{" ".join(ram)}"')
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+
+# 	Copyright (c) 2024, Signaloid.
+#
+# 	Permission is hereby granted, free of charge, to any person obtaining a copy
+# 	of this software and associated documentation files (the "Software"), to
+# 	deal in the Software without restriction, including without limitation the
+# 	rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# 	sell copies of the Software, and to permit persons to whom the Software is
+# 	furnished to do so, subject to the following conditions:
+#
+# 	The above copyright notice and this permission notice shall be included in
+# 	all copies or substantial portions of the Software.
+#
+# 	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# 	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# 	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# 	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# 	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# 	DEALINGS IN THE SOFTWARE.
+
+"""Builds the BOOT_MODE=sram flash image: loader, header, application image.
+
+The header layout, and the image offset, must match LoaderHeader in
+firmware/include/loader.h and LOADER_SIZE in the firmware Makefile:
+
+    offset 0              loader binary, padded with 0xff to LOADER_SIZE
+    offset LOADER_SIZE    header: magic, load address, length, entry, CRC-32
+    offset + 20           application image, padded with zeros to 4 bytes
+
+The load address and the entry point come from the application ELF, and the
+image is its objcopy binary, which starts at the load address.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+LOADER_MAGIC = 0x444C3043
+
+ELF_MAGIC = b"\x7fELF"
+ELF_CLASS_32 = 1
+ELF_DATA_LSB = 1
+PT_LOAD = 1
+
+
+def read_elf(path):
+    """Returns (load address, entry point) of a little-endian 32-bit ELF."""
+    with open(path, "rb") as elf:
+        data = elf.read()
+
+    if data[:4] != ELF_MAGIC or data[4] != ELF_CLASS_32 or data[5] != ELF_DATA_LSB:
+        raise ValueError(f"{path}: not a little-endian 32-bit ELF file")
+
+    (entry, phoff) = struct.unpack_from("<II", data, 24)
+    (phentsize, phnum) = struct.unpack_from("<HH", data, 42)
+
+    load_addresses = []
+    for i in range(phnum):
+        (p_type, _, _, p_paddr, p_filesz) = struct.unpack_from(
+            "<IIIII", data, phoff + i * phentsize
+        )
+        if p_type == PT_LOAD and p_filesz > 0:
+            load_addresses.append(p_paddr)
+
+    if not load_addresses:
+        raise ValueError(f"{path}: no loadable segments")
+
+    return min(load_addresses), entry
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Builds the BOOT_MODE=sram flash image.",
+    )
+    parser.add_argument("--loader", required=True, help="Loader binary.")
+    parser.add_argument(
+        "--loader-size",
+        required=True,
+        type=lambda value: int(value, 0),
+        help="Flash space reserved for the loader, in bytes.",
+    )
+    parser.add_argument("--elf", required=True, help="Application ELF.")
+    parser.add_argument(
+        "--image", required=True, help="Application binary, from objcopy."
+    )
+    parser.add_argument("-o", "--output", required=True, help="Flash image.")
+    args = parser.parse_args()
+
+    with open(args.loader, "rb") as loader_file:
+        loader = loader_file.read()
+    with open(args.image, "rb") as image_file:
+        image = image_file.read()
+
+    if len(loader) > args.loader_size:
+        sys.exit(
+            f"mkimage: the loader is {len(loader)} bytes, "
+            f"more than LOADER_SIZE ({args.loader_size} bytes)"
+        )
+
+    load_address, entry = read_elf(args.elf)
+    image += b"\x00" * (-len(image) % 4)
+
+    if not load_address <= entry < load_address + len(image):
+        sys.exit(
+            f"mkimage: entry point 0x{entry:08x} is outside the image "
+            f"(0x{load_address:08x}, {len(image)} bytes)"
+        )
+
+    header = struct.pack(
+        "<IIIII",
+        LOADER_MAGIC,
+        load_address,
+        len(image),
+        entry,
+        zlib.crc32(image),
+    )
+
+    with open(args.output, "wb") as output:
+        output.write(loader.ljust(args.loader_size, b"\xff"))
+        output.write(header)
+        output.write(image)
+
+    print(
+        f"mkimage: {len(image)} bytes at 0x{load_address:08x}, "
+        f"entry 0x{entry:08x}, CRC-32 0x{zlib.crc32(image):08x}"
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+
+# 	Copyright (c) 2024, Signaloid.
+#
+# 	Permission is hereby granted, free of charge, to any person obtaining a copy
+# 	of this software and associated documentation files (the "Software"), to
+# 	deal in the Software without restriction, including without limitation the
+# 	rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# 	sell copies of the Software, and to permit persons to whom the Software is
+# 	furnished to do so, subject to the following conditions:
+#
+# 	The above copyright notice and this permission notice shall be included in
+# 	all copies or substantial portions of the Software.
+#
+# 	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# 	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# 	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# 	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# 	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# 	DEALINGS IN THE SOFTWARE.
+
+"""Packs a directory into a read-only file image, for the SPI flash.
+
+The image layout must match RomfsHeader and RomfsEntry in
+firmware/include/romfs.h. All fields are little-endian:
+
+    header    magic, version, directory CRC-16, count, directory size, size
+    entries   hash, name offset, data offset, size, data CRC-16, name length
+    names     NUL-terminated, UTF-8
+    data      each file aligned to --align bytes, padded with 0xff
+
+The entries are sorted by the FNV-1a hash of the name, then by name, so that
+the firmware finds a file with a binary search. File names are the paths
+relative to the packed directory, with "/" separators.
+
+    mkromfs.py pack <directory> -o romfs.bin
+    mkromfs.py list romfs.bin
+    mkromfs.py flash-image --firmware firmware.bin --offset 0x100000 romfs.bin -o flash.bin
+
+flash-image writes the firmware binary, padded with 0xff to the offset, and
+the image after it, so that both are flashed together.
+"""
+
+import argparse
+import binascii
+import os
+import struct
+import sys
+
+ROMFS_MAGIC = 0x53463043
+ROMFS_VERSION = 1
+
+HEADER = struct.Struct("<IHHIII")
+ENTRY = struct.Struct("<IIIIHH")
+
+FNV_BASIS = 0x811C9DC5
+FNV_PRIME = 0x01000193
+
+# 	The flash erase sector. The image offset must be a multiple of it, so that
+# 	flashing the image does not erase the end of the firmware, and the file
+# 	alignment holds in the memory map too.
+SECTOR_SIZE = 4096
+
+NAME_MAX = 0xFFFF
+
+
+def fnv1a(name):
+    """Returns the FNV-1a 32-bit hash of name, as romfs_hash()."""
+    value = FNV_BASIS
+    for byte in name:
+        value = ((value ^ byte) * FNV_PRIME) & 0xFFFFFFFF
+    return value
+
+
+def crc16(data):
+    """Returns the CRC-16/CCITT-FALSE of data, as crc16_update()."""
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def align_up(value, alignment):
+    return (value + alignment - 1) & ~(alignment - 1)
+
+
+def pack(files, alignment):
+    """Returns the image of files, a list of (name, data) with bytes names."""
+    files = sorted(files, key=lambda file: (fnv1a(file[0]), file[0]))
+
+    names = bytearray()
+    name_offsets = []
+    names_start = HEADER.size + ENTRY.size * len(files)
+    for name, _ in files:
+        name_offsets.append(names_start + len(names))
+        names += name + b"\x00"
+
+    directory_size = ENTRY.size * len(files) + len(names)
+    offset = align_up(HEADER.size + directory_size, alignment)
+    data = bytearray()
+    entries = bytearray()
+    for (name, contents), name_offset in zip(files, name_offsets):
+        data += b"\xff" * (offset - HEADER.size - directory_size - len(data))
+        entries += ENTRY.pack(
+            fnv1a(name), name_offset, offset, len(contents), crc16(contents), len(name)
+        )
+        data += contents
+        offset = align_up(offset + len(contents), alignment)
+
+    directory = bytes(entries + names)
+    header = HEADER.pack(
+        ROMFS_MAGIC,
+        ROMFS_VERSION,
+        crc16(directory),
+        len(files),
+        directory_size,
+        HEADER.size + directory_size + len(data),
+    )
+    return header + directory + bytes(data)
+
+
+def unpack(image):
+    """Returns the (name, data) of the files of image, checking it like romfs_mount()."""
+    if len(image) < HEADER.size:
+        raise ValueError("image shorter than its header")
+
+    magic, version, directory_crc, count, directory_size, size = HEADER.unpack_from(image)
+    if magic != ROMFS_MAGIC or version != ROMFS_VERSION:
+        raise ValueError(f"not a version {ROMFS_VERSION} image")
+    if size > len(image) or HEADER.size + directory_size > size:
+        raise ValueError(f"image of {size} bytes, truncated to {len(image)} bytes")
+    if crc16(image[HEADER.size : HEADER.size + directory_size]) != directory_crc:
+        raise ValueError("directory CRC mismatch")
+
+    files = []
+    for i in range(count):
+        hash_value, name_offset, offset, length, data_crc, name_length = ENTRY.unpack_from(
+            image, HEADER.size + i * ENTRY.size
+        )
+        name = bytes(image[name_offset : name_offset + name_length])
+        data = bytes(image[offset : offset + length])
+        if fnv1a(name) != hash_value:
+            raise ValueError(f"{name!r}: hash mismatch")
+        if len(data) != length or crc16(data) != data_crc:
+            raise ValueError(f"{name!r}: data CRC mismatch")
+        files.append((name, data))
+
+    return files
+
+
+def read_directory(path):
+    """Returns the (name, data) of every file under path, in a stable order."""
+    files = []
+    for root, directories, filenames in os.walk(path):
+        directories.sort()
+        for filename in sorted(filenames):
+            file_path = os.path.join(root, filename)
+            name = os.path.relpath(file_path, path).replace(os.sep, "/").encode()
+            if len(name) > NAME_MAX:
+                raise ValueError(f"{file_path}: name longer than {NAME_MAX} bytes")
+            with open(file_path, "rb") as file:
+                files.append((name, file.read()))
+    return files
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Packs a directory into a read-only file image, for the SPI flash.",
+    )
+    subparsers = parser.add_subparsers(dest="command", required=True)
+    pack_parser = subparsers.add_parser("pack", help="Packs a directory into an image.")
+    pack_parser.add_argument("directory")
+    pack_parser.add_argument(
+        "--align",
+        type=lambda value: int(value, 0),
+        default=16,
+        help="Alignment of the file data, in bytes, a power of 2 (default: 16).",
+    )
+    pack_parser.add_argument("-o", "--output", required=True, help="Image.")
+    list_parser = subparsers.add_parser("list", help="Checks an image, and lists its files.")
+    list_parser.add_argument("image")
+    flash_parser = subparsers.add_parser(
+        "flash-image", help="Appends an image to the firmware binary, at an offset."
+    )
+    flash_parser.add_argument("--firmware", required=True, help="Firmware binary.")
+    flash_parser.add_argument(
+        "--offset",
+        required=True,
+        type=lambda value: int(value, 0),
+        help="Offset of the image from the start of the firmware binary, in bytes.",
+    )
+    flash_parser.add_argument("image")
+    flash_parser.add_argument("-o", "--output", required=True, help="Flash image.")
+    args = parser.parse_args()
+
+    if args.command == "pack":
+        if args.align <= 0 or args.align & (args.align - 1) or args.align > SECTOR_SIZE:
+            sys.exit(f"mkromfs: --align must be a power of 2, up to {SECTOR_SIZE}")
+        try:
+            files = read_directory(args.directory)
+        except (OSError, ValueError) as error:
+            sys.exit(f"mkromfs: {error}")
+        image = pack(files, args.align)
+        with open(args.output, "wb") as output:
+            output.write(image)
+        print(f"mkromfs: {len(files)} files, {len(image)} bytes, aligned to {args.align} bytes")
+    elif args.command == "list":
+        with open(args.image, "rb") as image_file:
+            image = image_file.read()
+        try:
+            files = unpack(image)
+        except ValueError as error:
+            sys.exit(f"mkromfs: {args.image}: {error}")
+        for name, data in files:
+            print(f"{len(data):10d}  {name.decode(errors='replace')}")
+        print(f"mkromfs: {len(files)} files, {len(image)} bytes")
+    elif args.command == "flash-image":
+        with open(args.firmware, "rb") as firmware_file:
+            firmware = firmware_file.read()
+        with open(args.image, "rb") as image_file:
+            image = image_file.read()
+        if args.offset % SECTOR_SIZE:
+            sys.exit(f"mkromfs: the offset must be a multiple of {SECTOR_SIZE} bytes")
+        if len(firmware) > args.offset:
+            sys.exit(
+                f"mkromfs: the firmware is {len(firmware)} bytes, "
+                f"more than the image offset ({args.offset} bytes)"
+            )
+        with open(args.output, "wb") as output:
+            output.write(firmware.ljust(args.offset, b"\xff"))
+            output.write(image)
+        print(
+            f"mkromfs: {len(firmware)} bytes of firmware, "
+            f"{len(image)} bytes of files at offset 0x{args.offset:x}"
+        )
+
+
+if __name__ == "__main__":
+    main()
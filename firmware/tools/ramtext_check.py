@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+
+# 	Copyright (c) 2024, Signaloid.
+#
+# 	Permission is hereby granted, free of charge, to any person obtaining a copy
+# 	of this software and associated documentation files (the "Software"), to
+# 	deal in the Software without restriction, including without limitation the
+# 	rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# 	sell copies of the Software, and to permit persons to whom the Software is
+# 	furnished to do so, subject to the following conditions:
+#
+# 	The above copyright notice and this permission notice shall be included in
+# 	all copies or substantial portions of the Software.
+#
+# 	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# 	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# 	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# 	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# 	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# 	DEALINGS IN THE SOFTWARE.
+
+"""Checks that the code of object files only executes from SRAM.
+
+Reads relocatable ELF objects, 32-bit or 64-bit, so that it checks firmware and
+host objects alike, and fails when an object:
+
+- has code outside the .ramtext sections (see include/ramfunc.h), e.g. a static
+  helper the compiler emitted out of line, which would execute from flash, or
+- references one of the functions given with --no-calls, e.g. a memcpy() call
+  the compiler generated for a byte loop of memcpy() itself.
+
+For example, the firmware build checks src/mem.c with:
+
+    python3 tools/ramtext_check.py --no-calls memcpy memmove memset memcmp strlen -- mem.o
+
+The exit status is 1 when a check fails, so that the build fails.
+"""
+
+import argparse
+import struct
+import sys
+
+ELF_MAGIC = b"\x7fELF"
+ELF_CLASS_32 = 1
+ELF_CLASS_64 = 2
+ELF_DATA_LSB = 1
+ET_REL = 1
+
+SHT_SYMTAB = 2
+SHT_RELA = 4
+SHT_REL = 9
+SHF_EXECINSTR = 0x4
+
+RAMTEXT_SECTION = ".ramtext"
+
+
+def read_object(path):
+    """Returns the (name, size) of the code sections of a little-endian relocatable
+    ELF object, and the names of the symbols its relocations reference."""
+    with open(path, "rb") as elf:
+        data = elf.read()
+
+    if data[:4] != ELF_MAGIC or data[4] not in (ELF_CLASS_32, ELF_CLASS_64) or data[5] != ELF_DATA_LSB:
+        raise ValueError(f"{path}: not a little-endian ELF file")
+
+    is_64 = data[4] == ELF_CLASS_64
+    if struct.unpack_from("<H", data, 16)[0] != ET_REL:
+        raise ValueError(f"{path}: not a relocatable object")
+
+    if is_64:
+        shoff = struct.unpack_from("<Q", data, 40)[0]
+        (shentsize, shnum, shstrndx) = struct.unpack_from("<HHH", data, 58)
+        header_format = "<IIQQQQIIQQ"
+    else:
+        shoff = struct.unpack_from("<I", data, 32)[0]
+        (shentsize, shnum, shstrndx) = struct.unpack_from("<HHH", data, 46)
+        header_format = "<IIIIIIIIII"
+
+    headers = [
+        struct.unpack_from(header_format, data, shoff + index * shentsize)
+        for index in range(shnum)
+    ]
+
+    def string(table, offset):
+        start = headers[table][4] + offset
+        return data[start : data.index(b"\x00", start)].decode(errors="replace")
+
+    def symbol_name(symtab, index):
+        (_, _, _, _, sh_offset, _, sh_link, _, _, sh_entsize) = headers[symtab]
+        st_name = struct.unpack_from("<I", data, sh_offset + index * sh_entsize)[0]
+        return string(sh_link, st_name)
+
+    code = []
+    references = set()
+
+    for header in headers:
+        (sh_name, sh_type, sh_flags, _, sh_offset, sh_size, sh_link, _, _, sh_entsize) = header
+
+        if sh_flags & SHF_EXECINSTR:
+            code.append((string(shstrndx, sh_name), sh_size))
+
+        if sh_type not in (SHT_REL, SHT_RELA) or headers[sh_link][1] != SHT_SYMTAB:
+            continue
+
+        for offset in range(sh_offset, sh_offset + sh_size, sh_entsize):
+            if is_64:
+                index = struct.unpack_from("<Q", data, offset + 8)[0] >> 32
+            else:
+                index = struct.unpack_from("<I", data, offset + 4)[0] >> 8
+            if index != 0:
+                references.add(symbol_name(sh_link, index))
+
+    return code, references
+
+
+def is_ramtext(name):
+    return name == RAMTEXT_SECTION or name.startswith(RAMTEXT_SECTION + ".")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Checks that the code of object files only executes from SRAM.",
+    )
+    parser.add_argument(
+        "--no-calls",
+        nargs="*",
+        default=[],
+        help="Functions the objects must not reference.",
+    )
+    parser.add_argument("objects", nargs="+", help="Relocatable ELF objects.")
+    args = parser.parse_args()
+
+    errors = []
+    for path in args.objects:
+        (code, references) = read_object(path)
+
+        for (name, size) in code:
+            if size > 0 and not is_ramtext(name):
+                errors.append(f"{path}: {size} bytes of code in {name}, outside {RAMTEXT_SECTION}")
+        for name in sorted(references.intersection(args.no_calls)):
+            errors.append(f"{path}: references {name}")
+
+    for error in errors:
+        print(f"ramtext_check: error: {error}", file=sys.stderr)
+
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+
+# 	Copyright (c) 2024, Signaloid.
+#
+# 	Permission is hereby granted, free of charge, to any person obtaining a copy
+# 	of this software and associated documentation files (the "Software"), to
+# 	deal in the Software without restriction, including without limitation the
+# 	rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# 	sell copies of the Software, and to permit persons to whom the Software is
+# 	furnished to do so, subject to the following conditions:
+#
+# 	The above copyright notice and this permission notice shall be included in
+# 	all copies or substantial portions of the Software.
+#
+# 	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# 	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# 	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# 	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# 	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# 	DEALINGS IN THE SOFTWARE.
+
+"""Converts a trace captured from the UART into a Chrome trace JSON file.
+
+The input is a serial console log which contains the output of trace_drain()
+(see firmware/include/trace.h), possibly mixed with other output:
+
+    trace: clock <system clock frequency, Hz>
+    trace: <id> <timestamp> <arg>       (hexadecimal)
+    trace: lost <number of overwritten events>
+
+Event ids hold the event phase above kTRACE_CONF_PHASE_SHIFT, and the offset
+of the event name in the .trace_events section of the firmware ELF below it.
+The output can be opened in chrome://tracing or https://ui.perfetto.dev.
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+PHASE_SHIFT = 24
+PHASES = {0: "i", 1: "B", 2: "E"}
+
+ELF_MAGIC = b"\x7fELF"
+ELF_CLASS_32 = 1
+ELF_DATA_LSB = 1
+
+TRACE_LINE = re.compile(r"trace: (\S+) (\S+)(?: (\S+))?\s*$")
+
+
+def read_section(path, name):
+    """Returns the contents of a section of a little-endian 32-bit ELF."""
+    with open(path, "rb") as elf:
+        data = elf.read()
+
+    if data[:4] != ELF_MAGIC or data[4] != ELF_CLASS_32 or data[5] != ELF_DATA_LSB:
+        raise ValueError(f"{path}: not a little-endian 32-bit ELF file")
+
+    shoff = struct.unpack_from("<I", data, 32)[0]
+    (shentsize, shnum, shstrndx) = struct.unpack_from("<HHH", data, 46)
+
+    def section_header(index):
+        (sh_name, _, _, _, sh_offset, sh_size) = struct.unpack_from(
+            "<IIIIII", data, shoff + index * shentsize
+        )
+        return sh_name, sh_offset, sh_size
+
+    (_, strtab_offset, _) = section_header(shstrndx)
+
+    for index in range(shnum):
+        (sh_name, sh_offset, sh_size) = section_header(index)
+        start = strtab_offset + sh_name
+        if data[start : data.index(b"\x00", start)].decode() == name:
+            return data[sh_offset : sh_offset + sh_size]
+
+    raise ValueError(f"{path}: no {name} section, was it built with TRACE=0?")
+
+
+def event_name(names, offset):
+    if offset >= len(names):
+        return f"unknown_0x{offset:x}"
+    return names[offset : names.index(b"\x00", offset)].decode()
+
+
+def decode(lines, names, default_clock):
+    events = []
+    clock = default_clock
+    timestamp = None
+    previous = 0
+    lost = 0
+
+    for line in lines:
+        match = TRACE_LINE.search(line)
+        if match is None:
+            continue
+
+        if match.group(1) == "clock":
+            clock = int(match.group(2))
+            continue
+
+        if match.group(1) == "lost":
+            lost += int(match.group(2))
+            events.append(
+                {
+                    "name": "trace lost",
+                    "ph": "i",
+                    "s": "g",
+                    "ts": (timestamp or 0) * 1e6 / clock,
+                    "pid": 0,
+                    "tid": 0,
+                    "args": {"events": int(match.group(2))},
+                }
+            )
+            continue
+
+        if match.group(3) is None:
+            continue
+
+        (event_id, cycles, arg) = (int(group, 16) for group in match.group(1, 2, 3))
+
+        # 	Timestamps are the low 32 bits of the uptime counter: extend them,
+        # 	assuming that consecutive events are less than 2^32 cycles apart.
+        if timestamp is None:
+            timestamp = 0
+        else:
+            timestamp += (cycles - previous) & 0xFFFFFFFF
+        previous = cycles
+
+        phase = event_id >> PHASE_SHIFT
+        event = {
+            "name": event_name(names, event_id & ((1 << PHASE_SHIFT) - 1)),
+            "ph": PHASES.get(phase, "i"),
+            "ts": timestamp * 1e6 / clock,
+            "pid": 0,
+            "tid": 0,
+            "args": {"arg": arg},
+        }
+        if event["ph"] == "i":
+            event["s"] = "t"
+        events.append(event)
+
+    return events, lost
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Converts a UART trace into a Chrome trace JSON file.",
+    )
+    parser.add_argument("--elf", required=True, help="Firmware ELF.")
+    parser.add_argument(
+        "--clock",
+        type=int,
+        default=12000000,
+        help="System clock frequency in Hz, if the log has no 'trace: clock' line.",
+    )
+    parser.add_argument(
+        "-o", "--output", default="trace.json", help="Chrome trace JSON file."
+    )
+    parser.add_argument(
+        "log", nargs="?", default="-", help="Serial console log (default: stdin)."
+    )
+    args = parser.parse_args()
+
+    names = read_section(args.elf, ".trace_events")
+
+    if args.log == "-":
+        (events, lost) = decode(sys.stdin, names, args.clock)
+    else:
+        with open(args.log, errors="replace") as log:
+            (events, lost) = decode(log, names, args.clock)
+
+    with open(args.output, "w") as output:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ns"}, output)
+
+    print(f"trace_decode: {len(events)} events, {lost} lost, written to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,347 @@
+#!/usr/bin/env python3
+
+# 	Copyright (c) 2024, Signaloid.
+#
+# 	Permission is hereby granted, free of charge, to any person obtaining a copy
+# 	of this software and associated documentation files (the "Software"), to
+# 	deal in the Software without restriction, including without limitation the
+# 	rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# 	sell copies of the Software, and to permit persons to whom the Software is
+# 	furnished to do so, subject to the following conditions:
+#
+# 	The above copyright notice and this permission notice shall be included in
+# 	all copies or substantial portions of the Software.
+#
+# 	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# 	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# 	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# 	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# 	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# 	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# 	DEALINGS IN THE SOFTWARE.
+
+"""Builds the SoC for each CPU variant, and compares the variants.
+
+For every variant, the script:
+
+1. Builds the Signaloid C0-microSD SoC, and reads the logic cell (LC) usage
+   and the maximum frequency of the system clock from the nextpnr log.
+2. Builds the LiteX simulator SoC (litex_sim) for the same variant, builds the
+   CPI benchmark firmware (firmware/bench/cpi_bench.c) against the simulator
+   headers, so that the firmware uses the CPUFLAGS of the variant, and runs it
+   in the simulator.
+
+and prints a table of LC usage, Fmax and cycles per instruction (CPI), e.g.:
+
+    make cpu-variants
+    make cpu-variants CPU_VARIANTS="lite standard"
+
+The simulator runs the benchmark loops from single cycle block RAM, so its CPI
+is the CPI of the core itself. Flashing build/cpu_variants/<variant>/soc
+gateware, and the cpi_bench firmware built for it, measures the CPI when
+executing in place from the SPI flash.
+
+The simulator needs Verilator. Each step logs to
+build/cpu_variants/<variant>/*.log.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import time
+
+ROOT_DIR = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+FIRMWARE_DIR = os.path.join(ROOT_DIR, "firmware")
+
+#   VexRiscv variants compared by `make cpu-variants` by default. Whether each
+#   one fits the iCE40 UP5K together with the rest of the SoC, and closes
+#   timing, is what the comparison reports: see the LCs and closes columns.
+#
+#   These are the variants pre-generated by pythondata-cpu-vexriscv. Other
+#   cache configurations (e.g. a minimal core with caches) need VexRiscv to be
+#   regenerated with SpinalHDL, which is not part of this build. Any other
+#   variant known to LiteX can still be passed with --variants.
+CPU_VARIANTS = {
+    "minimal": "RV32I, smallest core.",
+    "lite": "RV32IM.",
+    "standard": "RV32IM, instruction and data caches, branch prediction.",
+}
+
+#   Loops reported by the CPI benchmark firmware, in table order.
+CPI_LOOPS = ["alu", "branch", "load/store", "mul", "div"]
+
+#   Simulator memories, matching the linker regions used by the firmware.
+SIM_ROM_SIZE = "0x20000"
+SIM_SRAM_SIZE = "0x20000"
+
+UP5K_LCS = 5280
+
+NEXTPNR_LC_RE = re.compile(r"ICESTORM_LC:\s+(\d+)\s*/\s*(\d+)")
+NEXTPNR_FMAX_RE = re.compile(
+    r"Max frequency for clock\s+'([^']+)':\s+([\d.]+)\s+MHz"
+)
+CPI_BENCH_RE = re.compile(
+    r"cpi_bench:\s+(\S+)\s+instructions\s+(\d+)\s+cycles\s+(\d+)\s+CPI\s+([\d.]+)"
+)
+CPI_BENCH_DONE = "cpi_bench: done"
+
+
+def run_logged(cmd, log_path, cwd=ROOT_DIR):
+    """Runs cmd, writing its output to log_path, and returns (status, output)."""
+    with open(log_path, "w") as log:
+        log.write(" ".join(cmd) + "\n\n")
+        log.flush()
+        process = subprocess.run(
+            cmd,
+            cwd=cwd,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True,
+        )
+        log.write(process.stdout)
+
+    return process.returncode, process.stdout
+
+
+def build_gateware(args, variant, variant_dir):
+    """Builds the SoC, and returns its LC usage and Fmax from the nextpnr log."""
+    cmd = [
+        sys.executable,
+        "-m",
+        "gateware.signaloid_c0_microsd_target",
+        "--cpu-type=vexriscv",
+        f"--cpu-variant={variant}",
+        f"--sys-clk-freq={args.sys_clk_freq}",
+        f"--spi-flash-mode={args.spi_flash_mode}",
+        f"--output-dir={os.path.join(variant_dir, 'soc')}",
+        "--build",
+    ] + args.target_args
+    status, output = run_logged(
+        cmd, os.path.join(variant_dir, "gateware.log")
+    )
+
+    result = {"built": status == 0}
+
+    lcs = NEXTPNR_LC_RE.findall(output)
+    if lcs:
+        result["lcs"] = int(lcs[-1][0])
+        result["lcs_total"] = int(lcs[-1][1])
+
+    #   nextpnr reports Fmax after placement and after routing, so the last
+    #   report of each clock is the final one. The 10kHz LFOSC domain is not
+    #   interesting here.
+    fmax = {}
+    for clock, mhz in NEXTPNR_FMAX_RE.findall(output):
+        if "10khz" not in clock.lower():
+            fmax[clock] = float(mhz)
+    if fmax:
+        result["fmax"] = min(fmax.values())
+
+    return result
+
+
+def build_sim(args, variant, variant_dir):
+    """Runs the CPI benchmark firmware in the simulator, and returns the CPI per loop."""
+    sim_dir = os.path.join(variant_dir, "sim")
+    sim_cmd = [
+        sys.executable,
+        "-m",
+        "litex.tools.litex_sim",
+        "--cpu-type=vexriscv",
+        f"--cpu-variant={variant}",
+        f"--integrated-rom-size={SIM_ROM_SIZE}",
+        f"--integrated-sram-size={SIM_SRAM_SIZE}",
+        "--timer-uptime",
+        f"--output-dir={sim_dir}",
+        "--non-interactive",
+    ]
+
+    #   Generate the simulator SoC headers, which the firmware is built against.
+    status, _ = run_logged(
+        sim_cmd + ["--no-compile-gateware", "--no-compile-software"],
+        os.path.join(variant_dir, "sim-headers.log"),
+    )
+    if status != 0:
+        return {"error": "litex_sim failed"}
+
+    software_dir = os.path.join(sim_dir, "software")
+    status, _ = run_logged(
+        [
+            "make",
+            "--no-print-directory",
+            "BENCH=cpi_bench",
+            f"SOFTWARE_BUILD_PATH={software_dir}",
+        ],
+        os.path.join(variant_dir, "firmware.log"),
+        cwd=FIRMWARE_DIR,
+    )
+    if status != 0:
+        return {"error": "firmware build failed"}
+
+    #   The simulator runs until stopped, so stop it once the benchmark is done.
+    cpi = {}
+    cmd = sim_cmd + [f"--rom-init={os.path.join(software_dir, 'cpi_bench.bin')}"]
+    deadline = time.monotonic() + args.sim_timeout
+    with open(os.path.join(variant_dir, "sim.log"), "w") as log:
+        process = subprocess.Popen(
+            cmd,
+            cwd=ROOT_DIR,
+            stdin=subprocess.DEVNULL,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True,
+        )
+        for line in process.stdout:
+            log.write(line)
+            match = CPI_BENCH_RE.search(line)
+            if match:
+                cpi[match.group(1)] = float(match.group(4))
+            if CPI_BENCH_DONE in line or time.monotonic() > deadline:
+                break
+        process.terminate()
+        process.wait()
+
+    if not cpi:
+        return {"error": "no benchmark output"}
+
+    return {"cpi": cpi}
+
+
+def format_table(args, results):
+    header = ["variant", "LCs", "LC %", "Fmax MHz", "closes"] + [
+        f"CPI {loop}" for loop in CPI_LOOPS
+    ]
+    rows = [header]
+    sys_clk_mhz = args.sys_clk_freq / 1e6
+
+    for variant, result in results.items():
+        gateware = result.get("gateware", {})
+        sim = result.get("sim", {})
+
+        lcs = gateware.get("lcs")
+        lcs_total = gateware.get("lcs_total", UP5K_LCS)
+        fmax = gateware.get("fmax")
+
+        if not gateware:
+            closes = "-"
+        elif not gateware["built"] and lcs is None:
+            closes = "no fit"
+        elif fmax is None:
+            closes = "failed"
+        else:
+            closes = "yes" if fmax >= sys_clk_mhz else "no"
+
+        row = [
+            variant,
+            "-" if lcs is None else str(lcs),
+            "-" if lcs is None else f"{100 * lcs / lcs_total:.0f}",
+            "-" if fmax is None else f"{fmax:.2f}",
+            closes,
+        ]
+        for loop in CPI_LOOPS:
+            value = sim.get("cpi", {}).get(loop)
+            row.append("-" if value is None else f"{value:.2f}")
+        rows.append(row)
+
+    widths = [max(len(row[i]) for row in rows) for i in range(len(header))]
+    lines = [
+        "  ".join(cell.rjust(width) for cell, width in zip(row, widths))
+        for row in rows
+    ]
+    lines.insert(1, "  ".join("-" * width for width in widths))
+
+    notes = [
+        f"closes: Fmax of the system clock is at least {sys_clk_mhz:g} MHz.",
+        "CPI: in the simulator, from block RAM. '-' for loops the variant "
+        "does not implement (mul/div need RV32M).",
+    ]
+    for variant, result in results.items():
+        error = result.get("sim", {}).get("error")
+        if error:
+            notes.append(f"{variant}: {error}, see its sim logs.")
+
+    return "\n".join(lines + [""] + notes)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compares VexRiscv variants on the Signaloid C0-microSD.",
+    )
+    parser.add_argument(
+        "--variants",
+        nargs="+",
+        default=list(CPU_VARIANTS),
+        help=f"CPU variants to compare. Default: {list(CPU_VARIANTS)}",
+    )
+    parser.add_argument(
+        "--sys-clk-freq",
+        default=12e6,
+        type=float,
+        help="System clock frequency, which Fmax is compared against.",
+    )
+    parser.add_argument(
+        "--spi-flash-mode",
+        default="1x",
+        help="SPI Flash read mode, passed to the target script.",
+    )
+    parser.add_argument(
+        "--output-dir",
+        default=os.path.join(ROOT_DIR, "build", "cpu_variants"),
+        help="Build directory, with one subdirectory per variant.",
+    )
+    parser.add_argument(
+        "--no-gateware",
+        action="store_true",
+        help="Skips the SoC builds, i.e. reports the CPI only.",
+    )
+    parser.add_argument(
+        "--no-sim",
+        action="store_true",
+        help="Skips the simulations, i.e. reports LC usage and Fmax only.",
+    )
+    parser.add_argument(
+        "--sim-timeout",
+        default=600,
+        type=float,
+        help="Seconds to wait for the benchmark to finish in the simulator.",
+    )
+    parser.add_argument(
+        "target_args",
+        nargs="*",
+        help="Extra arguments for the target script, after --.",
+    )
+    args = parser.parse_args()
+
+    for variant in args.variants:
+        if variant not in CPU_VARIANTS:
+            print(
+                f"Warning: {variant} is not one of the default variants "
+                f"{list(CPU_VARIANTS)}, it might not be pre-generated."
+            )
+
+    results = {}
+    for variant in args.variants:
+        variant_dir = os.path.join(args.output_dir, variant)
+        os.makedirs(variant_dir, exist_ok=True)
+        results[variant] = {}
+
+        if not args.no_gateware:
+            print(f"  GATEWARE {variant}")
+            results[variant]["gateware"] = build_gateware(
+                args, variant, variant_dir
+            )
+        if not args.no_sim:
+            print(f"  SIM      {variant}")
+            results[variant]["sim"] = build_sim(args, variant, variant_dir)
+
+    table = format_table(args, results)
+    with open(os.path.join(args.output_dir, "summary.txt"), "w") as summary:
+        summary.write(table + "\n")
+    print()
+    print(table)
+
+
+if __name__ == "__main__":
+    main()
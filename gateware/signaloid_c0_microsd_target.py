@@ -20,6 +20,9 @@
 # 	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 # 	DEALINGS IN THE SOFTWARE.
 
+from functools import reduce
+from operator import add
+
 from litex.gen import KILOBYTE, MEGABYTE, LiteXModule
 from litex.soc import doc as docs_builder
 from litex.soc.cores.ram import Up5kSPRAM
@@ -33,9 +36,29 @@ from litex.soc.integration.soc import (
     SoCRegion,
 )
 from litex.soc.integration.soc_core import SoCCore
-from litex.soc.interconnect.csr import AutoCSR, CSRField, CSRStorage
+from litex.soc.interconnect import stream, wishbone
+from litex.soc.interconnect.csr import (
+    AutoCSR,
+    CSRField,
+    CSRStatus,
+    CSRStorage,
+)
+from litex.soc.interconnect.csr_eventmanager import (
+    EventManager,
+    EventSourcePulse,
+)
 from litex_boards.platforms import signaloid_c0_microsd
-from migen import If
+from migen import (
+    FSM,
+    Array,
+    Case,
+    ClockSignal,
+    If,
+    NextState,
+    NextValue,
+)
+from migen.fhdl.bitcontainer import log2_int
+from migen.genlib.cdc import MultiReg
 from migen.genlib.resetsync import AsyncResetSynchronizer
 
 
@@ -55,6 +78,56 @@ from migen.genlib.resetsync import AsyncResetSynchronizer
 USER_DATA_OFFSET = "0x200000"
 
 
+#   SPI Flash read modes, selected with --spi-flash-mode.
+#
+#   Each mode maps to the LiteSPI PHY pads it needs ("1x": clk/cs_n/mosi/miso,
+#   "4x": clk/cs_n/dq[0:4]), and to the read opcode used for memory mapped
+#   (XIP) accesses. Dummy cycles are inserted by LiteSPI, as defined by the
+#   opcode.
+#
+#   - 1x:      READ (0x03), one bit per clock, no dummy cycles.
+#   - 1x-fast: FAST_READ (0x0b), one bit per clock, 8 dummy cycles.
+#   - 2x:      DUAL OUTPUT READ (0x3b), two bits per clock, 8 dummy cycles.
+#   - 4x:      QUAD OUTPUT READ (0x6b), four bits per clock, 8 dummy cycles.
+#              Needs the flash Quad Enable (QE) status register bit set.
+SPI_FLASH_MODES = {
+    "1x": ("1x", "READ_1_1_1"),
+    "1x-fast": ("1x", "READ_1_1_1_FAST"),
+    "2x": ("4x", "READ_1_1_2"),
+    "4x": ("4x", "READ_1_1_4"),
+}
+
+
+#   UART configuration, set with --uart-baudrate and --uart-fifo-depth.
+#
+#   The LiteX UART PHY derives its bit timing from sys_clk with a 32-bit phase
+#   accumulator, so any baud rate up to sys_clk can be generated, but each bit
+#   edge may be off by up to one sys_clk cycle. UART_MIN_CLOCKS_PER_BIT keeps
+#   that jitter within 10% of a bit, which sets the maximum baud rate to
+#   1.2Mbaud at 12MHz, 2.4Mbaud at 24MHz, and 4.8Mbaud at 48MHz. The host's
+#   serial adapter must support the chosen rate.
+#
+#   The RX and TX FIFOs are in front of the UART's interrupt, so a deeper RX
+#   FIFO tolerates a longer interrupt latency at a given baud rate, and a
+#   deeper TX FIFO takes fewer interrupts per byte sent.
+UART_MIN_CLOCKS_PER_BIT = 10
+UART_FIFO_DEPTHS = [2**n for n in range(1, 10)]
+
+
+def check_uart_config(sys_clk_freq, baudrate, fifo_depth):
+    if baudrate <= 0 or sys_clk_freq / baudrate < UART_MIN_CLOCKS_PER_BIT:
+        raise ValueError(
+            f"Unsupported UART baud rate {baudrate:.0f} at a "
+            f"{sys_clk_freq / 1e6:.0f}MHz system clock, the maximum is "
+            f"{sys_clk_freq / UART_MIN_CLOCKS_PER_BIT:.0f}."
+        )
+    if fifo_depth not in UART_FIFO_DEPTHS:
+        raise ValueError(
+            f"Unsupported UART FIFO depth {fifo_depth}, "
+            f"possible values are: {UART_FIFO_DEPTHS}"
+        )
+
+
 class _CRG(LiteXModule):
     def __init__(self, platform, sys_clk_freq):
         self.rst = Signal()
@@ -95,6 +168,98 @@ class _CRG(LiteXModule):
         )
 
 
+LED_MODE_STATIC = 0
+LED_MODE_PATTERN = 1
+LED_MODE_ALTERNATE = 2
+
+
+class LedPattern(Module, AutoCSR):
+    """Pattern generator of one LED, see Leds."""
+
+    def __init__(self, tick, restart, pwm) -> None:
+        self._config = CSRStorage(
+            fields=[
+                CSRField(
+                    name="mode",
+                    size=2,
+                    values=[
+                        ("0", "static", "Follows its `out` bit."),
+                        ("1", "pattern", "Follows its pattern."),
+                        (
+                            "2",
+                            "alternate",
+                            "On when the other LED's pattern is off.",
+                        ),
+                    ],
+                ),
+            ],
+        )
+        self._period = CSRStorage(
+            16, reset=1, description="Pattern period, in 10kHz ticks."
+        )
+        self._duty = CSRStorage(
+            16, description="Ticks the LED is on, from the period start."
+        )
+        self._phase = CSRStorage(
+            16, description="Tick the period starts at after a restart."
+        )
+        self._burst = CSRStorage(
+            fields=[
+                CSRField(
+                    name="count",
+                    size=8,
+                    description="""Periods the pattern repeats before the
+                    gap. 0 repeats it continuously.""",
+                ),
+                CSRField(
+                    name="gap",
+                    size=8,
+                    description="Periods the LED stays off after a burst.",
+                ),
+            ],
+        )
+        self._brightness = CSRStorage(
+            8,
+            reset=255,
+            description="PWM duty cycle, in 1/255ths, in all modes.",
+        )
+
+        self.mode = self._config.fields.mode
+        self.pattern = Signal()
+        self.pwm = Signal()
+
+        tick_count = Signal(16)
+        period_count = Signal(9)
+        burst_count = self._burst.fields.count
+        burst_gap = self._burst.fields.gap
+        brightness = self._brightness.storage
+
+        #   Comparing count + 1 to the limit, rather than count to limit - 1,
+        #   keeps the counters in range when the limit is lowered below them.
+        self.sync += If(
+            restart,
+            tick_count.eq(self._phase.storage),
+            period_count.eq(0),
+        ).Elif(
+            tick,
+            If(
+                tick_count + 1 >= self._period.storage,
+                tick_count.eq(0),
+                If(
+                    period_count + 1 >= burst_count + burst_gap,
+                    period_count.eq(0),
+                ).Else(period_count.eq(period_count + 1)),
+            ).Else(tick_count.eq(tick_count + 1)),
+        )
+        self.comb += [
+            self.pattern.eq(
+                (tick_count < self._duty.storage)
+                & ((burst_count == 0) | (period_count < burst_count))
+            ),
+            self.pwm.eq((pwm < brightness) | (brightness == 255)),
+        ]
+
+
 class Leds(Module, AutoCSR, AutoDoc):
     """Signaloid C0-microSD LED control"""
 
@@ -102,6 +267,17 @@ class Leds(Module, AutoCSR, AutoDoc):
         self.intro = ModuleDoc(
             """Signaloid C0-microSD LED control.
             Set the LED bit to 1 to turn it on and 0 to turn it off.
+
+            Each LED also has a pattern generator, so that the LEDs blink with
+            no firmware involvement. Its timebase is the 10kHz low frequency
+            oscillator. In the `pattern` mode the LED is on for the first
+            `duty` ticks of every `period` ticks, repeated `burst.count`
+            times and followed by `burst.gap` periods off, e.g. to blink a
+            status code. In the `alternate` mode the LED is on whenever the
+            other LED's pattern is off. Writing 1 to `restart` restarts both
+            patterns at their `phase`. The `brightness` of each LED is a PWM
+            duty cycle at the system clock divided by 256, applied in all
+            modes.
             """
         )
 
@@ -120,28 +296,251 @@ class Leds(Module, AutoCSR, AutoDoc):
                 ),
             ],
         )
+        self._restart = CSRStorage(
+            fields=[
+                CSRField(
+                    name="restart",
+                    pulse=True,
+                    description="Write 1 to restart both patterns.",
+                ),
+            ],
+        )
 
-        #   Drive the LEDs directly.
-        #
-        #   Driving the LEDs directly from the FPGA is SAFE on
-        #   the Signaloid C0-microSD, since the LEDs are hard-wired to external
-        #   current limiting resistors.
-        #   Hence, for simplicity, the SB_RGBA_DRV hard IP can be omitted.
-        #
-        #   In general, direct drive can lead to overvoltage, and damage to the
-        #   LEDs and/or the board. Lattice iCE40 mitigates this issue by
-        #   incorporating the SB_RGBA_DRV hard IP on LEDs without external
-        #   current limiting resistors.
-        #
-        #   LED driver pins are in an open-drain configuration so they should
-        #   be inverted to be intuitively controlled through software.
-        #
-        self.comb += platform.request("user_led", number=0).eq(
-            ~self._out.storage[0]
+        #   Pattern timebase: the rising edges of the 10kHz clock, sampled in
+        #   the system clock domain, so that the pattern generators and their
+        #   CSRs share a single clock domain.
+        clk10khz = Signal()
+        clk10khz_last = Signal()
+        tick = Signal()
+        self.specials += MultiReg(ClockSignal("clk10khz"), clk10khz)
+        self.sync += clk10khz_last.eq(clk10khz)
+        self.comb += tick.eq(clk10khz & ~clk10khz_last)
+
+        pwm = Signal(8)
+        self.sync += pwm.eq(pwm + 1)
+
+        restart = self._restart.fields.restart
+        #   Leds is a plain Module, so the pattern generators must be added as
+        #   submodules, or their logic would not be part of the design.
+        self.submodules.red = LedPattern(tick, restart, pwm)
+        self.submodules.green = LedPattern(tick, restart, pwm)
+
+        leds = [
+            (self.red, self.green, self._out.fields.red),
+            (self.green, self.red, self._out.fields.green),
+        ]
+        for number, (led, other, out) in enumerate(leds):
+            on = Signal()
+            self.comb += Case(
+                led.mode,
+                {
+                    LED_MODE_STATIC: on.eq(out),
+                    LED_MODE_PATTERN: on.eq(led.pattern),
+                    LED_MODE_ALTERNATE: on.eq(~other.pattern),
+                    "default": on.eq(0),
+                },
+            )
+
+            #   Drive the LEDs directly.
+            #
+            #   Driving the LEDs directly from the FPGA is SAFE on
+            #   the Signaloid C0-microSD, since the LEDs are hard-wired to
+            #   external current limiting resistors.
+            #   Hence, for simplicity, the SB_RGBA_DRV hard IP can be omitted.
+            #
+            #   In general, direct drive can lead to overvoltage, and damage to
+            #   the LEDs and/or the board. Lattice iCE40 mitigates this issue
+            #   by incorporating the SB_RGBA_DRV hard IP on LEDs without
+            #   external current limiting resistors.
+            #
+            #   LED driver pins are in an open-drain configuration so they
+            #   should be inverted to be intuitively controlled through
+            #   software.
+            #
+            self.comb += platform.request("user_led", number=number).eq(
+                ~(on & led.pwm)
+            )
+
+
+class UARTTxDMA(Module, AutoCSR, AutoDoc):
+    """UART TX DMA reader"""
+
+    def __init__(self, length_bits=16) -> None:
+        self.intro = ModuleDoc(
+            """UART TX DMA reader.
+            Reads a buffer of any byte alignment and length from the system
+            bus, one 32-bit word at a time, and streams its bytes to the UART
+            PHY. Write the buffer address to `base`, its length in bytes to
+            `length`, and 1 to `start`. The `done` event fires once the last
+            byte has been handed to the UART PHY.
+            """
+        )
+
+        #   Word addressed, with the default 30-bit address, like the CPU
+        #   buses. The address width is left to its default because its
+        #   keyword was renamed from adr_width to address_width in LiteX, and
+        #   requirements.txt does not pin a LiteX version.
+        self.bus = wishbone.Interface(data_width=32)
+        self.source = stream.Endpoint([("data", 8)])
+
+        self._base = CSRStorage(32, description="Buffer address.")
+        self._length = CSRStorage(
+            length_bits, description="Buffer length, in bytes."
+        )
+        self._start = CSRStorage(
+            fields=[
+                CSRField(
+                    name="start",
+                    pulse=True,
+                    description="Write 1 to start the transfer.",
+                ),
+            ],
         )
-        self.comb += platform.request("user_led", number=1).eq(
-            ~self._out.storage[1]
+        self._busy = CSRStatus(description="1 while a transfer is running.")
+
+        self.submodules.ev = EventManager()
+        self.ev.done = EventSourcePulse(description="Transfer done.")
+        self.ev.finalize()
+
+        #   Byte address of the next byte, number of bytes left, and the last
+        #   word read, which holds the next byte.
+        address = Signal(32)
+        remaining = Signal(length_bits)
+        word = Signal(32)
+        word_bytes = Array(word[8 * i : 8 * (i + 1)] for i in range(4))
+
+        self.submodules.fsm = fsm = FSM(reset_state="IDLE")
+        fsm.act(
+            "IDLE",
+            If(
+                self._start.fields.start & (self._length.storage != 0),
+                NextValue(address, self._base.storage),
+                NextValue(remaining, self._length.storage),
+                NextState("READ"),
+            ),
+        )
+        fsm.act(
+            "READ",
+            self.bus.stb.eq(1),
+            self.bus.cyc.eq(1),
+            self.bus.we.eq(0),
+            self.bus.sel.eq(0b1111),
+            self.bus.adr.eq(address[2:]),
+            If(
+                self.bus.ack,
+                NextValue(word, self.bus.dat_r),
+                NextState("SEND"),
+            ),
+        )
+        fsm.act(
+            "SEND",
+            self.source.valid.eq(1),
+            self.source.data.eq(word_bytes[address[:2]]),
+            If(
+                self.source.ready,
+                NextValue(address, address + 1),
+                NextValue(remaining, remaining - 1),
+                If(
+                    remaining == 1,
+                    self.ev.done.trigger.eq(1),
+                    NextState("IDLE"),
+                ).Elif(
+                    address[:2] == 0b11,
+                    NextState("READ"),
+                ),
+            ),
         )
+        self.comb += self._busy.status.eq(~fsm.ongoing("IDLE"))
+
+
+PERF_COUNTERS_REGIONS = ["flash", "sram", "csr"]
+
+
+class PerfCounters(Module, AutoCSR, AutoDoc):
+    """Performance counters"""
+
+    def __init__(self, buses, regions) -> None:
+        self.intro = ModuleDoc(
+            """Performance counters.
+            Counts the system clock cycles, and, for each region of the CPU's
+            Wishbone buses (`flash`, `sram` and `csr`), the transactions
+            and the wait states: the cycles a bus spends waiting for its
+            transaction to be acknowledged, including bus arbitration. Writing
+            1 to `control.latch` copies all the counters to their status
+            registers at once, so that they can be read consistently. The
+            counters are 32-bit and wrap around.
+            """
+        )
+
+        self._control = CSRStorage(
+            fields=[
+                CSRField(
+                    name="enable",
+                    reset=1,
+                    description="Counts when 1, holds the counters when 0.",
+                ),
+                CSRField(
+                    name="reset",
+                    pulse=True,
+                    description="Write 1 to clear the counters.",
+                ),
+                CSRField(
+                    name="latch",
+                    pulse=True,
+                    description="""Write 1 to copy the counters to their
+                    status registers.""",
+                ),
+            ],
+        )
+        self._cycles = CSRStatus(32, description="Latched cycles.")
+
+        enable = self._control.fields.enable
+        reset = self._control.fields.reset
+        latch = self._control.fields.latch
+
+        counters = [(self._cycles, 1)]
+        for name in PERF_COUNTERS_REGIONS:
+            origin, size = regions[name]
+            accesses = []
+            waits = []
+            for bus in buses:
+                #   Wishbone addresses are in words.
+                shift = log2_int(bus.data_width // 8)
+                hit = Signal()
+                self.comb += hit.eq(
+                    bus.cyc
+                    & bus.stb
+                    & (bus.adr >= (origin >> shift))
+                    & (bus.adr < ((origin + size) >> shift))
+                )
+                accesses.append(hit & bus.ack)
+                waits.append(hit & ~bus.ack)
+
+            accesses_csr = CSRStatus(
+                32,
+                name=f"{name}_accesses",
+                description="Latched transactions.",
+            )
+            waits_csr = CSRStatus(
+                32, name=f"{name}_waits", description="Latched wait states."
+            )
+            setattr(self, f"_{name}_accesses", accesses_csr)
+            setattr(self, f"_{name}_waits", waits_csr)
+            counters.append((accesses_csr, reduce(add, accesses)))
+            counters.append((waits_csr, reduce(add, waits)))
+
+        for status, increment in counters:
+            count = Signal(32)
+            self.sync += [
+                If(
+                    reset,
+                    count.eq(0),
+                ).Elif(
+                    enable,
+                    count.eq(count + increment),
+                ),
+                If(latch, status.status.eq(count)),
+            ]
 
 
 class BaseSoC(SoCCore):
@@ -149,6 +548,9 @@ class BaseSoC(SoCCore):
         self,
         flash_offset,
         sys_clk_freq=24e6,
+        spi_flash_mode="1x",
+        with_uart_tx_dma=False,
+        with_perf_counters=False,
         **kwargs,
     ):
         platform = signaloid_c0_microsd.Platform()
@@ -161,6 +563,19 @@ class BaseSoC(SoCCore):
         #   dedicated SPRAM.
         kwargs["integrated_sram_size"] = 0
         kwargs["integrated_rom_size"] = 0
+
+        #   Enable timer0's free-running 64-bit uptime counter. The VexRiscv
+        #   lite core does not implement the cycle CSRs, so this is the cycle
+        #   counter used by the firmware for measurements.
+        kwargs["timer_uptime"] = True
+
+        #   The UART with TX DMA is added below, instead of by SoCCore.
+        with_uart = kwargs.get("with_uart", True)
+        uart_baudrate = int(kwargs.get("uart_baudrate", 115200))
+        uart_fifo_depth = int(kwargs.get("uart_fifo_depth", 16))
+        if with_uart_tx_dma:
+            kwargs["with_uart"] = False
+
         SoCCore.__init__(
             self,
             platform,
@@ -168,6 +583,17 @@ class BaseSoC(SoCCore):
             **kwargs,
         )
 
+        if with_uart and with_uart_tx_dma:
+            self.add_uart_with_tx_dma(uart_baudrate, uart_fifo_depth)
+
+        #   UART
+        #   Check the UART configuration, and make it available to the firmware
+        #   as CONFIG_UART_BAUDRATE and CONFIG_UART_FIFO_DEPTH.
+        if hasattr(self, "uart"):
+            check_uart_config(sys_clk_freq, uart_baudrate, uart_fifo_depth)
+            self.add_config("UART_BAUDRATE", uart_baudrate)
+            self.add_config("UART_FIFO_DEPTH", uart_fifo_depth)
+
         #   128KB SPRAM
         spram_size = 128 * KILOBYTE
         self.spram = Up5kSPRAM(size=spram_size)
@@ -185,12 +611,35 @@ class BaseSoC(SoCCore):
         #   disabled. Hence, the AT25SL128A module is used instead, which is
         #   compatible with Signaloid C0-microSD's AT25QL128A with the QPI mode
         #   disabled.
+        #
+        #   The multi-bit read modes use the flash WP/HOLD pins as IO2/IO3, so
+        #   they need the platform's "spiflash4x" pads. They also enable the
+        #   LiteSPI master interface, which the firmware uses to configure the
+        #   flash status register at boot (see firmware/src/spiflash.c).
         from litespi.modules import AT25SL128A
         from litespi.opcodes import SpiNorFlashOpCodes as Codes
 
+        if spi_flash_mode not in SPI_FLASH_MODES:
+            raise ValueError(
+                f"Unsupported SPI Flash mode {spi_flash_mode}, "
+                f"possible values are: {list(SPI_FLASH_MODES)}"
+            )
+        phy_mode, read_opcode = SPI_FLASH_MODES[spi_flash_mode]
+        if (
+            phy_mode == "4x"
+            and platform.lookup_request("spiflash4x", loose=True) is None
+        ):
+            raise ValueError(
+                f"SPI Flash mode {spi_flash_mode} needs the spiflash4x pads, "
+                "which the platform does not define."
+            )
+
         self.add_spi_flash(
-            mode="1x", module=AT25SL128A(Codes.READ_1_1_1), with_master=False
+            mode=phy_mode,
+            module=AT25SL128A(getattr(Codes, read_opcode)),
+            with_master=(spi_flash_mode != "1x"),
         )
+        self.add_config("SPIFLASH_READ_MODE", spi_flash_mode)
 
         #   Add ROM linker region
         self.bus.add_region(
@@ -206,6 +655,50 @@ class BaseSoC(SoCCore):
         #   Leds
         self.leds = Leds(self.platform)
 
+        #   Performance counters, on the CPU's buses. The rom region is part of
+        #   the spiflash region, so the flash counters cover both.
+        if with_perf_counters:
+            regions = {
+                "flash": self.bus.regions["spiflash"],
+                "sram": self.bus.regions["sram"],
+                "csr": self.bus.regions["csr"],
+            }
+            self.perf = PerfCounters(
+                self.cpu.periph_buses,
+                {
+                    name: (region.origin, region.size)
+                    for name, region in regions.items()
+                },
+            )
+
+    def add_uart_with_tx_dma(self, baudrate, fifo_depth):
+        """Adds the UART, as SoC.add_uart() does, with UARTTxDMA in front of
+        its PHY.
+
+        The UART core's TX FIFO has priority over the DMA at the PHY, so that
+        the bytes written to the FIFO before a transfer starts are sent first.
+        The firmware must not write to the FIFO while a transfer is running.
+        """
+        from litex.soc.cores.uart import UART, RS232PHY
+
+        self.uart_phy = RS232PHY(
+            self.platform.request("serial"), self.sys_clk_freq, baudrate
+        )
+        self.uart = UART(tx_fifo_depth=fifo_depth, rx_fifo_depth=fifo_depth)
+        self.uart_tx_dma = UARTTxDMA()
+        self.bus.add_master(name="uart_tx_dma", master=self.uart_tx_dma.bus)
+
+        self.comb += self.uart_phy.source.connect(self.uart.sink)
+        self.comb += If(
+            self.uart.source.valid,
+            self.uart.source.connect(self.uart_phy.sink),
+        ).Else(
+            self.uart_tx_dma.source.connect(self.uart_phy.sink),
+        )
+
+        self.irq.add("uart", use_loc_if_exists=True)
+        self.irq.add("uart_tx_dma", use_loc_if_exists=True)
+
 
 def main():
     from litex.build.parser import LiteXArgumentParser
@@ -226,6 +719,13 @@ def main():
         default=USER_DATA_OFFSET,
         help="Boot offset in SPI Flash.",
     )
+    parser.add_target_argument(
+        "--spi-flash-mode",
+        default="1x",
+        choices=list(SPI_FLASH_MODES),
+        help="""SPI Flash read mode, used for executing in place. Possible
+            values are: [1x, 1x-fast, 2x, 4x]""",
+    )
     parser.add_target_argument(
         "--build_docs",
         action="store_true",
@@ -236,6 +736,16 @@ def main():
         action="store_true",
         help="Enable UART interface.",
     )
+    parser.add_target_argument(
+        "--uart-tx-dma",
+        action="store_true",
+        help="Enable the UART TX DMA reader (needs --add_uart).",
+    )
+    parser.add_target_argument(
+        "--with-perf-counters",
+        action="store_true",
+        help="Enable the CPU bus performance counters.",
+    )
     args = parser.parse_args()
 
     if not args.add_uart:
@@ -244,6 +754,9 @@ def main():
     soc = BaseSoC(
         flash_offset=int(args.flash_offset, 0),
         sys_clk_freq=args.sys_clk_freq,
+        spi_flash_mode=args.spi_flash_mode,
+        with_uart_tx_dma=args.uart_tx_dma,
+        with_perf_counters=args.with_perf_counters,
         **parser.soc_argdict,
     )
     builder = Builder(soc, **parser.builder_argdict)